@@ -0,0 +1,89 @@
+/* Start Header -------------------------------------------------------
+Copyright AssetPack.h
+Purpose:  Binary shape/wave pack, memory mapped at load
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_AssetPack.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include "AEEngine.h"
+#include "MeshBuilder.h"
+
+#define ASSET_PACK_MAGIC			0x50545341			// "ASTP"
+#define ASSET_PACK_VERSION			2
+#define ASSET_PACK_ALIGN			16					// Every section starts on this boundary
+#define ASSET_PACK_FILE				"Data\\Asteroids.pak"
+
+/*
+File layout: the header, then one section per array below, each at its aligned offset.
+Everything is stored exactly as it is used at run time, so nothing is parsed or copied.
+*/
+typedef struct AssetPackHeader
+{
+	u32					mMagic;
+	u32					mVersion;
+	u32					mSize;						// Total file size, checked against the mapped size
+
+	u32					mShapeNum,		mShapeOffset;		// AssetPackShape
+	u32					mVertexNum,		mVertexOffset;		// MeshVertex
+	u32					mIndexNum,		mIndexOffset;		// unsigned short
+	u32					mWaveNum,		mWaveOffset;		// AssetPackWave
+	u32					mSpawnNum,		mSpawnOffset;		// AssetPackSpawn
+}AssetPackHeader;
+
+typedef struct AssetPackShape
+{
+	u32					mType;						// OBJECT_TYPE
+	u32					mVertexFirst,	mVertexNum;
+	u32					mIndexFirst,	mIndexNum;	// Indices are relative to mVertexFirst. No indices: plain triangle list
+	f32					mLocalMinX, mLocalMinY, mLocalMaxX, mLocalMaxY;
+	f32					mLocalRadius;
+}AssetPackShape;
+
+typedef struct AssetPackSpawn
+{
+	u32					mObjectType;
+	f32					mPosX, mPosY;
+	f32					mVelX, mVelY;
+	f32					mScale;						// Multiplier of the object type's default scale
+}AssetPackSpawn;
+
+typedef struct AssetPackWave
+{
+	u32					mSpawnFirst, mSpawnNum;
+}AssetPackWave;
+
+typedef struct AssetPack
+{
+	const AssetPackHeader	*mpHeader;				// Start of the mapped file, 0 when closed
+
+	const AssetPackShape	*mpShapes;
+	const MeshVertex		*mpVertices;
+	const unsigned short	*mpIndices;
+	const AssetPackWave		*mpWaves;
+	const AssetPackSpawn	*mpSpawns;
+
+	HANDLE					mFile;
+	HANDLE					mMapping;
+}AssetPack;
+
+
+/*
+This function maps the pack in memory and points the section pointers into it.
+Every shape, index, wave and spawn is checked once here: ranges inside their section, indices
+inside their shape, object types below ObjectTypeNum and a shape for each of them.
+Returns 0 (and leaves the pack closed) if the file is missing or invalid
+*/
+int AssetPackOpen(AssetPack *pPack, const char *pFileName, u32 ObjectTypeNum);
+
+/*
+This function unmaps the pack. Every pointer obtained from it becomes invalid
+*/
+void AssetPackClose(AssetPack *pPack);
+
+#endif
@@ -0,0 +1,29 @@
+/* Start Header -------------------------------------------------------
+Copyright AsteroidOutline.h
+Purpose:  Seeded generation of irregular asteroid outlines
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_AsteroidOutline.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef ASTEROID_OUTLINE_H
+#define ASTEROID_OUTLINE_H
+
+#include "MeshBuilder.h"
+
+#define ASTEROID_OUTLINE_POINT_MIN		5
+#define ASTEROID_OUTLINE_POINT_MAX		32
+
+
+/*
+This function generates a star shaped outline of PointNum points, jittered in angle and radius.
+The same seed always gives the same outline. Roughness is in [0;1], 0 gives a regular polygon.
+pVertices receives PointNum + 1 vertices (the center first), normalized so the farthest one is at 0.5.
+pIndices receives the 3 * PointNum indices of the triangle fan around the center, counter clockwise.
+Returns the number of indices
+*/
+unsigned long AsteroidOutlineGenerate(unsigned long Seed, unsigned long PointNum, float Roughness, unsigned int Color, MeshVertex *pVertices, unsigned short *pIndices);
+
+#endif
@@ -0,0 +1,86 @@
+/* Start Header -------------------------------------------------------
+Copyright AsteroidsData.h
+Purpose:  Built in shapes and waves, shared by the game and the asset packer
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_AsteroidsData.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef ASTEROIDS_DATA_H
+#define ASTEROIDS_DATA_H
+
+#include "AssetPack.h"
+
+enum OBJECT_TYPE
+{
+	// list of game object types
+	OBJECT_TYPE_SHIP = 0,
+	OBJECT_TYPE_BULLET,
+	OBJECT_TYPE_ASTEROID,
+	OBJECT_TYPE_HOMING_MISSILE,
+
+	OBJECT_TYPE_NUM
+};
+
+// ---------------------------------------------------------------------------
+// Shape geometry, normalized in the [-0.5;0.5] range.
+// The game falls back to this data when Data\Asteroids.pak is missing,
+// the packer bakes it into that file.
+
+static const MeshVertex sgBuiltinVertices[] =
+{
+	// ship, first 3
+	{ -0.5f,  0.5f, 0xFFFF0000, 0.0f, 0.0f },
+	{ -0.5f, -0.5f, 0xFFFF0000, 0.0f, 0.0f },
+	{  0.5f,  0.0f, 0xFFFFFFFF, 0.0f, 0.0f },
+
+	// bullet, from 3
+	{ -0.5f,  0.5f, 0xFFFF0000, 0.0f, 0.0f },
+	{ -0.5f, -0.5f, 0xFFFF0000, 0.0f, 0.0f },
+	{  0.5f, -0.5f, 0xFFFF0000, 0.0f, 0.0f },
+	{  0.5f,  0.5f, 0xFFFF0000, 0.0f, 0.0f },
+
+	// asteroid, from 7
+	{ -0.5f,  0.5f, 0xFFFFFF00, 0.0f, 0.0f },
+	{ -0.5f, -0.5f, 0xFFFFFF00, 0.0f, 0.0f },
+	{  0.5f, -0.5f, 0xFFFFFF00, 0.0f, 0.0f },
+	{  0.5f,  0.5f, 0xFFFFFF00, 0.0f, 0.0f },
+
+	// homing missile, from 11
+	{ -0.5f,  0.5f, 0xFFFFFFFF, 0.0f, 0.0f },
+	{ -0.5f, -0.5f, 0xFFFFFFFF, 0.0f, 0.0f },
+	{  0.5f, -0.5f, 0xFFFFFFFF, 0.0f, 0.0f },
+	{  0.5f,  0.5f, 0xFFFFFFFF, 0.0f, 0.0f },
+};
+
+// two triangles covering the 4 vertices of a quad, shared by every quad shape
+static const unsigned short sgBuiltinIndices[] = { 0, 1, 2, 0, 3, 2 };
+
+// Only the ranges are filled in, bounds are computed from the vertices
+static const AssetPackShape sgBuiltinShapes[] =
+{
+	{ OBJECT_TYPE_SHIP,				0,  3, 0, 0 },
+	{ OBJECT_TYPE_BULLET,			3,  4, 0, 6 },
+	{ OBJECT_TYPE_ASTEROID,			7,  4, 0, 6 },
+	{ OBJECT_TYPE_HOMING_MISSILE,	11, 4, 0, 6 },
+};
+
+// Positions and velocities in world units, scale relative to the object type's size
+static const AssetPackSpawn sgBuiltinSpawns[] =
+{
+	{ OBJECT_TYPE_ASTEROID,  75.0f, 321.0f,  60.0f, -45.0f, 3.0f },
+	{ OBJECT_TYPE_ASTEROID, -75.0f,  75.0f, -30.0f,  20.0f, 2.0f },
+	{ OBJECT_TYPE_ASTEROID, 200.0f,  10.0f, -10.0f,  22.0f, 1.0f },
+};
+
+static const AssetPackWave sgBuiltinWaves[] =
+{
+	{ 0, 3 },
+};
+
+#define BUILTIN_SHAPE_NUM			(sizeof(sgBuiltinShapes) / sizeof(AssetPackShape))
+#define BUILTIN_WAVE_NUM			(sizeof(sgBuiltinWaves) / sizeof(AssetPackWave))
+
+#endif
@@ -0,0 +1,73 @@
+/* Start Header -------------------------------------------------------
+Copyright AsyncLog.h
+Purpose:  Binary logger: call sites copy the raw arguments, a background thread formats them
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_AsyncLog.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include "AEEngine.h"
+
+#define ASYNC_LOG_FILE				"Log.txt"
+#define ASYNC_LOG_RING_MAX			8					// Logging threads
+#define ASYNC_LOG_RING_CAPACITY		4096				// Power of 2, records per thread between two drains
+#define ASYNC_LOG_ARG_SIZE			48					// Bytes of arguments copied per record
+#define ASYNC_LOG_RATE_WINDOW		0.1					// Seconds
+#define ASYNC_LOG_RATE_MAX			256					// Records per thread and per window, the rest are dropped
+#define ASYNC_LOG_DRAIN_PERIOD		10					// Milliseconds between two drains of the log thread
+
+typedef struct AsyncLogRecord
+{
+	LONGLONG			mTime;					// QueryPerformanceCounter at the call
+	const char			*mpFormat;				// The format string is the record's id, 0 when mArgs holds text
+	char				mArgs[ASYNC_LOG_ARG_SIZE];	// Argument memory, exactly as it was passed
+}AsyncLogRecord;
+
+typedef struct AsyncLogRing
+{
+	AsyncLogRecord		*mpRecords;
+
+	// producer side
+	volatile unsigned long	mHead;
+	LONGLONG			mWindowStart;			// Rate limiting window
+	unsigned long		mWindowNum;				// Records accepted in the window
+	volatile unsigned long	mDroppedFull;
+	volatile unsigned long	mDroppedRate;
+	char				mPad[64];
+
+	// consumer side
+	volatile unsigned long	mTail;
+	unsigned long		mReportedFull;			// Drop counts already written to the log
+	unsigned long		mReportedRate;
+}AsyncLogRing;
+
+
+/*
+This function allocates the rings, opens ASYNC_LOG_FILE and starts the log thread
+*/
+void AsyncLogInit(void);
+
+/*
+This function writes what is left, stops the log thread and releases the rings
+*/
+void AsyncLogFree(void);
+
+/*
+This function queues a log line and returns without formatting it.
+pFormat must be a string literal and every %s argument must point to a string that is never freed,
+both are only read later by the log thread. The arguments may use ASYNC_LOG_ARG_SIZE bytes at most.
+Does nothing before AsyncLogInit
+*/
+void AsyncLogWrite(const char *pFormat, ...);
+
+/*
+This function times AsyncLogWrite and prints the cost of a call
+*/
+void AsyncLogBenchmark(void);
+
+#endif
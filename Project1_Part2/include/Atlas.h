@@ -0,0 +1,82 @@
+/* Start Header -------------------------------------------------------
+Copyright Atlas.h
+Purpose:  Sprite images packed into one texture, with the texture coordinates of each
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Atlas.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include "AEEngine.h"
+#include "MeshBuilder.h"
+
+#define ATLAS_REGION_MAX			32
+#define ATLAS_PADDING				1					// Border pixels copied from each image's edge, so bilinear filtering does not bleed
+
+typedef enum
+{
+	ATLAS_PAINT_ROCK = 0,							// Tiling grey noise
+	ATLAS_PAINT_HULL,								// Plates with panel lines
+	ATLAS_PAINT_GLOW,								// White disc fading out, in the alpha
+
+	ATLAS_PAINT_NUM
+}ATLAS_PAINT;
+
+typedef struct AtlasImage
+{
+	long				mWidth, mHeight;
+	unsigned int		*mpPixels;					// 0xAARRGGBB, top row first
+}AtlasImage;
+
+typedef struct AtlasRegion
+{
+	long				mX, mY, mWidth, mHeight;	// Pixels of the image in the atlas, padding excluded
+	float				mU0, mV0, mU1, mV1;			// Same rectangle in texture coordinates, v goes down
+}AtlasRegion;
+
+/*
+Images are packed on shelves, tallest first, into the smallest power of two texture they fit in.
+Region i holds image i
+*/
+typedef struct Atlas
+{
+	long				mWidth, mHeight;
+	unsigned int		*mpPixels;					// 0xAARRGGBB, top row first
+	AtlasRegion			mRegions[ATLAS_REGION_MAX];
+	long				mRegionNum;
+}Atlas;
+
+
+/*
+This function packs ImageNum images into one atlas no larger than MaxSize on a side.
+The images are copied, they can be freed afterwards. Returns 0 if they do not fit
+*/
+int AtlasBuild(Atlas *pAtlas, const AtlasImage *pImages, long ImageNum, long MaxSize);
+
+/*
+This function releases the atlas pixels
+*/
+void AtlasFree(Atlas *pAtlas);
+
+/*
+This function sets the texture coordinates of Num vertices from their position:
+the normalized shape square [-0.5;0.5] maps onto the region, y up to v down
+*/
+void AtlasRegionMap(const AtlasRegion *pRegion, MeshVertex *pVertices, unsigned long Num);
+
+/*
+This function allocates a Width x Height image and paints it in the given style.
+Seed picks the noise
+*/
+void AtlasImagePaint(AtlasImage *pImage, long Width, long Height, ATLAS_PAINT Paint, unsigned long Seed);
+
+/*
+This function releases an image painted by AtlasImagePaint
+*/
+void AtlasImageFree(AtlasImage *pImage);
+
+#endif
@@ -0,0 +1,75 @@
+/* Start Header -------------------------------------------------------
+Copyright BarnesHut.h
+Purpose:  Barnes-Hut quadtree gravity solver
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_BarnesHut.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef BARNES_HUT_H
+#define BARNES_HUT_H
+
+#include "AEEngine.h"
+#include "Vector2D.h"
+
+#define BARNES_HUT_THREAD_NUM		4					// One worker per root quadrant
+#define BARNES_HUT_PARALLEL_MIN		1024				// Below this many queries, everything runs on the calling thread
+
+typedef struct BarnesHutNode
+{
+	float				mCenterX, mCenterY;			// Center of the cell
+	float				mHalfSize;					// Half the width of the (square) cell
+
+	float				mMass;						// Total mass in the cell
+	float				mMassX, mMassY;				// Center of mass of the cell
+
+	long				mChild[4];					// Child cells, -1 when the quadrant is empty
+	long				mBody;						// Body stored in a leaf, -1 for an empty cell or an internal node
+}BarnesHutNode;
+
+typedef struct BarnesHut
+{
+	BarnesHutNode		*mpNodes;
+	long				mNodeNum;
+	long				mNodeCapacity;
+
+	float				mTheta;						// Opening angle: a cell is approximated when size / distance < theta
+	float				mGravity;					// Gravitational constant
+	float				mSoftening;					// Added to distances to avoid infinite forces (and self interaction)
+	int					mThreaded;					// 0 forces single threaded evaluation
+
+	long				*mpQueryOrder;				// Scratch: queries sorted by root quadrant
+	long				mQueryCapacity;
+}BarnesHut;
+
+
+/*
+This function allocates the node arena for about BodyCapacity bodies (it grows if needed)
+*/
+void BarnesHutInit(BarnesHut *pTree, long BodyCapacity, float Theta, float Gravity, float Softening);
+
+/*
+This function releases the node arena
+*/
+void BarnesHutFree(BarnesHut *pTree);
+
+/*
+This function rebuilds the quadtree from the bodies' positions and masses
+*/
+void BarnesHutBuild(BarnesHut *pTree, Vector2D *pPositions, float *pMasses, long BodyNum);
+
+/*
+This function computes the gravitational acceleration at each query position.
+Queries do not need to be bodies of the tree (bullets are only attracted, they do not attract).
+Each query walks the tree in a fixed order, so the result is the same whatever the thread count
+*/
+void BarnesHutComputeAccelerations(BarnesHut *pTree, Vector2D *pQueries, long QueryNum, Vector2D *pAccelerations);
+
+/*
+This function times the build and the force pass for 10k, 50k and 100k random bodies and prints the results
+*/
+void BarnesHutBenchmark(void);
+
+#endif
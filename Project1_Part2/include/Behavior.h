@@ -0,0 +1,121 @@
+/* Start Header -------------------------------------------------------
+Copyright Behavior.h
+Purpose:  Resumable behavior scripts and their frame budgeted scheduler
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Behavior.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef BEHAVIOR_H
+#define BEHAVIOR_H
+
+#include "AEEngine.h"
+
+#define BEHAVIOR_RUNNING			0
+#define BEHAVIOR_DONE				1
+
+#define BEHAVIOR_BUDGET_CHECK		32					// Resumes between two reads of the clock
+
+typedef struct Behavior Behavior;
+
+/*
+A behavior function is resumed once per frame and returns BEHAVIOR_RUNNING or BEHAVIOR_DONE.
+Its body sits between BEHAVIOR_BEGIN and BEHAVIOR_END, and it suspends with the waits below.
+Locals do not survive a suspension: keep them in mState or in the owner's components
+*/
+typedef int (*BehaviorFunc)(Behavior *pBehavior);
+
+struct Behavior
+{
+	BehaviorFunc		mpFunc;					// 0 once stopped, the slot is released on the next visit
+	void				*mpOwner;
+
+	unsigned long		mLine;					// Resume point, 0 before the first resume
+	unsigned long		mFrame;					// Last frame it was resumed in
+	f64					mLastTime;				// Scheduler time of the last resume
+	float				mDt;					// Seconds since the last resume, spilled frames included
+	float				mWait;					// Seconds left in BEHAVIOR_WAIT_SECONDS
+
+	union
+	{
+		float			mFloat[4];
+		void			*mpPointer[2];
+	}mState;									// Locals kept across suspensions
+};
+
+typedef struct BehaviorScheduler
+{
+	Behavior			*mpBehaviors;			// Pool of frames
+	unsigned long		*mpFree;				// Released frames, used as a stack
+	unsigned long		mFreeNum;
+	unsigned long		mNextNew;				// Frames from here up were never used since the last clear
+	unsigned long		*mpActive;				// Running frames, in resume order
+	unsigned long		mActiveNum;
+	unsigned long		mCapacity;
+
+	unsigned long		mCursor;				// Next entry of mpActive to resume
+	unsigned long		mFrame;
+	f64					mTime;					// Sum of the frame times given to BehaviorSchedulerRun
+	unsigned long		mSpilled;				// Behaviors left for the next frame by the last run
+}BehaviorScheduler;
+
+// ---------------------------------------------------------------------------
+// Suspension points, only valid between BEHAVIOR_BEGIN and BEHAVIOR_END.
+// They resume through case __LINE__, which is not a constant under /ZI: build with /Zi, not Edit and Continue
+
+#define BEHAVIOR_BEGIN(pBehavior)					switch ((pBehavior)->mLine) { case 0:
+
+#define BEHAVIOR_END(pBehavior)						} (pBehavior)->mLine = 0; return BEHAVIOR_DONE
+
+// Resumes on the next frame
+#define BEHAVIOR_NEXT_FRAME(pBehavior)				do { (pBehavior)->mLine = __LINE__; return BEHAVIOR_RUNNING; case __LINE__:; } while (0)
+
+// Resumes once Seconds of scheduler time went by
+#define BEHAVIOR_WAIT_SECONDS(pBehavior, Seconds)	do { (pBehavior)->mWait = (Seconds); (pBehavior)->mLine = __LINE__; return BEHAVIOR_RUNNING;	\
+														case __LINE__: (pBehavior)->mWait -= (pBehavior)->mDt;									\
+														if ((pBehavior)->mWait > 0.0f) return BEHAVIOR_RUNNING; } while (0)
+
+// Resumes once Condition holds, without suspending if it already does
+#define BEHAVIOR_AWAIT(pBehavior, Condition)		do { (pBehavior)->mLine = __LINE__; case __LINE__: if (!(Condition)) return BEHAVIOR_RUNNING; } while (0)
+
+
+/*
+This function allocates a pool of Capacity behavior frames
+*/
+void BehaviorSchedulerInit(BehaviorScheduler *pScheduler, unsigned long Capacity);
+
+/*
+This function releases the pool
+*/
+void BehaviorSchedulerFree(BehaviorScheduler *pScheduler);
+
+/*
+This function drops every behavior at once, without resuming them
+*/
+void BehaviorSchedulerClear(BehaviorScheduler *pScheduler);
+
+/*
+This function takes a frame from the pool and schedules Func for pOwner, starting next frame.
+Returns 0 if the pool is empty
+*/
+Behavior* BehaviorStart(BehaviorScheduler *pScheduler, BehaviorFunc Func, void *pOwner);
+
+/*
+This function stops a behavior. It will not be resumed again, its frame returns to the pool on the next run
+*/
+void BehaviorStop(Behavior *pBehavior);
+
+/*
+This function advances the scheduler time by FrameTime and resumes the behaviors in turn
+until all of them ran or Budget seconds were spent. The rest resume first on the next run
+*/
+void BehaviorSchedulerRun(BehaviorScheduler *pScheduler, float FrameTime, f64 Budget);
+
+/*
+This function runs Num trivial behaviors for a few frames and prints the memory used and the time per frame
+*/
+void BehaviorBenchmark(unsigned long Num);
+
+#endif
@@ -0,0 +1,60 @@
+/* Start Header -------------------------------------------------------
+Copyright Bounds.h
+Purpose:  Per-frame cache of world bounds (AABB + radius), stored SoA
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Bounds.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+/*
+Every array holds one entry per object slot. The owner fills the inputs (position,
+rotation, scale and the local bounds of the shape), BoundsCacheCompute turns them into
+world bounds. Broadphase, culling and narrowphase all read the outputs.
+*/
+typedef struct BoundsCache
+{
+	long				mCapacity;					// Rounded up to a multiple of 4
+
+	// inputs
+	float				*mpPosX, *mpPosY;
+	float				*mpCos, *mpSin;				// Rotation
+	float				*mpScaleX, *mpScaleY;
+	float				*mpLocalCenterX, *mpLocalCenterY;	// Center of the shape's local AABB
+	float				*mpLocalHalfX, *mpLocalHalfY;		// Half extents of the shape's local AABB
+	float				*mpLocalRadius;				// Largest vertex distance from the shape's origin
+
+	// outputs
+	float				*mpMinX, *mpMinY;
+	float				*mpMaxX, *mpMaxY;
+	float				*mpRadius;					// Bounding radius around the position
+}BoundsCache;
+
+
+/*
+This function allocates all the arrays of the cache in one block
+*/
+void BoundsCacheInit(BoundsCache *pCache, long Capacity);
+
+/*
+This function releases the cache
+*/
+void BoundsCacheFree(BoundsCache *pCache);
+
+/*
+This function computes the world AABB and radius of entries [Start, Start + Count).
+The AABB is the one of the shape's local box, scaled then rotated, so rotation is accounted for.
+Four entries are processed at a time with SSE when available
+*/
+void BoundsCacheCompute(BoundsCache *pCache, long Start, long Count);
+
+/*
+This function returns 1 if the world AABBs of entries A and B overlap
+*/
+int BoundsCacheOverlap(BoundsCache *pCache, long A, long B);
+
+#endif
@@ -0,0 +1,97 @@
+/* Start Header -------------------------------------------------------
+Copyright CommandQueue.h
+Purpose:  Lock-free multi-producer spawn/despawn command queue
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_CommandQueue.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include "AEEngine.h"
+#include "Vector2D.h"
+
+#define COMMAND_HANDLE_INVALID		0xFFFFFFFF
+
+typedef enum
+{
+	COMMAND_SPAWN = 0,
+	COMMAND_DESPAWN,
+
+	COMMAND_NUM
+}COMMAND_TYPE;
+
+typedef struct Command
+{
+	unsigned long		mType;				// COMMAND_TYPE
+	unsigned long		mHandle;			// Entity handle (reserved for spawns, existing for despawns)
+	unsigned long		mObjectType;		// OBJECT_TYPE of the spawned instance
+	unsigned long		mGeneration;		// Generation of the despawned instance, a slot reused since is left alone
+
+	Vector2D			mPosition;			// Spawn position
+	Vector2D			mVelocity;			// Spawn velocity
+	float				mAngle;				// Spawn angle
+	float				mScale;				// Multiplier applied to the object type's default scale
+
+	volatile long		mReady;				// Set last by the producer, once the command is fully written
+}Command;
+
+typedef struct CommandQueue
+{
+	Command				*mpCommands;
+	long				mCapacity;
+	volatile long		mWriteIndex;		// Next free command, shared by all producers
+	volatile long		mDropped;			// Commands rejected because the queue was full
+
+	unsigned long		*mpFreeHandles;		// Free entity handles, published by the consumer at the sync point
+	long				mFreeHandleNum;
+	long				mFreeHandleCapacity;
+	volatile long		mReserveIndex;		// Next free handle to hand out, shared by all producers
+}CommandQueue;
+
+
+/*
+This function allocates the command buffer and the free handle list
+*/
+void CommandQueueInit(CommandQueue *pQueue, long Capacity, long HandleCapacity);
+
+/*
+This function releases the memory held by the queue
+*/
+void CommandQueueFree(CommandQueue *pQueue);
+
+/*
+This function reserves an entity handle that will become valid once the queue is drained.
+Safe to call from any thread. Returns COMMAND_HANDLE_INVALID if no free handle is left this frame
+*/
+unsigned long CommandQueueReserveHandle(CommandQueue *pQueue);
+
+/*
+This function pushes a spawn command for an already reserved handle. Safe to call from any thread.
+Returns 0 if the queue is full
+*/
+int CommandQueuePushSpawn(CommandQueue *pQueue, unsigned long Handle, unsigned long ObjectType, Vector2D *pPosition, Vector2D *pVelocity, float Angle, float Scale);
+
+/*
+This function pushes a despawn command for the instance of the given generation in the Handle slot.
+Safe to call from any thread. Returns 0 if the queue is full
+*/
+int CommandQueuePushDespawn(CommandQueue *pQueue, unsigned long Handle, unsigned long Generation);
+
+/*
+Main thread only, at the frame sync point (no producer may be running).
+Returns the number of pending commands; they are stored in order in pQueue->mpCommands
+*/
+long CommandQueuePendingNum(CommandQueue *pQueue);
+
+/*
+Main thread only, at the frame sync point.
+Clears the drained commands and publishes the free handles for the next frame, at most the
+HandleCapacity given to CommandQueueInit. Reserved handles that were not consumed by a spawn are simply handed out again
+*/
+void CommandQueueReset(CommandQueue *pQueue, unsigned long *pFreeHandles, long FreeHandleNum);
+
+#endif
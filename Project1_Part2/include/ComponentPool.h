@@ -0,0 +1,62 @@
+/* Start Header -------------------------------------------------------
+Copyright ComponentPool.h
+Purpose:  Free list of the slots of a typed component array
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_ComponentPool.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef COMPONENT_POOL_H
+#define COMPONENT_POOL_H
+
+#include "AEEngine.h"
+
+#define COMPONENT_POOL_NONE			0xFFFFFFFF
+
+/*
+The pool only hands out indices, the components live in an array owned by the caller.
+Released indices are reused first, then the never used ones from mNextNew up,
+so live components stay packed at the start of the array and clearing is O(1)
+*/
+typedef struct ComponentPool
+{
+	unsigned long		*mpFree;				// Released indices, used as a stack
+	unsigned long		mFreeNum;
+	unsigned long		mNextNew;				// Indices from here up were never handed out since the last clear
+	unsigned long		mCapacity;
+}ComponentPool;
+
+
+/*
+This function allocates the free list of a Capacity slot array, every slot free
+*/
+void ComponentPoolInit(ComponentPool *pPool, unsigned long Capacity);
+
+/*
+This function releases the free list
+*/
+void ComponentPoolFree(ComponentPool *pPool);
+
+/*
+This function marks every slot as free again, in constant time
+*/
+void ComponentPoolClear(ComponentPool *pPool);
+
+/*
+This function takes a free slot. Returns COMPONENT_POOL_NONE if there is none left
+*/
+unsigned long ComponentPoolAlloc(ComponentPool *pPool);
+
+/*
+This function gives a slot back
+*/
+void ComponentPoolRelease(ComponentPool *pPool, unsigned long Index);
+
+/*
+This function returns the number of slots in use
+*/
+unsigned long ComponentPoolUsedNum(const ComponentPool *pPool);
+
+#endif
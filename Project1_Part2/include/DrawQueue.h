@@ -0,0 +1,120 @@
+/* Start Header -------------------------------------------------------
+Copyright DrawQueue.h
+Purpose:  Draw calls ordered by 64 bit keys, radix sorted every frame
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_DrawQueue.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef DRAW_QUEUE_H
+#define DRAW_QUEUE_H
+
+#include "AEEngine.h"
+
+/*
+Key fields, most significant first. Items are drawn in increasing key order:
+layer, then depth within the layer (back to front), then blend mode and mesh, so items
+at the same depth are grouped by state
+*/
+#define DRAW_KEY_LAYER_SHIFT		56					// 8 bits
+#define DRAW_KEY_DEPTH_SHIFT		32					// 24 bits
+#define DRAW_KEY_BLEND_SHIFT		24					// 8 bits
+#define DRAW_KEY_MESH_SHIFT			0					// 24 bits
+
+#define DRAW_KEY_DEPTH_MAX			0xFFFFFF
+#define DRAW_KEY_MESH_MAX			0xFFFFFF
+
+#define DRAW_KEY(Layer, Depth, Blend, Mesh)												\
+	(((u64)((Layer) & 0xFF) << DRAW_KEY_LAYER_SHIFT) |									\
+	 ((u64)((Depth) & DRAW_KEY_DEPTH_MAX) << DRAW_KEY_DEPTH_SHIFT) |					\
+	 ((u64)((Blend) & 0xFF) << DRAW_KEY_BLEND_SHIFT) |									\
+	 ((u64)((Mesh) & DRAW_KEY_MESH_MAX) << DRAW_KEY_MESH_SHIFT))
+
+#define DRAW_KEY_BLEND(Key)			((unsigned int)((Key) >> DRAW_KEY_BLEND_SHIFT) & 0xFF)
+#define DRAW_KEY_MESH(Key)			((unsigned long)((Key) >> DRAW_KEY_MESH_SHIFT) & DRAW_KEY_MESH_MAX)
+
+// Changes passed to the draw function, from the previous item
+#define DRAW_CHANGE_BLEND			0x00000001
+#define DRAW_CHANGE_MESH			0x00000002
+
+typedef u64							DrawKey;
+
+/*
+Called once per item in key order. Changes has DRAW_CHANGE_BLEND set when the blend mode
+must be set before drawing, and DRAW_CHANGE_MESH when the mesh differs from the previous item's
+*/
+typedef void(*DrawQueueFunc)(DrawKey Key, unsigned long Item, unsigned long Changes, void *pContext);
+
+/*
+Called once per item in key order before the draw function, returns 0 to skip the item
+*/
+typedef int(*DrawQueueFilter)(unsigned long Item, void *pContext);
+
+typedef struct DrawQueueStats
+{
+	unsigned long		mItemNum;
+	unsigned long		mPassNum;					// Radix passes run by the last sort, bytes equal in every key are skipped
+	unsigned long		mBlendChangeNum;			// Blend mode sets, the first item's included
+	unsigned long		mMeshChangeNum;				// Mesh switches, the first item's included
+	f64					mSortTime;					// Seconds spent in the last sort
+}DrawQueueStats;
+
+/*
+Items are pushed with their key each frame, sorted, then submitted to a draw function.
+The sort is a least significant byte first radix sort, so it is stable and linear in the item count.
+*/
+typedef struct DrawQueue
+{
+	unsigned long		mCapacity;
+	unsigned long		mNum;
+	DrawKey				*mpKeys;
+	unsigned long		*mpItems;
+	DrawKey				*mpScratchKeys;				// Other half of each radix pass
+	unsigned long		*mpScratchItems;
+
+	DrawQueueStats		mStats;
+}DrawQueue;
+
+
+/*
+This function allocates a queue for Capacity items per frame
+*/
+void DrawQueueInit(DrawQueue *pQueue, unsigned long Capacity);
+
+/*
+This function releases the queue
+*/
+void DrawQueueFree(DrawQueue *pQueue);
+
+/*
+This function removes every item and resets the statistics, before the ones of a new frame are pushed
+*/
+void DrawQueueClear(DrawQueue *pQueue);
+
+/*
+This function pushes Item with its Key. Items past the capacity are dropped
+*/
+void DrawQueuePush(DrawQueue *pQueue, DrawKey Key, unsigned long Item);
+
+/*
+This function sorts the items by key, keeping the push order of equal keys
+*/
+void DrawQueueSort(DrawQueue *pQueue);
+
+/*
+This function walks the items in their current order, counts their state changes in the
+statistics, replacing the last submit's, and calls pDraw for each item when it is not null.
+Items pFilter rejects are skipped as if they had not been pushed; the queue is left as is,
+so one sorted queue can be submitted once per view
+*/
+void DrawQueueSubmit(DrawQueue *pQueue, DrawQueueFilter pFilter, DrawQueueFunc pDraw, void *pContext);
+
+/*
+This function times the sort of 100k items over a few frames, against qsort, and prints
+the state changes of the sorted order against the push order
+*/
+void DrawQueueBenchmark(void);
+
+#endif
@@ -0,0 +1,106 @@
+/* Start Header -------------------------------------------------------
+Copyright EventBus.h
+Purpose:  Game events, published into per-thread rings and dispatched at the sync point
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_EventBus.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include "AEEngine.h"
+
+#define EVENT_TYPE_MAX				16
+#define EVENT_RING_MAX				4					// Producer threads, ring 0 belongs to the main thread
+#define EVENT_SUBSCRIBER_MAX		8					// Per event type
+#define EVENT_CACHE_LINE			64
+
+typedef struct Event
+{
+	unsigned short		mType;					// Game defined, below EVENT_TYPE_MAX
+	unsigned short		mData;					// Type specific
+	unsigned long		mInstance;				// Instance slot the event is about
+	float				mX, mY;					// Where it happened
+}Event;
+
+/*
+Receives a run of consecutive events of the same type, in publishing order
+*/
+typedef void (*EventHandler)(const Event *pEvents, unsigned long Num, void *pContext);
+
+/*
+Single producer, single consumer. Head and tail keep counting up, the slot is the count masked.
+Each side only writes its own counter, on its own cache line, so publishing needs no interlocked operation
+*/
+typedef struct EventRing
+{
+	Event				*mpEvents;
+	unsigned long		mMask;					// Capacity - 1
+
+	// producer side
+	volatile unsigned long	mHead;				// Events published so far
+	unsigned long		mTailCache;				// Last tail seen by the producer, refreshed when the ring looks full
+	unsigned long		mDropped;				// Events rejected because the ring was full
+	char				mPad[EVENT_CACHE_LINE];
+
+	// consumer side
+	volatile unsigned long	mTail;				// Events dispatched so far
+	char				mPadTail[EVENT_CACHE_LINE];
+}EventRing;
+
+typedef struct EventSubscriber
+{
+	EventHandler		mpHandler;
+	void				*mpContext;
+}EventSubscriber;
+
+typedef struct EventBus
+{
+	EventRing			mRings[EVENT_RING_MAX];
+	EventSubscriber		mSubscribers[EVENT_TYPE_MAX][EVENT_SUBSCRIBER_MAX];
+	unsigned long		mSubscriberNum[EVENT_TYPE_MAX];
+}EventBus;
+
+
+/*
+This function allocates the rings, Capacity events each (rounded up to a power of 2).
+Nothing is allocated after this call
+*/
+void EventBusInit(EventBus *pBus, unsigned long Capacity);
+
+/*
+This function releases the rings
+*/
+void EventBusFree(EventBus *pBus);
+
+/*
+This function drops every pending event. Main thread only, no producer may be running
+*/
+void EventBusClear(EventBus *pBus);
+
+/*
+This function registers a handler for an event type. Returns 0 if the type has too many subscribers
+*/
+int EventBusSubscribe(EventBus *pBus, unsigned short Type, EventHandler Handler, void *pContext);
+
+/*
+This function writes an event into a ring. Only one thread may publish into a given ring.
+Returns 0 (and counts the event as dropped) if the ring is full
+*/
+int EventPublish(EventRing *pRing, unsigned short Type, unsigned short Data, unsigned long Instance, float X, float Y);
+
+/*
+This function hands the pending events of every ring to their subscribers.
+Main thread only, at the sync point. Events published by the handlers are dispatched next time
+*/
+void EventBusDispatch(EventBus *pBus);
+
+/*
+This function times publishing through a ring and dispatching the batches, and prints the cost per event
+*/
+void EventBusBenchmark(void);
+
+#endif
@@ -0,0 +1,63 @@
+/* Start Header -------------------------------------------------------
+Copyright InputQueue.h
+Purpose:  Timestamped key events, recorded by a dedicated input thread
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_InputQueue.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include "AEEngine.h"
+
+#define INPUT_QUEUE_CAPACITY		256					// Power of 2, key events between two reads
+#define INPUT_KEY_NUM				256					// Virtual key codes
+#define INPUT_WINDOW_MIN			1e-6				// Shortest frame window divided by, in seconds
+
+typedef struct InputEvent
+{
+	f64					mTime;					// InputQueueTime() when the key changed
+	unsigned char		mKey;					// Virtual key code
+	unsigned char		mDown;					// 1 pressed, 0 released. Auto repeats are not recorded
+}InputEvent;
+
+
+/*
+This function starts the input thread. It records the given keys while Window has the focus,
+through a low level keyboard hook, so events are timestamped as they happen whatever the frame rate.
+Returns 0 if the thread or the hook could not be created; the polled AEInput state still works
+*/
+int InputQueueStart(HWND Window, const unsigned char *pKeys, unsigned long KeyNum);
+
+/*
+This function stops the input thread and removes the hook
+*/
+void InputQueueStop(void);
+
+/*
+This function returns 1 while the input thread is recording
+*/
+int InputQueueIsRunning(void);
+
+/*
+This function returns the clock the events are stamped with, in seconds
+*/
+f64 InputQueueTime(void);
+
+/*
+This function takes the events recorded since the last read, oldest first, up to Max.
+The frame window goes from the previous read to now, or to the last event taken when more are
+left queued, and the time each watched key was held inside it is available from InputQueueHeldFraction.
+The window can be empty, divide by at least INPUT_WINDOW_MIN. Call once per frame
+*/
+unsigned long InputQueueRead(InputEvent *pEvents, unsigned long Max, f64 *pFrameStart, f64 *pFrameEnd);
+
+/*
+This function returns the part of the last read's frame window Key was held for, in [0;1]
+*/
+float InputQueueHeldFraction(unsigned char Key);
+
+#endif
@@ -0,0 +1,103 @@
+/* Start Header -------------------------------------------------------
+Copyright Island.h
+Purpose:  Circle contacts grouped into islands, solved in parallel, with sleeping
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Island.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef ISLAND_H
+#define ISLAND_H
+
+#include "AEEngine.h"
+
+#define ISLAND_THREAD_NUM			4
+#define ISLAND_PARALLEL_MIN			512					// Below this many contacts, everything runs on the calling thread
+#define ISLAND_ITERATION_NUM		4					// Velocity passes over the contacts of an island
+#define ISLAND_RESTITUTION			1.0f				// Elastic
+#define ISLAND_SLOP					0.5f				// Penetration left alone, in world units
+#define ISLAND_CORRECTION			0.8f				// Part of the remaining penetration removed per step
+#define ISLAND_SLEEP_SPEED			2.0f				// Speed relative to its island under which a body is resting
+#define ISLAND_SLEEP_TIME			0.5f				// Seconds an island must rest before it sleeps
+#define ISLAND_SLEEP_NONE			-1
+
+/*
+One entry per body slot. The owner writes the position, velocity, radius and inverse mass
+of every slot before a step and reads the position and velocity back after it. A radius
+of 0 marks an empty slot.
+Contacts are found by sweeping the bodies sorted on their left edge, then grouped into
+islands with a union-find. Islands share no body, so they are solved independently.
+A sleeping island only moves rigidly with its owner: its contacts are skipped until
+a body outside it touches it, or the owner changes one of its bodies' velocity.
+*/
+typedef struct IslandSolver
+{
+	long				mCapacity;
+
+	// bodies, written by the owner
+	float				*mpPosX, *mpPosY;
+	float				*mpVelX, *mpVelY;
+	float				*mpRadius;
+	float				*mpInvMass;
+
+	// sleep state, kept across steps
+	long				*mpSleepIsland;				// Island the body fell asleep in, ISLAND_SLEEP_NONE when awake
+	float				*mpSleepVelX, *mpSleepVelY;	// Velocity it fell asleep with, any other one wakes it
+	float				*mpRestTime;				// Seconds its island has been resting
+	unsigned char		*mpWake;					// Sleeping islands to wake, by name
+
+	// broadphase
+	long				*mpOrder;					// Slots sorted by left edge, kept across steps so the sort is nearly free
+	int					mOrderStale;				// Set by a clear, the next step fully sorts mpOrder
+	float				*mpMinX;					// Left edges, FLT_MAX for empty slots
+	float				*mpSortedMinX, *mpSortedPosX, *mpSortedPosY, *mpSortedRadius;	// Gathered in mpOrder for the sweep
+	long				*mpSortedSleepIsland;
+
+	// contacts and islands, rebuilt by every step
+	long				*mpContactA, *mpContactB;
+	long				mContactNum, mContactCapacity;
+	long				*mpParent;					// Union-find over the bodies
+	long				*mpIsland;					// Island of each root, -1 for none
+	long				*mpContactOrder;			// Contacts sorted by island
+	long				*mpIslandContactStart;		// mIslandNum + 1 entries
+	long				*mpBodyOrder;				// Bodies in a contact, sorted by island
+	long				*mpIslandBodyStart;			// mIslandNum + 1 entries
+	long				*mpCursor;					// Scratch of the counting sorts
+	long				mIslandNum;
+
+	int					mThreaded;					// 0 solves every island on the calling thread
+	long				mSleepingNum;				// Sleeping bodies after the last step
+}IslandSolver;
+
+
+/*
+This function allocates a solver for Capacity body slots, all empty and awake
+*/
+void IslandSolverInit(IslandSolver *pSolver, long Capacity);
+
+/*
+This function releases the solver
+*/
+void IslandSolverFree(IslandSolver *pSolver);
+
+/*
+This function empties every slot and wakes everything
+*/
+void IslandSolverClear(IslandSolver *pSolver);
+
+/*
+This function finds the contacts, builds the islands, solves the awake ones over Dt and
+puts the ones that have been resting long enough to sleep.
+It only changes velocities (elastic impulses) and positions (penetration correction), it does not integrate
+*/
+void IslandSolverStep(IslandSolver *pSolver, float Dt);
+
+/*
+This function times a dense field of 20k bodies, half of them in drifting rafts of touching bodies,
+on one thread and on ISLAND_THREAD_NUM threads, and prints the result
+*/
+void IslandSolverBenchmark(void);
+
+#endif
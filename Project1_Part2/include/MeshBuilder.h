@@ -0,0 +1,43 @@
+/* Start Header -------------------------------------------------------
+Copyright MeshBuilder.h
+Purpose:  Bulk mesh creation from vertex/index arrays
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_MeshBuilder.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef MESH_BUILDER_H
+#define MESH_BUILDER_H
+
+#include "AEEngine.h"
+
+typedef struct MeshVertex
+{
+	float				mX, mY;					// Position, in the [-0.5;0.5] range for normalized shapes
+	unsigned int		mColor;					// ARGB
+	float				mU, mV;					// Texture coordinates
+}MeshVertex;
+
+
+/*
+This function creates a mesh from a whole triangle list in one call.
+If pIndices is NULL, every 3 consecutive vertices form a triangle,
+otherwise every 3 consecutive indices do. Triangles are counter clockwise
+*/
+AEGfxVertexList* MeshCreate(const MeshVertex *pVertices, unsigned long VertexNum, const unsigned short *pIndices, unsigned long IndexNum);
+
+/*
+This function merges identical vertices of a triangle list.
+pOutVertices receives the unique vertices (VertexNum at most), pOutIndices receives VertexNum indices.
+Returns the number of unique vertices
+*/
+unsigned long MeshDeduplicate(const MeshVertex *pVertices, unsigned long VertexNum, MeshVertex *pOutVertices, unsigned short *pOutIndices);
+
+/*
+This function times building 10k procedural asteroid outlines with MeshCreate and prints the result
+*/
+void MeshBuilderBenchmark(void);
+
+#endif
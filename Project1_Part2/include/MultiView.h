@@ -0,0 +1,46 @@
+/* Start Header -------------------------------------------------------
+Copyright MultiView.h
+Purpose:  Split screen views, culled together against the bounds cache
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_MultiView.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef MULTI_VIEW_H
+#define MULTI_VIEW_H
+
+#include "Bounds.h"
+
+#define VIEW_NUM_MAX				4					// One bit per view in a visibility mask
+
+typedef struct View
+{
+	int					mX, mY;						// Viewport, in pixels from the window's bottom left corner
+	int					mWidth, mHeight;
+
+	float				mCamX, mCamY;				// Camera position
+	float				mMinX, mMinY;				// World rectangle seen through the view
+	float				mMaxX, mMaxY;
+}View;
+
+
+/*
+This function splits the window between ViewNum views: 1 full window, 2 side by side, 3 and 4 in quadrants
+*/
+void ViewsLayout(View *pViews, long ViewNum, int WinWidth, int WinHeight);
+
+/*
+This function places the camera of a view and computes the world rectangle it sees.
+HalfWidth/HalfHeight are the half extents of the world area mapped to the viewport
+*/
+void ViewSetCamera(View *pView, float CamX, float CamY, float HalfWidth, float HalfHeight);
+
+/*
+This function tests entries [0, Count) of the bounds cache against every view in one pass.
+Bit v of pMasks[i] is set if entry i overlaps view v. Four entries are tested at a time with SSE when available
+*/
+void ViewsCull(const View *pViews, long ViewNum, const BoundsCache *pBounds, long Count, unsigned char *pMasks);
+
+#endif
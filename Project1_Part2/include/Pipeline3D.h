@@ -0,0 +1,208 @@
+/* Start Header -------------------------------------------------------
+Copyright Pipeline3D.h
+Purpose:  Software 3D pipeline: vertex stage, clipping, tiled rasterizer with a depth buffer
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Pipeline3D.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef PIPELINE_3D_H
+#define PIPELINE_3D_H
+
+#define PIPELINE_3D_THREAD_NUM		4
+#define PIPELINE_3D_TILE_SHIFT		6					// Raster tiles are (1 << shift) pixels on each side
+#define PIPELINE_3D_TILE_SIZE		(1 << PIPELINE_3D_TILE_SHIFT)
+#define PIPELINE_3D_AMBIENT			0.25f				// Light every face gets, facing the light or not
+
+/*
+Same layouts as Matrix4 and Point4, so their data can be passed as is: row major,
+points are columns and transformed as M * p
+*/
+typedef struct Pipeline3DMatrix
+{
+	float m[4][4];
+}Pipeline3DMatrix;
+
+typedef struct Pipeline3DPoint
+{
+	float x, y, z, w;
+}Pipeline3DPoint;
+
+/*
+Indexed triangle mesh, counter clockwise seen from the outside
+*/
+typedef struct Pipeline3DMesh
+{
+	Pipeline3DPoint		*mpPositions;				// w = 1
+	Pipeline3DPoint		*mpNormals;					// w = 0
+	unsigned short		*mpIndices;					// 3 per triangle
+	long				mVertexNum;
+	long				mTriangleNum;
+}Pipeline3DMesh;
+
+/*
+Output of the vertex stage, the Vertex of 3DPipelineTools
+*/
+typedef struct Pipeline3DVertex
+{
+	float				mX, mY, mZ, mW;				// Clip space
+	float				mZInCamera;					// Distance in front of the camera, the clip w of a perspective projection
+	float				mZDepth;					// Depth buffer value, [0, 1] between the near and far planes
+	float				mShade;						// Light of the vertex, from its normal
+}Pipeline3DVertex;
+
+/*
+A clipped, projected, front facing triangle: pixel coordinates with a positive winding,
+and its depth as a plane over the screen
+*/
+typedef struct Pipeline3DTriangle
+{
+	float				mX0, mY0, mX1, mY1, mX2, mY2;
+	float				mZ0, mDzDx, mDzDy;
+	unsigned int		mColor;
+	long				mMinX, mMinY, mMaxX, mMaxY;	// Pixels covered by its box, inside the target
+}Pipeline3DTriangle;
+
+typedef struct Pipeline3DStats
+{
+	unsigned long		mVertexNum;					// Through the vertex stage
+	unsigned long		mTriangleNum;				// Submitted
+	unsigned long		mClippedNum;				// Cut by the near plane
+	unsigned long		mCulledNum;					// Back facing, off screen or behind the camera
+	unsigned long		mPixelTestedNum;			// Inside a triangle, depth tested
+	unsigned long		mPixelWrittenNum;			// Passed the depth test
+}Pipeline3DStats;
+
+/*
+Draws queue their triangles into the tiles they cover, Pipeline3DFlush rasterizes the tiles
+on PIPELINE_3D_THREAD_NUM threads. A tile is only touched by one thread, in draw order,
+so the image does not depend on the thread count.
+*/
+typedef struct Pipeline3DTarget
+{
+	long				mWidth, mHeight;
+	unsigned int		*mpColor;					// 0xAARRGGBB, top row first
+	float				*mpDepth;
+	long				mTileNumX, mTileNumY;
+
+	float				mLightX, mLightY, mLightZ;	// Direction towards the light, in camera space
+
+	// vertex stage scratch, sized to the largest mesh drawn
+	Pipeline3DVertex	*mpVertices;
+	long				mVertexCapacity;
+
+	// triangles queued since the last flush, and their (tile, triangle) pairs
+	Pipeline3DTriangle	*mpTriangles;
+	long				mTriangleNum, mTriangleCapacity;
+	long				*mpPairTiles, *mpPairTriangles;
+	long				mPairNum, mPairCapacity;
+
+	// bins, rebuilt by every flush
+	long				*mpBinStart;				// mTileNumX * mTileNumY + 1 entries
+	long				*mpBinItems;
+
+	int					mThreaded;					// 0 rasterizes every tile on the calling thread
+	Pipeline3DStats		mStats;
+}Pipeline3DTarget;
+
+
+/*
+This function sets the matrix Result to the identity matrix
+*/
+void Pipeline3DIdentity(Pipeline3DMatrix *pResult);
+
+/*
+This function multiplies Mtx0 with Mtx1 and saves the result in Result
+Result = Mtx0*Mtx1
+*/
+void Pipeline3DConcat(Pipeline3DMatrix *pResult, const Pipeline3DMatrix *pMtx0, const Pipeline3DMatrix *pMtx1);
+
+/*
+This function creates a translation matrix from x, y and z and saves it in Result
+*/
+void Pipeline3DTranslate(Pipeline3DMatrix *pResult, float x, float y, float z);
+
+/*
+This function creates a scaling matrix from x, y and z and saves it in Result
+*/
+void Pipeline3DScale(Pipeline3DMatrix *pResult, float x, float y, float z);
+
+/*
+This function creates a rotation of Angle radians around the unit axis (x, y, z) and saves it in Result
+*/
+void Pipeline3DRotateAxisAngle(Pipeline3DMatrix *pResult, float x, float y, float z, float Angle);
+
+/*
+This function creates the world to camera matrix of a camera at Position looking at Target, MtxLookAt.
+The camera looks down its -z axis
+*/
+void Pipeline3DLookAt(Pipeline3DMatrix *pResult, const Pipeline3DPoint *pPosition, const Pipeline3DPoint *pTarget, const Pipeline3DPoint *pUp);
+
+/*
+This function creates a perspective projection, MtxPerspectiveProjection. FovY is in radians,
+the near and far planes map to depths -1 and 1 before the divide
+*/
+void Pipeline3DPerspective(Pipeline3DMatrix *pResult, float FovY, float AspectRatio, float Near, float Far);
+
+/*
+This function computes the matrix that transforms normals along with Input, MtxNormalMatrix:
+the inverse transpose of its upper 3x3, without translation
+*/
+void Pipeline3DNormalMatrix(Pipeline3DMatrix *pResult, const Pipeline3DMatrix *pInput);
+
+/*
+This function allocates a Width x Height target and its depth buffer
+*/
+void Pipeline3DTargetInit(Pipeline3DTarget *pTarget, long Width, long Height);
+
+/*
+This function releases the target
+*/
+void Pipeline3DTargetFree(Pipeline3DTarget *pTarget);
+
+/*
+This function clears the color to Color, the depth to the far plane, and the statistics
+*/
+void Pipeline3DClear(Pipeline3DTarget *pTarget, unsigned int Color);
+
+/*
+This function runs the mesh through the vertex stage with ModelView then Projection,
+clips its triangles against the near plane, culls the back facing ones and queues the rest
+in their tiles. Faces are flat shaded from Color and the normals of their vertices
+*/
+void Pipeline3DDrawMesh(Pipeline3DTarget *pTarget, const Pipeline3DMesh *pMesh,
+	const Pipeline3DMatrix *pModelView, const Pipeline3DMatrix *pProjection, unsigned int Color);
+
+/*
+This function rasterizes the queued triangles with the depth test, one tile at a time
+*/
+void Pipeline3DFlush(Pipeline3DTarget *pTarget);
+
+/*
+This function writes the color buffer to a binary PPM file. Returns 0 if it could not be written
+*/
+int Pipeline3DImageWrite(const Pipeline3DTarget *pTarget, const char *pFileName);
+
+/*
+This function builds a lumpy sphere, an asteroid, of unit radius on average: Rings x Segments
+vertices with their normals. Seed picks the lumps
+*/
+void Pipeline3DMeshAsteroid(Pipeline3DMesh *pMesh, long Rings, long Segments, unsigned long Seed);
+
+/*
+This function releases a mesh built by Pipeline3DMeshAsteroid
+*/
+void Pipeline3DMeshFree(Pipeline3DMesh *pMesh);
+
+/*
+This function renders a field of spinning 3D asteroids at 1280x720 for a few frames,
+on one thread then on PIPELINE_3D_THREAD_NUM, and returns the rates of each run: vertices
+through the vertex stage and pixels depth tested, per second. The last frame is written
+to pFileName when it is not null.
+It only needs the C runtime and threads, so it runs in a headless build as well
+*/
+void Pipeline3DBenchmark(double pVerticesPerSecond[2], double pPixelsPerSecond[2], const char *pFileName);
+
+#endif
@@ -0,0 +1,113 @@
+/* Start Header -------------------------------------------------------
+Copyright Projectile.h
+Purpose:  Bullets stored apart from the game object instances, in a FIFO ring of SoA records
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Projectile.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef PROJECTILE_H
+#define PROJECTILE_H
+
+#include "AEEngine.h"
+#include "Atlas.h"
+
+#define PROJECTILE_GRID_SHIFT		5					// The broadphase grid is (1 << shift) cells on each side
+#define PROJECTILE_GRID_DIM			(1 << PROJECTILE_GRID_SHIFT)
+#define PROJECTILE_DRAW_BATCH		16384				// Bullets per mesh built by ProjectileMeshBuild
+#define PROJECTILE_NONE				-1
+
+/*
+Bullets are fired and mostly retired in order, so they live in a ring: fired at the tail,
+retired from the head. A bullet killed out of order only clears its alive byte, the head
+skips it once everything older is gone. mHead and mTail are running counters, the slot of
+counter c is (c & (mCapacity - 1)).
+Each update integrates and culls the whole live range four bullets at a time, then sorts
+the survivors into a uniform grid over the cull rectangle for the hit queries.
+*/
+typedef struct ProjectileSystem
+{
+	unsigned long		mCapacity;					// Power of two, at least 4
+	unsigned long		mHead, mTail;				// Live range [mHead, mTail)
+	unsigned long		mLiveNum;					// Alive bullets, as of the last update or kill
+	unsigned long		mOverwrittenNum;			// Oldest bullets dropped because the ring was full
+
+	float				*mpPosX, *mpPosY;
+	float				*mpVelX, *mpVelY;
+	int					*mpCell;					// Grid cell of each slot, from the last update
+	unsigned char		*mpAlive;
+
+	// Broadphase grid, rebuilt by every update
+	float				mGridMinX, mGridMinY;
+	float				mGridMaxX, mGridMaxY;
+	float				mCellScaleX, mCellScaleY;	// Cells per world unit
+	unsigned long		*mpCellStart;				// First item of each cell, PROJECTILE_GRID_DIM^2 + 1 entries
+	unsigned long		*mpCellCursor;				// Scratch of the counting sort
+	unsigned long		*mpCellItems;				// Alive slots sorted by cell, oldest first within a cell
+
+	// Meshes of the last ProjectileMeshBuild, in world space
+	AEGfxVertexList		**mppMeshes;
+	unsigned long		mMeshNum;
+}ProjectileSystem;
+
+
+/*
+This function allocates a ring of Capacity bullets, rounded up to a power of two
+*/
+void ProjectileSystemInit(ProjectileSystem *pSystem, unsigned long Capacity);
+
+/*
+This function releases the ring, the grid and the meshes
+*/
+void ProjectileSystemFree(ProjectileSystem *pSystem);
+
+/*
+This function retires every bullet
+*/
+void ProjectileSystemClear(ProjectileSystem *pSystem);
+
+/*
+This function fires a bullet. When the ring is full the oldest bullet is dropped to make room
+*/
+void ProjectileFire(ProjectileSystem *pSystem, float PosX, float PosY, float VelX, float VelY);
+
+/*
+This function moves every bullet by its velocity over Dt, kills the ones outside
+the [MinX, MaxX] x [MinY, MaxY] rectangle, retires the dead ones at the head of the ring
+and rebuilds the grid over that rectangle
+*/
+void ProjectileUpdate(ProjectileSystem *pSystem, float Dt, float MinX, float MinY, float MaxX, float MaxY);
+
+/*
+This function returns the slot of the oldest alive bullet inside the box, or PROJECTILE_NONE.
+Only the grid cells the box covers are visited. Bullets fired since the last update are not in the grid
+*/
+long ProjectileHitFind(ProjectileSystem *pSystem, float MinX, float MinY, float MaxX, float MaxY);
+
+/*
+This function kills the bullet in a slot returned by ProjectileHitFind
+*/
+void ProjectileKill(ProjectileSystem *pSystem, long Slot);
+
+/*
+This function rebuilds the world space meshes of the alive bullets: squares of side Size,
+PROJECTILE_DRAW_BATCH bullets per mesh. The previous meshes are freed.
+Each square covers pRegion of the texture, or texture coordinates 0 when it is null
+*/
+void ProjectileMeshBuild(ProjectileSystem *pSystem, float Size, unsigned int Color, const AtlasRegion *pRegion);
+
+/*
+This function draws the meshes of the last ProjectileMeshBuild with an identity transform.
+The render mode, texture and tint are left to the caller
+*/
+void ProjectileDraw(ProjectileSystem *pSystem);
+
+/*
+This function keeps Num bullets alive in a window sized area for a few hundred frames,
+timing the update, the hit queries and the mesh build, and prints the result
+*/
+void ProjectileBenchmark(unsigned long Num);
+
+#endif
@@ -0,0 +1,74 @@
+/* Start Header -------------------------------------------------------
+Copyright Query.h
+Purpose:  Dense per-signature instance lists, iterated by component signature
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Query.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef QUERY_H
+#define QUERY_H
+
+// component signature bits
+#define COMPONENT_TRANSFORM			0x00000001
+#define COMPONENT_SPRITE			0x00000002
+#define COMPONENT_PHYSICS			0x00000004
+#define COMPONENT_TARGET			0x00000008
+
+#define QUERY_SIGNATURE_NUM			16					// Every combination of the 4 components above
+
+/*
+Every live instance is listed in the bucket of its exact signature. A query visits the
+buckets holding all the required components, so the loop body never checks for them.
+*/
+typedef struct Query
+{
+	unsigned long		*mpBuckets[QUERY_SIGNATURE_NUM];	// Instance indices
+	unsigned long		mBucketNum[QUERY_SIGNATURE_NUM];
+
+	unsigned long		*mpBucketSlot;			// Per instance: position in its bucket
+	unsigned char		*mpSignature;			// Per instance: signature, 0 when not listed
+	unsigned long		mCapacity;
+}Query;
+
+/*
+Visits the index Index of every listed instance having at least the Required components.
+Usage:	QUERY_EACH(&query, COMPONENT_TRANSFORM | COMPONENT_PHYSICS, i) { ... }
+Adding or removing instances of a visited signature inside the loop is not allowed
+*/
+#define QUERY_EACH(pQuery, Required, Index)																	\
+	for (unsigned long Index##Bucket = 0; Index##Bucket < QUERY_SIGNATURE_NUM; Index##Bucket++)				\
+		if ((Index##Bucket & (Required)) == (Required))														\
+			for (unsigned long Index##Slot = 0, Index;														\
+				Index##Slot < (pQuery)->mBucketNum[Index##Bucket] && ((Index = (pQuery)->mpBuckets[Index##Bucket][Index##Slot]), 1);	\
+				Index##Slot++)
+
+
+/*
+This function allocates the buckets for instance indices [0, Capacity)
+*/
+void QueryInit(Query *pQuery, unsigned long Capacity);
+
+/*
+This function releases the buckets
+*/
+void QueryFree(Query *pQuery);
+
+/*
+This function empties every bucket
+*/
+void QueryClear(Query *pQuery);
+
+/*
+This function lists instance Index under Signature, moving it if it was already listed
+*/
+void QueryAdd(Query *pQuery, unsigned long Index, unsigned long Signature);
+
+/*
+This function removes instance Index from its bucket. The last instance of the bucket takes its place
+*/
+void QueryRemove(Query *pQuery, unsigned long Index);
+
+#endif
@@ -0,0 +1,60 @@
+/* Start Header -------------------------------------------------------
+Copyright Random.h
+Purpose:  Counter based random numbers (Philox4x32-10) with independent streams
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Random.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include "AEEngine.h"
+
+/*
+The output is a pure function of (seed, stream, counter): generators with a different
+stream never overlap, need no locking, and replay exactly from the same seed.
+*/
+typedef struct Random
+{
+	u32					mKey[2];				// Seed, stream
+	u32					mCounter[4];			// Index of the next block
+	u32					mBuffer[4];				// Current block
+	u32					mBufferIndex;			// Next unused word of mBuffer, 4 when empty
+}Random;
+
+
+/*
+This function starts a generator at the beginning of the given stream
+*/
+void RandomInit(Random *pRandom, u32 Seed, u32 Stream);
+
+/*
+This function returns 32 random bits
+*/
+u32 RandomU32(Random *pRandom);
+
+/*
+This function returns a random float in [0;1)
+*/
+float RandomFloat(Random *pRandom);
+
+/*
+This function returns a random float in [Min;Max)
+*/
+float RandomRange(Random *pRandom, float Min, float Max);
+
+/*
+This function fills pOut with Num random floats in [0;1), 4 blocks at a time with SSE2 when available.
+The values are the ones Num calls to RandomFloat would have returned
+*/
+void RandomFillFloat(Random *pRandom, float *pOut, unsigned long Num);
+
+/*
+This function times AERandFloat, RandomFloat and RandomFillFloat and prints their throughput
+*/
+void RandomBenchmark(void);
+
+#endif
@@ -0,0 +1,133 @@
+/* Start Header -------------------------------------------------------
+Copyright RenderTrace.h
+Purpose:  Capture of the AEGfx calls made while drawing, for offline replay
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_RenderTrace.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef RENDER_TRACE_H
+#define RENDER_TRACE_H
+
+#include "AEEngine.h"
+#include "MeshBuilder.h"
+
+#define RENDER_TRACE_MAGIC			0x45435254			// "TRCE"
+#define RENDER_TRACE_VERSION		3
+#define RENDER_TRACE_FILE			"Render.trace"
+#define RENDER_TRACE_MESH_MAX		64
+#define RENDER_TRACE_VERTEX_MAX		8192				// Triangle list vertices of all the traced meshes
+#define RENDER_TRACE_BUFFER_SIZE	(32 * 1024 * 1024)	// Calls of a whole capture, the last frames are dropped past it
+#define RENDER_TRACE_MESH_UNKNOWN	0xFF				// Drawn mesh that was not created through RenderTraceMeshCreate
+#define RENDER_TRACE_TRANSIENT_MAX	16					// Meshes created through RenderTraceMeshCreateTransient per frame
+#define RENDER_TRACE_TEXTURE_MAX	4
+#define RENDER_TRACE_TEXTURE_NONE	0xFF				// No texture set, or one not created through RenderTraceTextureCreate
+
+/*
+One record per call: the op byte, then its payload, unaligned.
+*/
+typedef enum
+{
+	RENDER_TRACE_OP_FRAME = 0,				// f32 camera x, y: start of a frame
+	RENDER_TRACE_OP_RENDER_MODE,			// u8 AEGfxRenderMode
+	RENDER_TRACE_OP_TEXTURE,				// u8 texture, f32 offset x, y
+	RENDER_TRACE_OP_TINT,					// f32 r, g, b, a
+	RENDER_TRACE_OP_BLEND_MODE,				// u8 AEGfxBlendMode
+	RENDER_TRACE_OP_TRANSFORM,				// f32 x 6, the first two rows of the matrix
+	RENDER_TRACE_OP_DRAW,					// u8 mesh, u8 AEGfxMeshDrawMode
+	RENDER_TRACE_OP_CAMERA,					// f32 x, y
+	RENDER_TRACE_OP_VIEWPORT,				// s32 x, y, width, height
+	RENDER_TRACE_OP_DRAW_VERTICES,			// u32 vertex count, then the RenderTraceVertex triangle list of a transient mesh
+
+	RENDER_TRACE_OP_NUM
+}RENDER_TRACE_OP;
+
+/*
+File layout: the header, the meshes, their vertices, the textures, their texels, then mCallSize bytes of records
+*/
+typedef struct RenderTraceHeader
+{
+	u32					mMagic;
+	u32					mVersion;
+	u32					mWidth, mHeight;			// Window size
+	u32					mFrameNum;
+	u32					mCallNum;					// Frame markers excluded
+	u32					mMeshNum;
+	u32					mVertexNum;
+	u32					mTextureNum;
+	u32					mTexelNum;
+	u32					mCallSize;
+}RenderTraceHeader;
+
+typedef struct RenderTraceMesh
+{
+	u32					mVertexFirst, mVertexNum;	// Triangle list
+}RenderTraceMesh;
+
+typedef struct RenderTraceVertex
+{
+	f32					mX, mY;
+	u32					mColor;						// ARGB
+	f32					mU, mV;
+}RenderTraceVertex;
+
+typedef struct RenderTraceTexture
+{
+	u32					mWidth, mHeight;
+	u32					mTexelFirst;				// ARGB, top row first
+}RenderTraceTexture;
+
+
+/*
+This function forgets the traced meshes, call it once they are freed
+*/
+void RenderTraceMeshClear(void);
+
+/*
+This function creates a mesh with MeshCreate and keeps a copy of its triangles for the traces
+*/
+AEGfxVertexList* RenderTraceMeshCreate(const MeshVertex *pVertices, unsigned long VertexNum, const unsigned short *pIndices, unsigned long IndexNum);
+
+/*
+This function creates a mesh with MeshCreate for the current frame only, Vertices being a triangle list.
+While capturing, every draw of it records its triangles inline: meant for meshes rebuilt each frame,
+which would not fit the mesh table
+*/
+AEGfxVertexList* RenderTraceMeshCreateTransient(const MeshVertex *pVertices, unsigned long VertexNum);
+
+/*
+This function forgets the traced textures, call it once they are unloaded
+*/
+void RenderTraceTextureClear(void);
+
+/*
+This function creates a texture from Width x Height ARGB pixels, top row first, and keeps
+a copy of them for the traces
+*/
+AEGfxTexture* RenderTraceTextureCreate(const unsigned int *pPixels, unsigned long Width, unsigned long Height);
+
+/*
+This function records the next FrameNum frames, then writes them to RENDER_TRACE_FILE
+*/
+void RenderTraceCaptureStart(unsigned long FrameNum);
+
+/*
+This function marks the start of a frame's drawing. It ends the capture once enough frames were recorded
+*/
+void RenderTraceFrame(void);
+
+// ---------------------------------------------------------------------------
+// AEGfx calls, forwarded to the engine and recorded while capturing
+
+void RenderTraceSetRenderMode(unsigned int RenderMode);
+void RenderTraceTextureSet(AEGfxTexture *pTexture, f32 OffsetX, f32 OffsetY);
+void RenderTraceSetTintColor(float Red, float Green, float Blue, float Alpha);
+void RenderTraceSetBlendMode(unsigned int BlendMode);
+void RenderTraceSetTransform(float pTransform[3][3]);
+void RenderTraceMeshDraw(AEGfxVertexList *pVertexList, unsigned int MeshDrawMode);
+void RenderTraceSetCamPosition(f32 X, f32 Y);
+void RenderTraceSetViewport(int ViewportX, int ViewportY, int ViewportWidth, int ViewportHeight);
+
+#endif
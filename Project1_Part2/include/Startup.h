@@ -0,0 +1,56 @@
+/* Start Header -------------------------------------------------------
+Copyright Startup.h
+Purpose:  Startup timeline, lazy init and headless mode flags
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Startup.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include "AEEngine.h"
+
+#define STARTUP_MARK_MAX				32
+#define STARTUP_FIRST_FRAME_BUDGET		50.0				// Target time from WinMain to the first frame, in ms
+#define STARTUP_HEADLESS_FRAME_NUM		600					// Frames simulated by a headless run before it quits
+
+// ---------------------------------------------------------------------------
+// externs
+
+extern int gStartupLazy;				// "-lazy" on the command line: the console opens on the first print, the gravity tree on the first 'G'
+extern int gStartupHeadless;			// "-headless": hidden window, no drawing and no sprite atlas, implies lazy
+
+
+/*
+This function reads the startup flags from the command line
+*/
+void StartupParse(const char *pCommandLine);
+
+/*
+This function records the time elapsed since the first mark under the given name.
+The name must stay valid until the report is printed
+*/
+void StartupMark(const char *pName);
+
+/*
+This function prints like printf, to the engine console when it was created.
+In lazy mode the first call attaches to the parent console, or opens one, so nothing printed is lost.
+Main thread only
+*/
+void StartupPrintf(const char *pFormat, ...);
+
+/*
+This function prints the timeline once, flagging a first frame over STARTUP_FIRST_FRAME_BUDGET.
+Later calls do nothing
+*/
+void StartupReport(void);
+
+/*
+This function returns 0 once the report found the first frame over its budget, 1 otherwise
+*/
+int StartupWithinBudget(void);
+
+#endif
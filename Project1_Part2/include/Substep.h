@@ -0,0 +1,72 @@
+/* Start Header -------------------------------------------------------
+Copyright Substep.h
+Purpose:  Movers grouped by the number of sub-steps they need in a frame
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Substep.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef SUBSTEP_H
+#define SUBSTEP_H
+
+#include "AEEngine.h"
+
+#define SUBSTEP_LEVEL_NUM			5					// A mover at level l takes (1 << l) sub-steps, 16 at most
+#define SUBSTEP_LEVEL_MAX			(SUBSTEP_LEVEL_NUM - 1)
+
+/*
+Every frame the movers are added with their level, then sorted so the ones taking the
+same number of sub-steps sit next to each other. Each batch is then integrated in one
+loop, and only the few fast movers pay for the extra steps.
+*/
+typedef struct SubstepBatches
+{
+	unsigned long		mCapacity;
+	unsigned long		mNum;
+	unsigned long		*mpAdded;					// Movers in the order they were added
+	unsigned char		*mpLevel;					// Level of each added mover
+	unsigned long		*mpItems;					// Movers sorted by level, after SubstepBatchesSort
+	unsigned long		mStart[SUBSTEP_LEVEL_NUM + 1];	// First item of each level
+}SubstepBatches;
+
+
+/*
+This function allocates room for Capacity movers per frame
+*/
+void SubstepBatchesInit(SubstepBatches *pBatches, unsigned long Capacity);
+
+/*
+This function releases the batches
+*/
+void SubstepBatchesFree(SubstepBatches *pBatches);
+
+/*
+This function removes every mover, before the ones of a new frame are added
+*/
+void SubstepBatchesClear(SubstepBatches *pBatches);
+
+/*
+This function adds a mover with its level
+*/
+void SubstepBatchesAdd(SubstepBatches *pBatches, unsigned long Item, unsigned char Level);
+
+/*
+This function sorts the added movers by level, keeping their order within a level
+*/
+void SubstepBatchesSort(SubstepBatches *pBatches);
+
+/*
+This function returns the smallest level whose sub-steps cover at most Reach of the
+Travel a mover makes in a frame, capped at SUBSTEP_LEVEL_MAX
+*/
+unsigned char SubstepLevel(float Travel, float Reach);
+
+/*
+This function times 100k movers, 1% of them fast, integrated and tested against an obstacle
+at a fixed rate high enough for the fast ones and then in batches, and prints the result
+*/
+void SubstepBenchmark(void);
+
+#endif
@@ -0,0 +1,44 @@
+/* Start Header -------------------------------------------------------
+Copyright WorkerPool.h
+Purpose:  Persistent worker threads shared by the parallel solvers
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_WorkerPool.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include "AEEngine.h"
+
+#define WORKER_POOL_THREAD_NUM		3					// Workers, the calling thread runs the first job itself
+
+typedef void(*WorkerJobFunc)(void *pJob);
+
+/*
+The workers are created once and sleep on their own event between two runs, so a run only costs
+a wake and a wait. Every subsystem using the pool starts it when it is initialized and stops it when
+it is released; the workers exit with the last stop.
+*/
+
+/*
+This function creates the workers on the first call and counts the users after it.
+Returns 0 if they could not be created, WorkerPoolRun then runs every job on the calling thread
+*/
+int WorkerPoolStart(void);
+
+/*
+This function stops the workers once every user that started the pool stopped it
+*/
+void WorkerPoolStop(void);
+
+/*
+This function calls pFunc on each of the JobNum jobs of JobSize bytes at pJobs and returns once
+they are all done. The first job runs on the calling thread, the next WORKER_POOL_THREAD_NUM on
+the workers, any others on the calling thread as well. Main thread only
+*/
+void WorkerPoolRun(WorkerJobFunc pFunc, void *pJobs, unsigned long JobSize, long JobNum);
+
+#endif
@@ -0,0 +1,103 @@
+/* Start Header -------------------------------------------------------
+Copyright World.h
+Purpose:  Chunked world storage, far chunks kept as compact frozen records
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_World.h_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#ifndef WORLD_H
+#define WORLD_H
+
+#include "AEEngine.h"
+#include "Vector2D.h"
+
+#define WORLD_VELOCITY_STEP			(1.0f / 16.0f)		// Velocity precision of a frozen record (m/s)
+#define WORLD_SCALE_STEP			(1.0f / 16.0f)		// Scale precision of a frozen record
+
+/*
+Everything needed to bring an entity back, 14 bytes instead of an instance and its components.
+The position is relative to the chunk's corner, in 1/65536 of the chunk size
+*/
+typedef struct WorldRecord
+{
+	unsigned short		mX, mY;
+	short				mVelX, mVelY;		// In WORLD_VELOCITY_STEP
+	unsigned short		mScale;				// In WORLD_SCALE_STEP
+	unsigned char		mAngle;				// In 1/256 of a turn
+	unsigned char		mType;				// Filled by the owner
+	unsigned char		mShape;				// Filled by the owner
+	unsigned char		mSplitDepth;		// Filled by the owner
+}WorldRecord;
+
+typedef struct WorldChunk
+{
+	long				mX, mY;				// Chunk coordinates
+	unsigned long		mUsed;				// 0 for an empty slot of the table
+	unsigned long		mSeeded;			// Set by the owner once the chunk got its initial content, whoever created it
+
+	WorldRecord			*mpRecords;			// Frozen entities
+	unsigned long		mRecordNum;
+	unsigned long		mRecordCapacity;
+}WorldChunk;
+
+/*
+Chunks are created on first visit and never removed, in an open addressing table
+keyed by their coordinates, so the world has no edge.
+*/
+typedef struct World
+{
+	WorldChunk			*mpChunks;
+	unsigned long		mChunkCapacity;		// Power of 2
+	unsigned long		mChunkNum;
+
+	float				mChunkSize;
+	long				mActiveRadius;		// Chunks within this distance of the camera chunk are live
+}World;
+
+
+/*
+This function initializes an empty world
+*/
+void WorldInit(World *pWorld, float ChunkSize, long ActiveRadius);
+
+/*
+This function releases every chunk and its records
+*/
+void WorldFree(World *pWorld);
+
+/*
+This function computes the coordinates of the chunk containing (x, y)
+*/
+void WorldChunkCoord(const World *pWorld, float x, float y, long *pChunkX, long *pChunkY);
+
+/*
+This function returns 1 if the chunk (ChunkX, ChunkY) is live around the camera chunk (CamX, CamY)
+*/
+int WorldChunkIsActive(const World *pWorld, long ChunkX, long ChunkY, long CamX, long CamY);
+
+/*
+This function returns the chunk (ChunkX, ChunkY), creating it if needed.
+*pCreated is set to 1 if the chunk did not exist before the call
+*/
+WorldChunk* WorldChunkGet(World *pWorld, long ChunkX, long ChunkY, int *pCreated);
+
+/*
+This function appends a record to the chunk, and returns it for the owner to fill the remaining fields.
+Position, velocity, angle and scale are quantized here; the position must be inside the chunk
+*/
+WorldRecord* WorldChunkFreeze(World *pWorld, WorldChunk *pChunk, Vector2D *pPosition, Vector2D *pVelocity, float Angle, float Scale);
+
+/*
+This function restores the position, velocity, angle and scale stored in a record of the chunk
+*/
+void WorldRecordThaw(const World *pWorld, const WorldChunk *pChunk, const WorldRecord *pRecord, Vector2D *pPosition, Vector2D *pVelocity, float *pAngle, float *pScale);
+
+/*
+This function removes the first Count records of the chunk, keeping the others
+*/
+void WorldChunkRemove(WorldChunk *pChunk, unsigned long Count);
+
+#endif
@@ -19,6 +19,9 @@
 // game state manager
 #include "GameStateMgr.h"
 
+// startup timeline and flags
+#include "Startup.h"
+
 #endif // MAIN_H
 
 
@@ -0,0 +1,150 @@
+/* Start Header -------------------------------------------------------
+Copyright AssetPack.c
+Purpose:  Implementation of the memory mapped asset pack
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_AssetPack.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "AssetPack.h"
+
+// ---------------------------------------------------------------------------
+
+// Checks that Num elements of ElementSize bytes at Offset are aligned and inside the file
+static int AssetPackSectionValid(const AssetPackHeader *pHeader, u32 Offset, u32 Num, u32 ElementSize)
+{
+	if (Offset % ASSET_PACK_ALIGN != 0 || Offset > pHeader->mSize)
+		return 0;
+
+	return Num <= (pHeader->mSize - Offset) / ElementSize;
+}
+
+// ---------------------------------------------------------------------------
+
+// Checks that First + Num stays within Total, without overflowing
+static int AssetPackRangeValid(u32 First, u32 Num, u32 Total)
+{
+	return First <= Total && Num <= Total - First;
+}
+
+// ---------------------------------------------------------------------------
+
+// Checks the contents of the mapped sections, so the game can use them without any further test
+static int AssetPackContentValid(const AssetPack *pPack, u32 ObjectTypeNum)
+{
+	const AssetPackHeader *pHeader = pPack->mpHeader;
+	u32 typeMask = 0, i, k;
+
+	for (i = 0; i < pHeader->mShapeNum; i++)
+	{
+		const AssetPackShape *pShape = pPack->mpShapes + i;
+
+		if (pShape->mType >= ObjectTypeNum || pShape->mVertexNum == 0
+			|| !AssetPackRangeValid(pShape->mVertexFirst, pShape->mVertexNum, pHeader->mVertexNum)
+			|| !AssetPackRangeValid(pShape->mIndexFirst, pShape->mIndexNum, pHeader->mIndexNum)
+			|| (pShape->mIndexNum ? pShape->mIndexNum : pShape->mVertexNum) % 3 != 0)
+			return 0;
+
+		for (k = 0; k < pShape->mIndexNum; k++)
+			if (pPack->mpIndices[pShape->mIndexFirst + k] >= pShape->mVertexNum)
+				return 0;
+
+		if (pShape->mType < 32)
+			typeMask |= 1u << pShape->mType;
+	}
+
+	// Every object type needs a shape, its instances would have none to draw and collide with
+	for (i = 0; i < ObjectTypeNum && i < 32; i++)
+		if ((typeMask & (1u << i)) == 0)
+			return 0;
+
+	for (i = 0; i < pHeader->mWaveNum; i++)
+		if (!AssetPackRangeValid(pPack->mpWaves[i].mSpawnFirst, pPack->mpWaves[i].mSpawnNum, pHeader->mSpawnNum))
+			return 0;
+
+	for (i = 0; i < pHeader->mSpawnNum; i++)
+		if (pPack->mpSpawns[i].mObjectType >= ObjectTypeNum || !(pPack->mpSpawns[i].mScale > 0.0f))
+			return 0;
+
+	return 1;
+}
+
+// ---------------------------------------------------------------------------
+
+int AssetPackOpen(AssetPack *pPack, const char *pFileName, u32 ObjectTypeNum)
+{
+	const AssetPackHeader *pHeader;
+	const char *pData;
+	LARGE_INTEGER size;
+
+	memset(pPack, 0, sizeof(AssetPack));
+
+	pPack->mFile = CreateFileA(pFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (pPack->mFile == INVALID_HANDLE_VALUE)
+	{
+		pPack->mFile = 0;
+		return 0;
+	}
+
+	if (!GetFileSizeEx(pPack->mFile, &size) || size.QuadPart < (LONGLONG)sizeof(AssetPackHeader))
+	{
+		AssetPackClose(pPack);
+		return 0;
+	}
+
+	pPack->mMapping = CreateFileMappingA(pPack->mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	pData = pPack->mMapping ? (const char *)MapViewOfFile(pPack->mMapping, FILE_MAP_READ, 0, 0, 0) : 0;
+	pHeader = (const AssetPackHeader *)pData;
+
+	if (0 == pHeader)
+	{
+		AssetPackClose(pPack);
+		return 0;
+	}
+
+	pPack->mpHeader = pHeader;
+
+	if (pHeader->mMagic != ASSET_PACK_MAGIC || pHeader->mVersion != ASSET_PACK_VERSION || pHeader->mSize != size.QuadPart
+		|| !AssetPackSectionValid(pHeader, pHeader->mShapeOffset, pHeader->mShapeNum, sizeof(AssetPackShape))
+		|| !AssetPackSectionValid(pHeader, pHeader->mVertexOffset, pHeader->mVertexNum, sizeof(MeshVertex))
+		|| !AssetPackSectionValid(pHeader, pHeader->mIndexOffset, pHeader->mIndexNum, sizeof(unsigned short))
+		|| !AssetPackSectionValid(pHeader, pHeader->mWaveOffset, pHeader->mWaveNum, sizeof(AssetPackWave))
+		|| !AssetPackSectionValid(pHeader, pHeader->mSpawnOffset, pHeader->mSpawnNum, sizeof(AssetPackSpawn)))
+	{
+		AE_WARNING_MESG(0, "%s is not a valid asset pack", pFileName);
+		AssetPackClose(pPack);
+		return 0;
+	}
+
+	// The sections are used in place, straight from the mapping
+	pPack->mpShapes = (const AssetPackShape *)(pData + pHeader->mShapeOffset);
+	pPack->mpVertices = (const MeshVertex *)(pData + pHeader->mVertexOffset);
+	pPack->mpIndices = (const unsigned short *)(pData + pHeader->mIndexOffset);
+	pPack->mpWaves = (const AssetPackWave *)(pData + pHeader->mWaveOffset);
+	pPack->mpSpawns = (const AssetPackSpawn *)(pData + pHeader->mSpawnOffset);
+
+	if (!AssetPackContentValid(pPack, ObjectTypeNum))
+	{
+		AE_WARNING_MESG(0, "%s has shapes, indices or spawns out of range", pFileName);
+		AssetPackClose(pPack);
+		return 0;
+	}
+
+	return 1;
+}
+
+// ---------------------------------------------------------------------------
+
+void AssetPackClose(AssetPack *pPack)
+{
+	if (pPack->mpHeader)
+		UnmapViewOfFile(pPack->mpHeader);
+	if (pPack->mMapping)
+		CloseHandle(pPack->mMapping);
+	if (pPack->mFile)
+		CloseHandle(pPack->mFile);
+
+	memset(pPack, 0, sizeof(AssetPack));
+}
@@ -0,0 +1,65 @@
+/* Start Header -------------------------------------------------------
+Copyright AsteroidOutline.c
+Purpose:  Implementation of the asteroid outline generator
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_AsteroidOutline.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "AsteroidOutline.h"
+#include "Random.h"
+#include <math.h>
+
+// ---------------------------------------------------------------------------
+
+unsigned long AsteroidOutlineGenerate(unsigned long Seed, unsigned long PointNum, float Roughness, unsigned int Color, MeshVertex *pVertices, unsigned short *pIndices)
+{
+	unsigned long i;
+	float radiusMax = 0.0f, step, scale;
+	Random random;
+
+	AE_ASSERT_PARM(PointNum >= ASTEROID_OUTLINE_POINT_MIN && PointNum <= ASTEROID_OUTLINE_POINT_MAX);
+
+	// Each seed is its own stream, outlines never depend on (or disturb) other random draws
+	RandomInit(&random, Seed, 0);
+
+	step = TWO_PI / PointNum;
+
+	pVertices[0].mX = pVertices[0].mY = 0.0f;
+	pVertices[0].mColor = Color;
+	pVertices[0].mU = pVertices[0].mV = 0.0f;
+
+	// Angles stay inside their own slice, so the outline is star shaped and the fan is valid
+	for (i = 0; i < PointNum; i++)
+	{
+		MeshVertex *pVertex = pVertices + 1 + i;
+		float angle = step * (i + 0.5f + 0.8f * Roughness * (RandomFloat(&random) - 0.5f));
+		float radius = 1.0f - 0.5f * Roughness * RandomFloat(&random);
+
+		pVertex->mX = radius * cosf(angle);
+		pVertex->mY = radius * sinf(angle);
+		pVertex->mColor = Color;
+		pVertex->mU = pVertex->mV = 0.0f;
+
+		radiusMax = max(radiusMax, radius);
+	}
+
+	scale = 0.5f / radiusMax;
+
+	for (i = 1; i <= PointNum; i++)
+	{
+		pVertices[i].mX *= scale;
+		pVertices[i].mY *= scale;
+	}
+
+	for (i = 0; i < PointNum; i++)
+	{
+		pIndices[3 * i] = 0;
+		pIndices[3 * i + 1] = (unsigned short)(1 + i);
+		pIndices[3 * i + 2] = (unsigned short)(1 + (i + 1) % PointNum);
+	}
+
+	return 3 * PointNum;
+}
@@ -0,0 +1,267 @@
+/* Start Header -------------------------------------------------------
+Copyright AsyncLog.c
+Purpose:  Implementation of the asynchronous logger
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_AsyncLog.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "AsyncLog.h"
+#include "Startup.h"
+#include <stdarg.h>
+
+#define ASYNC_LOG_LINE_MAX			512
+#define ASYNC_LOG_BENCHMARK_NUM		100000
+#define ASYNC_LOG_BENCHMARK_PRINT_NUM	10
+
+static AsyncLogRing				sgRings[ASYNC_LOG_RING_MAX];
+static volatile long			sgRingNum;					// Rings handed out to threads so far
+static __declspec(thread) long	sgThreadRing = -1;			// This thread's ring, claimed by its first record
+
+static HANDLE					sgThread;
+static HANDLE					sgWake;
+static volatile int				sgRunning;
+static FILE*					sgpFile;
+static LONGLONG					sgStartTime;
+static LONGLONG					sgWindowLength;				// ASYNC_LOG_RATE_WINDOW in counter ticks
+static f64						sgFrequency;
+
+// ---------------------------------------------------------------------------
+
+// Log thread only: formats and writes the records of one ring
+static void AsyncLogDrain(AsyncLogRing *pRing, unsigned long RingIndex)
+{
+	unsigned long tail = pRing->mTail, head = pRing->mHead, droppedFull, droppedRate;
+	char line[ASYNC_LOG_LINE_MAX];
+
+	for (; tail != head; tail++)
+	{
+		const AsyncLogRecord *pRecord = pRing->mpRecords + (tail & (ASYNC_LOG_RING_CAPACITY - 1));
+		int length = sprintf_s(line, ASYNC_LOG_LINE_MAX, "%10.4f [%lu] ", (pRecord->mTime - sgStartTime) / sgFrequency, RingIndex);
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+		// va_list is a plain pointer to the argument memory, the copy stands in for it
+		if (pRecord->mpFormat)
+			vsprintf_s(line + length, ASYNC_LOG_LINE_MAX - length, pRecord->mpFormat, (va_list)pRecord->mArgs);
+		else
+#endif
+			sprintf_s(line + length, ASYNC_LOG_LINE_MAX - length, "%s", pRecord->mArgs);
+
+		fputs(line, sgpFile);
+	}
+
+	pRing->mTail = tail;
+
+	droppedFull = pRing->mDroppedFull;
+	droppedRate = pRing->mDroppedRate;
+
+	if (droppedFull != pRing->mReportedFull || droppedRate != pRing->mReportedRate)
+	{
+		fprintf(sgpFile, "           [%lu] %lu records dropped, ring full; %lu dropped, rate limit\n",
+			RingIndex, droppedFull - pRing->mReportedFull, droppedRate - pRing->mReportedRate);
+		pRing->mReportedFull = droppedFull;
+		pRing->mReportedRate = droppedRate;
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+static DWORD WINAPI AsyncLogThread(LPVOID pParam)
+{
+	long r, ringNum;
+
+	for (;;)
+	{
+		int running = sgRunning;
+
+		WaitForSingleObject(sgWake, ASYNC_LOG_DRAIN_PERIOD);
+
+		ringNum = min(sgRingNum, ASYNC_LOG_RING_MAX);
+		for (r = 0; r < ringNum; r++)
+			AsyncLogDrain(sgRings + r, r);
+
+		fflush(sgpFile);
+
+		// One last drain after the stop request
+		if (!running)
+			return 0;
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void AsyncLogInit(void)
+{
+	LARGE_INTEGER counter, frequency;
+	unsigned long r;
+
+	if (sgThread)
+		return;
+
+	memset(sgRings, 0, sizeof(sgRings));
+	for (r = 0; r < ASYNC_LOG_RING_MAX; r++)
+	{
+		sgRings[r].mpRecords = (AsyncLogRecord *)malloc(ASYNC_LOG_RING_CAPACITY * sizeof(AsyncLogRecord));
+		AE_ASSERT_ALLOC(sgRings[r].mpRecords);
+	}
+	sgRingNum = 0;
+
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	sgFrequency = (f64)frequency.QuadPart;
+	sgStartTime = counter.QuadPart;
+	sgWindowLength = (LONGLONG)(ASYNC_LOG_RATE_WINDOW * sgFrequency);
+
+	sgpFile = fopen(ASYNC_LOG_FILE, "w");
+	if (0 == sgpFile)
+	{
+		AE_WARNING_MESG(0, "Could not open %s, logging is off", ASYNC_LOG_FILE);
+		AsyncLogFree();
+		return;
+	}
+
+	sgRunning = 1;
+	sgWake = CreateEvent(NULL, FALSE, FALSE, NULL);
+	sgThread = sgWake ? CreateThread(NULL, 0, AsyncLogThread, NULL, 0, NULL) : 0;
+
+	if (0 == sgThread)
+	{
+		AE_WARNING_MESG(0, "Could not start the log thread, logging is off");
+		AsyncLogFree();
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void AsyncLogFree(void)
+{
+	unsigned long r;
+
+	sgRunning = 0;
+
+	if (sgThread)
+	{
+		SetEvent(sgWake);
+		WaitForSingleObject(sgThread, INFINITE);
+		CloseHandle(sgThread);
+	}
+
+	if (sgWake)
+		CloseHandle(sgWake);
+	if (sgpFile)
+		fclose(sgpFile);
+
+	for (r = 0; r < ASYNC_LOG_RING_MAX; r++)
+		free(sgRings[r].mpRecords);
+
+	memset(sgRings, 0, sizeof(sgRings));
+	sgThread = 0;
+	sgWake = 0;
+	sgpFile = 0;
+	sgRingNum = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+void AsyncLogWrite(const char *pFormat, ...)
+{
+	AsyncLogRing *pRing;
+	AsyncLogRecord *pRecord;
+	LARGE_INTEGER now;
+	unsigned long head;
+	va_list args;
+
+	if (!sgRunning)
+		return;
+
+	// First record of this thread. Rings are not given back, a thread keeps its ring until AsyncLogFree
+	if (sgThreadRing < 0)
+	{
+		sgThreadRing = InterlockedIncrement(&sgRingNum) - 1;
+
+		if (sgThreadRing >= ASYNC_LOG_RING_MAX)
+		{
+			sgThreadRing = ASYNC_LOG_RING_MAX;
+			AE_WARNING_MESG(0, "More than %d threads are logging", ASYNC_LOG_RING_MAX);
+		}
+	}
+
+	if (sgThreadRing >= ASYNC_LOG_RING_MAX)
+		return;
+
+	pRing = sgRings + sgThreadRing;
+	QueryPerformanceCounter(&now);
+
+	if (now.QuadPart - pRing->mWindowStart >= sgWindowLength)
+	{
+		pRing->mWindowStart = now.QuadPart;
+		pRing->mWindowNum = 0;
+	}
+
+	if (pRing->mWindowNum >= ASYNC_LOG_RATE_MAX)
+	{
+		pRing->mDroppedRate++;
+		return;
+	}
+
+	head = pRing->mHead;
+	if (head - pRing->mTail >= ASYNC_LOG_RING_CAPACITY)
+	{
+		pRing->mDroppedFull++;
+		return;
+	}
+
+	pRing->mWindowNum++;
+
+	pRecord = pRing->mpRecords + (head & (ASYNC_LOG_RING_CAPACITY - 1));
+	pRecord->mTime = now.QuadPart;
+
+	va_start(args, pFormat);
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	// Raw copy of the caller's arguments, formatted later. May read past the last one, never past the stack
+	pRecord->mpFormat = pFormat;
+	memcpy(pRecord->mArgs, args, ASYNC_LOG_ARG_SIZE);
+#else
+	// No portable way to keep a va_list: format now, truncated to the record
+	pRecord->mpFormat = 0;
+	vsnprintf(pRecord->mArgs, ASYNC_LOG_ARG_SIZE, pFormat, args);
+#endif
+	va_end(args);
+
+	// Volatile store, released after the record
+	pRing->mHead = head + 1;
+}
+
+// ---------------------------------------------------------------------------
+
+void AsyncLogBenchmark(void)
+{
+	f64 start, queueTime, dropTime, printTime;
+	unsigned long i;
+
+	// A full window of queued records, then calls turned away by the rate limit
+	Sleep((DWORD)(ASYNC_LOG_RATE_WINDOW * 1000.0) + 1);
+
+	AEGetTime(&start);
+	for (i = 0; i < ASYNC_LOG_RATE_MAX; i++)
+		AsyncLogWrite("benchmark %lu %f\n", i, 0.5 * i);
+	AEGetTime(&queueTime);
+	queueTime -= start;
+
+	AEGetTime(&start);
+	for (i = 0; i < ASYNC_LOG_BENCHMARK_NUM; i++)
+		AsyncLogWrite("benchmark %lu %f\n", i, 0.5 * i);
+	AEGetTime(&dropTime);
+	dropTime -= start;
+
+	AEGetTime(&start);
+	for (i = 0; i < ASYNC_LOG_BENCHMARK_PRINT_NUM; i++)
+		StartupPrintf("benchmark %lu %f\n", i, 0.5 * i);
+	AEGetTime(&printTime);
+	printTime -= start;
+
+	StartupPrintf("AsyncLog: %.1f ns per queued record, %.1f ns per rate limited call, %.1f us per console print\n",
+		queueTime * 1e9 / ASYNC_LOG_RATE_MAX, dropTime * 1e9 / ASYNC_LOG_BENCHMARK_NUM, printTime * 1e6 / ASYNC_LOG_BENCHMARK_PRINT_NUM);
+}
@@ -0,0 +1,238 @@
+/* Start Header -------------------------------------------------------
+Copyright Atlas.c
+Purpose:  Implementation of the sprite atlas
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Atlas.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "Atlas.h"
+#include "Random.h"
+#include <math.h>
+
+#define ATLAS_SIZE_MIN					64
+#define ATLAS_NOISE_OCTAVE_NUM			3
+#define ATLAS_NOISE_CELLS				4					// Lattice cells across the first octave, doubled by each next one
+#define ATLAS_HULL_PANEL_NUM			4					// Panels across each side of a hull image
+
+// ---------------------------------------------------------------------------
+
+// Places the images on shelves in Order. Returns 0 as soon as one does not fit
+static int AtlasShelvesPack(const AtlasImage *pImages, const long *pOrder, long ImageNum, long Width, long Height, AtlasRegion *pRegions)
+{
+	long k, x = 0, y = 0, shelfHeight = 0;
+
+	for (k = 0; k < ImageNum; k++)
+	{
+		const AtlasImage *pImage = pImages + pOrder[k];
+		long cellWidth = pImage->mWidth + 2 * ATLAS_PADDING, cellHeight = pImage->mHeight + 2 * ATLAS_PADDING;
+
+		// Next shelf, as tall as its first image since they come tallest first
+		if (x + cellWidth > Width)
+		{
+			x = 0;
+			y += shelfHeight;
+			shelfHeight = 0;
+		}
+
+		if (cellWidth > Width || y + cellHeight > Height)
+			return 0;
+
+		pRegions[pOrder[k]].mX = x + ATLAS_PADDING;
+		pRegions[pOrder[k]].mY = y + ATLAS_PADDING;
+		pRegions[pOrder[k]].mWidth = pImage->mWidth;
+		pRegions[pOrder[k]].mHeight = pImage->mHeight;
+
+		x += cellWidth;
+		shelfHeight = max(shelfHeight, cellHeight);
+	}
+
+	return 1;
+}
+
+// ---------------------------------------------------------------------------
+
+int AtlasBuild(Atlas *pAtlas, const AtlasImage *pImages, long ImageNum, long MaxSize)
+{
+	long order[ATLAS_REGION_MAX];
+	long i, k, area = 0;
+
+	AE_ASSERT_PARM(ImageNum > 0 && ImageNum <= ATLAS_REGION_MAX);
+
+	memset(pAtlas, 0, sizeof(Atlas));
+
+	// Tallest first, so every shelf wastes little above its shorter images
+	for (i = 0; i < ImageNum; i++)
+	{
+		for (k = i; k > 0 && pImages[order[k - 1]].mHeight < pImages[i].mHeight; k--)
+			order[k] = order[k - 1];
+		order[k] = i;
+
+		area += (pImages[i].mWidth + 2 * ATLAS_PADDING) * (pImages[i].mHeight + 2 * ATLAS_PADDING);
+	}
+
+	// Grow the shorter side from the smallest square holding the area until everything fits
+	pAtlas->mWidth = pAtlas->mHeight = ATLAS_SIZE_MIN;
+	while (pAtlas->mWidth * pAtlas->mHeight < area)
+		pAtlas->mWidth = pAtlas->mHeight = 2 * pAtlas->mWidth;
+
+	while (!AtlasShelvesPack(pImages, order, ImageNum, pAtlas->mWidth, pAtlas->mHeight, pAtlas->mRegions))
+	{
+		if (pAtlas->mWidth <= pAtlas->mHeight)
+			pAtlas->mWidth *= 2;
+		else
+			pAtlas->mHeight *= 2;
+
+		if (pAtlas->mWidth > MaxSize || pAtlas->mHeight > MaxSize)
+		{
+			memset(pAtlas, 0, sizeof(Atlas));
+			return 0;
+		}
+	}
+
+	pAtlas->mpPixels = (unsigned int *)calloc(pAtlas->mWidth * pAtlas->mHeight, sizeof(unsigned int));
+	AE_ASSERT_ALLOC(pAtlas->mpPixels);
+	pAtlas->mRegionNum = ImageNum;
+
+	for (i = 0; i < ImageNum; i++)
+	{
+		const AtlasImage *pImage = pImages + i;
+		AtlasRegion *pRegion = pAtlas->mRegions + i;
+		long x, y;
+
+		// The padding repeats the nearest edge pixel
+		for (y = -ATLAS_PADDING; y < pImage->mHeight + ATLAS_PADDING; y++)
+		{
+			long sourceY = min(max(y, 0), pImage->mHeight - 1);
+			unsigned int *pRow = pAtlas->mpPixels + (pRegion->mY + y) * pAtlas->mWidth + pRegion->mX;
+
+			for (x = -ATLAS_PADDING; x < pImage->mWidth + ATLAS_PADDING; x++)
+				pRow[x] = pImage->mpPixels[sourceY * pImage->mWidth + min(max(x, 0), pImage->mWidth - 1)];
+		}
+
+		pRegion->mU0 = (float)pRegion->mX / (float)pAtlas->mWidth;
+		pRegion->mV0 = (float)pRegion->mY / (float)pAtlas->mHeight;
+		pRegion->mU1 = (float)(pRegion->mX + pRegion->mWidth) / (float)pAtlas->mWidth;
+		pRegion->mV1 = (float)(pRegion->mY + pRegion->mHeight) / (float)pAtlas->mHeight;
+	}
+
+	return 1;
+}
+
+// ---------------------------------------------------------------------------
+
+void AtlasFree(Atlas *pAtlas)
+{
+	free(pAtlas->mpPixels);
+
+	memset(pAtlas, 0, sizeof(Atlas));
+}
+
+// ---------------------------------------------------------------------------
+
+void AtlasRegionMap(const AtlasRegion *pRegion, MeshVertex *pVertices, unsigned long Num)
+{
+	unsigned long i;
+
+	for (i = 0; i < Num; i++)
+	{
+		float s = min(max(pVertices[i].mX + 0.5f, 0.0f), 1.0f);
+		float t = min(max(0.5f - pVertices[i].mY, 0.0f), 1.0f);
+
+		pVertices[i].mU = pRegion->mU0 + s * (pRegion->mU1 - pRegion->mU0);
+		pVertices[i].mV = pRegion->mV0 + t * (pRegion->mV1 - pRegion->mV0);
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+// Smooth value noise in [0, 1] over the unit square, wrapping on both sides so the image tiles
+static float AtlasNoise(const float *pLattices, float s, float t)
+{
+	float sum = 0.0f, amplitude = 0.5f, total = 0.0f;
+	long octave, cells = ATLAS_NOISE_CELLS;
+
+	for (octave = 0; octave < ATLAS_NOISE_OCTAVE_NUM; octave++, cells *= 2, amplitude *= 0.5f)
+	{
+		float x = s * (float)cells, y = t * (float)cells;
+		long x0 = (long)x, y0 = (long)y;
+		float fx = x - (float)x0, fy = y - (float)y0;
+		long x1 = (x0 + 1) % cells, y1 = (y0 + 1) % cells;
+		float top, bottom;
+
+		x0 %= cells;
+		y0 %= cells;
+		fx = fx * fx * (3.0f - 2.0f * fx);
+		fy = fy * fy * (3.0f - 2.0f * fy);
+
+		top = pLattices[y0 * cells + x0] + fx * (pLattices[y0 * cells + x1] - pLattices[y0 * cells + x0]);
+		bottom = pLattices[y1 * cells + x0] + fx * (pLattices[y1 * cells + x1] - pLattices[y1 * cells + x0]);
+		sum += amplitude * (top + fy * (bottom - top));
+		total += amplitude;
+
+		pLattices += cells * cells;
+	}
+
+	return sum / total;
+}
+
+// ---------------------------------------------------------------------------
+
+void AtlasImagePaint(AtlasImage *pImage, long Width, long Height, ATLAS_PAINT Paint, unsigned long Seed)
+{
+	float lattices[(ATLAS_NOISE_CELLS * ATLAS_NOISE_CELLS) * (1 + 4 + 16)];
+	Random random;
+	long x, y;
+
+	pImage->mWidth = Width;
+	pImage->mHeight = Height;
+	pImage->mpPixels = (unsigned int *)malloc(Width * Height * sizeof(unsigned int));
+	AE_ASSERT_ALLOC(pImage->mpPixels);
+
+	RandomInit(&random, Seed, 0);
+	RandomFillFloat(&random, lattices, sizeof(lattices) / sizeof(float));
+
+	for (y = 0; y < Height; y++)
+	{
+		for (x = 0; x < Width; x++)
+		{
+			float s = ((float)x + 0.5f) / (float)Width, t = ((float)y + 0.5f) / (float)Height;
+			float light = 1.0f, alpha = 1.0f, dx, dy;
+			unsigned int level;
+
+			switch (Paint)
+			{
+			case ATLAS_PAINT_ROCK:
+				light = 0.45f + 0.55f * AtlasNoise(lattices, s, t);
+				break;
+
+			case ATLAS_PAINT_HULL:
+				light = 0.8f + 0.2f * AtlasNoise(lattices, s, t);
+				if (x % (Width / ATLAS_HULL_PANEL_NUM) == 0 || y % (Height / ATLAS_HULL_PANEL_NUM) == 0)
+					light *= 0.6f;
+				break;
+
+			default:
+				dx = 2.0f * s - 1.0f;
+				dy = 2.0f * t - 1.0f;
+				alpha = max(1.0f - sqrtf(dx * dx + dy * dy), 0.0f);
+				alpha *= alpha;
+				break;
+			}
+
+			level = (unsigned int)(255.0f * min(light, 1.0f));
+			pImage->mpPixels[y * Width + x] = ((unsigned int)(255.0f * alpha) << 24) | (level << 16) | (level << 8) | level;
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void AtlasImageFree(AtlasImage *pImage)
+{
+	free(pImage->mpPixels);
+
+	memset(pImage, 0, sizeof(AtlasImage));
+}
@@ -0,0 +1,383 @@
+/* Start Header -------------------------------------------------------
+Copyright BarnesHut.c
+Purpose:  Implementation of the Barnes-Hut quadtree gravity solver
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_BarnesHut.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "BarnesHut.h"
+#include "Startup.h"
+#include "WorkerPool.h"
+
+#define BARNES_HUT_DEPTH_MAX		32					// Coincident bodies stop subdividing here and share a leaf
+#define BARNES_HUT_STACK_MAX		(3 * BARNES_HUT_DEPTH_MAX + 4)
+
+// One worker's share of a force pass: the queries falling in one root quadrant
+typedef struct
+{
+	BarnesHut			*mpTree;
+	Vector2D			*mpQueries;
+	Vector2D			*mpAccelerations;
+	long				*mpOrder;
+	long				mNum;
+}BarnesHutJob;
+
+// ---------------------------------------------------------------------------
+
+static long BarnesHutNewNode(BarnesHut *pTree, float CenterX, float CenterY, float HalfSize)
+{
+	BarnesHutNode *pNode;
+
+	if (pTree->mNodeNum == pTree->mNodeCapacity)
+	{
+		pTree->mNodeCapacity *= 2;
+		pTree->mpNodes = (BarnesHutNode *)realloc(pTree->mpNodes, pTree->mNodeCapacity * sizeof(BarnesHutNode));
+		AE_ASSERT_ALLOC(pTree->mpNodes);
+	}
+
+	pNode = pTree->mpNodes + pTree->mNodeNum;
+	pNode->mCenterX = CenterX;
+	pNode->mCenterY = CenterY;
+	pNode->mHalfSize = HalfSize;
+	pNode->mMass = 0.0f;
+	pNode->mMassX = 0.0f;
+	pNode->mMassY = 0.0f;
+	pNode->mChild[0] = pNode->mChild[1] = pNode->mChild[2] = pNode->mChild[3] = -1;
+	pNode->mBody = -1;
+
+	return pTree->mNodeNum++;
+}
+
+// ---------------------------------------------------------------------------
+
+static int BarnesHutQuadrant(BarnesHutNode *pNode, float x, float y)
+{
+	return (x >= pNode->mCenterX ? 1 : 0) | (y >= pNode->mCenterY ? 2 : 0);
+}
+
+// ---------------------------------------------------------------------------
+
+static int BarnesHutIsLeaf(BarnesHutNode *pNode)
+{
+	return pNode->mChild[0] < 0 && pNode->mChild[1] < 0 && pNode->mChild[2] < 0 && pNode->mChild[3] < 0;
+}
+
+// ---------------------------------------------------------------------------
+
+// Returns the child cell of Node in quadrant Q, creating it if needed. May reallocate the arena
+static long BarnesHutChild(BarnesHut *pTree, long Node, int Q)
+{
+	BarnesHutNode *pNode = pTree->mpNodes + Node;
+	float quarter;
+	long child;
+
+	if (pNode->mChild[Q] >= 0)
+		return pNode->mChild[Q];
+
+	quarter = pNode->mHalfSize * 0.5f;
+	child = BarnesHutNewNode(pTree,
+		pNode->mCenterX + ((Q & 1) ? quarter : -quarter),
+		pNode->mCenterY + ((Q & 2) ? quarter : -quarter),
+		quarter);
+
+	pTree->mpNodes[Node].mChild[Q] = child;
+
+	return child;
+}
+
+// ---------------------------------------------------------------------------
+
+static void BarnesHutInsert(BarnesHut *pTree, long Body, Vector2D *pPositions, float *pMasses)
+{
+	float x = pPositions[Body].x, y = pPositions[Body].y, m = pMasses[Body];
+	long node = 0;
+	int depth = 0;
+
+	for (;;)
+	{
+		BarnesHutNode *pNode = pTree->mpNodes + node;
+
+		// Accumulate the mass weighted position on the way down, it is normalized after the build
+		pNode->mMass += m;
+		pNode->mMassX += m * x;
+		pNode->mMassY += m * y;
+
+		if (pNode->mBody < 0 && BarnesHutIsLeaf(pNode))
+		{
+			pNode->mBody = Body;
+			return;
+		}
+
+		if (pNode->mBody >= 0)
+		{
+			long resident = pNode->mBody;
+			long child;
+			BarnesHutNode *pChild;
+
+			if (depth >= BARNES_HUT_DEPTH_MAX)
+				return;
+
+			// Push the resident body one level down before going on
+			pNode->mBody = -1;
+			child = BarnesHutChild(pTree, node, BarnesHutQuadrant(pNode, pPositions[resident].x, pPositions[resident].y));
+
+			pChild = pTree->mpNodes + child;
+			pChild->mBody = resident;
+			pChild->mMass = pMasses[resident];
+			pChild->mMassX = pMasses[resident] * pPositions[resident].x;
+			pChild->mMassY = pMasses[resident] * pPositions[resident].y;
+		}
+
+		node = BarnesHutChild(pTree, node, BarnesHutQuadrant(pTree->mpNodes + node, x, y));
+		++depth;
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+static void BarnesHutAcceleration(BarnesHut *pTree, float x, float y, Vector2D *pResult)
+{
+	long stack[BARNES_HUT_STACK_MAX];
+	int top = 0;
+	float ax = 0.0f, ay = 0.0f;
+	float theta2 = pTree->mTheta * pTree->mTheta;
+	float eps2 = pTree->mSoftening * pTree->mSoftening;
+
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		BarnesHutNode *pNode = pTree->mpNodes + stack[--top];
+		float dx, dy, d2, size;
+
+		if (pNode->mMass <= 0.0f)
+			continue;
+
+		dx = pNode->mMassX - x;
+		dy = pNode->mMassY - y;
+		d2 = dx * dx + dy * dy;
+		size = 2.0f * pNode->mHalfSize;
+
+		if (BarnesHutIsLeaf(pNode) || size * size < theta2 * d2)
+		{
+			float invDist = 1.0f / sqrtf(d2 + eps2);
+			float f = pTree->mGravity * pNode->mMass * invDist * invDist * invDist;
+
+			ax += dx * f;
+			ay += dy * f;
+		}
+		else
+		{
+			int q;
+
+			// Always push in the same order so the summation order never changes
+			for (q = 3; q >= 0; q--)
+				if (pNode->mChild[q] >= 0)
+					stack[top++] = pNode->mChild[q];
+		}
+	}
+
+	pResult->x = ax;
+	pResult->y = ay;
+}
+
+// ---------------------------------------------------------------------------
+
+static void BarnesHutJobRun(void *pParam)
+{
+	BarnesHutJob *pJob = (BarnesHutJob *)pParam;
+	long i;
+
+	for (i = 0; i < pJob->mNum; i++)
+	{
+		long q = pJob->mpOrder[i];
+		BarnesHutAcceleration(pJob->mpTree, pJob->mpQueries[q].x, pJob->mpQueries[q].y, pJob->mpAccelerations + q);
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void BarnesHutInit(BarnesHut *pTree, long BodyCapacity, float Theta, float Gravity, float Softening)
+{
+	memset(pTree, 0, sizeof(BarnesHut));
+
+	pTree->mNodeCapacity = 2 * BodyCapacity + 1;
+	pTree->mpNodes = (BarnesHutNode *)malloc(pTree->mNodeCapacity * sizeof(BarnesHutNode));
+	AE_ASSERT_ALLOC(pTree->mpNodes);
+
+	pTree->mTheta = Theta;
+	pTree->mGravity = Gravity;
+	pTree->mSoftening = Softening;
+	pTree->mThreaded = 1;
+
+	WorkerPoolStart();
+}
+
+// ---------------------------------------------------------------------------
+
+void BarnesHutFree(BarnesHut *pTree)
+{
+	// A tree that was never initialized did not start the pool
+	if (pTree->mpNodes)
+		WorkerPoolStop();
+
+	free(pTree->mpNodes);
+	free(pTree->mpQueryOrder);
+
+	memset(pTree, 0, sizeof(BarnesHut));
+}
+
+// ---------------------------------------------------------------------------
+
+void BarnesHutBuild(BarnesHut *pTree, Vector2D *pPositions, float *pMasses, long BodyNum)
+{
+	float minX = 0.0f, minY = 0.0f, maxX = 0.0f, maxY = 0.0f, half;
+	long i;
+
+	pTree->mNodeNum = 0;
+
+	if (BodyNum > 0)
+	{
+		minX = maxX = pPositions[0].x;
+		minY = maxY = pPositions[0].y;
+	}
+
+	for (i = 1; i < BodyNum; i++)
+	{
+		minX = min(minX, pPositions[i].x);
+		maxX = max(maxX, pPositions[i].x);
+		minY = min(minY, pPositions[i].y);
+		maxY = max(maxY, pPositions[i].y);
+	}
+
+	half = 0.5f * max(maxX - minX, maxY - minY) + 1.0f;
+	BarnesHutNewNode(pTree, 0.5f * (minX + maxX), 0.5f * (minY + maxY), half);
+
+	for (i = 0; i < BodyNum; i++)
+		BarnesHutInsert(pTree, i, pPositions, pMasses);
+
+	for (i = 0; i < pTree->mNodeNum; i++)
+	{
+		BarnesHutNode *pNode = pTree->mpNodes + i;
+
+		if (pNode->mMass > 0.0f)
+		{
+			pNode->mMassX /= pNode->mMass;
+			pNode->mMassY /= pNode->mMass;
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void BarnesHutComputeAccelerations(BarnesHut *pTree, Vector2D *pQueries, long QueryNum, Vector2D *pAccelerations)
+{
+	BarnesHutJob jobs[BARNES_HUT_THREAD_NUM];
+	long bucketStart[BARNES_HUT_THREAD_NUM + 1];
+	long bucketFill[BARNES_HUT_THREAD_NUM];
+	BarnesHutNode *pRoot = pTree->mpNodes;
+	long i;
+	int q;
+
+	if (pTree->mNodeNum == 0)
+	{
+		memset(pAccelerations, 0, QueryNum * sizeof(Vector2D));
+		return;
+	}
+
+	if (!pTree->mThreaded || QueryNum < BARNES_HUT_PARALLEL_MIN)
+	{
+		for (i = 0; i < QueryNum; i++)
+			BarnesHutAcceleration(pTree, pQueries[i].x, pQueries[i].y, pAccelerations + i);
+		return;
+	}
+
+	if (pTree->mQueryCapacity < QueryNum)
+	{
+		free(pTree->mpQueryOrder);
+		pTree->mpQueryOrder = (long *)malloc(QueryNum * sizeof(long));
+		pTree->mQueryCapacity = QueryNum;
+		AE_ASSERT_ALLOC(pTree->mpQueryOrder);
+	}
+
+	// Counting sort of the queries by root quadrant: each worker walks mostly one subtree
+	memset(bucketFill, 0, sizeof(bucketFill));
+	for (i = 0; i < QueryNum; i++)
+		++bucketFill[BarnesHutQuadrant(pRoot, pQueries[i].x, pQueries[i].y)];
+
+	bucketStart[0] = 0;
+	for (q = 0; q < BARNES_HUT_THREAD_NUM; q++)
+	{
+		bucketStart[q + 1] = bucketStart[q] + bucketFill[q];
+		bucketFill[q] = bucketStart[q];
+	}
+
+	for (i = 0; i < QueryNum; i++)
+		pTree->mpQueryOrder[bucketFill[BarnesHutQuadrant(pRoot, pQueries[i].x, pQueries[i].y)]++] = i;
+
+	for (q = 0; q < BARNES_HUT_THREAD_NUM; q++)
+	{
+		jobs[q].mpTree = pTree;
+		jobs[q].mpQueries = pQueries;
+		jobs[q].mpAccelerations = pAccelerations;
+		jobs[q].mpOrder = pTree->mpQueryOrder + bucketStart[q];
+		jobs[q].mNum = bucketStart[q + 1] - bucketStart[q];
+	}
+
+	// Quadrants 1 to 3 go to the pool's workers, quadrant 0 runs here
+	WorkerPoolRun(BarnesHutJobRun, jobs, sizeof(BarnesHutJob), BARNES_HUT_THREAD_NUM);
+}
+
+// ---------------------------------------------------------------------------
+
+void BarnesHutBenchmark(void)
+{
+	static const long sBodyNums[] = { 10000, 50000, 100000 };
+	unsigned long n;
+
+	for (n = 0; n < sizeof(sBodyNums) / sizeof(sBodyNums[0]); n++)
+	{
+		long bodyNum = sBodyNums[n], i;
+		Vector2D *pPositions = (Vector2D *)malloc(bodyNum * sizeof(Vector2D));
+		Vector2D *pSerial = (Vector2D *)malloc(bodyNum * sizeof(Vector2D));
+		Vector2D *pThreaded = (Vector2D *)malloc(bodyNum * sizeof(Vector2D));
+		float *pMasses = (float *)malloc(bodyNum * sizeof(float));
+		BarnesHut tree;
+		f64 t0, t1, t2, t3;
+
+		AE_ASSERT_ALLOC(pPositions && pSerial && pThreaded && pMasses);
+
+		for (i = 0; i < bodyNum; i++)
+		{
+			Vector2DSet(pPositions + i, (AERandFloat() - 0.5f) * 10000.0f, (AERandFloat() - 0.5f) * 10000.0f);
+			pMasses[i] = 1.0f + AERandFloat() * 100.0f;
+		}
+
+		BarnesHutInit(&tree, bodyNum, 0.5f, 1.0f, 1.0f);
+
+		AEGetTime(&t0);
+		BarnesHutBuild(&tree, pPositions, pMasses, bodyNum);
+		AEGetTime(&t1);
+
+		tree.mThreaded = 0;
+		BarnesHutComputeAccelerations(&tree, pPositions, bodyNum, pSerial);
+		AEGetTime(&t2);
+
+		tree.mThreaded = 1;
+		BarnesHutComputeAccelerations(&tree, pPositions, bodyNum, pThreaded);
+		AEGetTime(&t3);
+
+		StartupPrintf("Barnes-Hut %6ld bodies: build %.2f ms, forces %.2f ms (1 thread) / %.2f ms (%d threads), %s\n",
+			bodyNum, (t1 - t0) * 1000.0, (t2 - t1) * 1000.0, (t3 - t2) * 1000.0, BARNES_HUT_THREAD_NUM,
+			memcmp(pSerial, pThreaded, bodyNum * sizeof(Vector2D)) == 0 ? "deterministic" : "NOT deterministic");
+
+		BarnesHutFree(&tree);
+		free(pPositions);
+		free(pSerial);
+		free(pThreaded);
+		free(pMasses);
+	}
+}
@@ -0,0 +1,191 @@
+/* Start Header -------------------------------------------------------
+Copyright Behavior.c
+Purpose:  Implementation of the behavior scheduler
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Behavior.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "AEEngine.h"
+#include "Behavior.h"
+#include "Startup.h"
+
+#define BEHAVIOR_BENCHMARK_FRAMES	60
+
+// ---------------------------------------------------------------------------
+
+void BehaviorSchedulerInit(BehaviorScheduler *pScheduler, unsigned long Capacity)
+{
+	memset(pScheduler, 0, sizeof(BehaviorScheduler));
+
+	pScheduler->mpBehaviors = (Behavior *)malloc(Capacity * sizeof(Behavior));
+	pScheduler->mpFree = (unsigned long *)malloc(Capacity * sizeof(unsigned long));
+	pScheduler->mpActive = (unsigned long *)malloc(Capacity * sizeof(unsigned long));
+	AE_ASSERT_ALLOC(pScheduler->mpBehaviors);
+	AE_ASSERT_ALLOC(pScheduler->mpFree);
+	AE_ASSERT_ALLOC(pScheduler->mpActive);
+
+	pScheduler->mCapacity = Capacity;
+	BehaviorSchedulerClear(pScheduler);
+}
+
+// ---------------------------------------------------------------------------
+
+void BehaviorSchedulerFree(BehaviorScheduler *pScheduler)
+{
+	free(pScheduler->mpBehaviors);
+	free(pScheduler->mpFree);
+	free(pScheduler->mpActive);
+
+	memset(pScheduler, 0, sizeof(BehaviorScheduler));
+}
+
+// ---------------------------------------------------------------------------
+
+void BehaviorSchedulerClear(BehaviorScheduler *pScheduler)
+{
+	// Constant time: the frames are handed out from the start again, nothing is walked
+	pScheduler->mFreeNum = 0;
+	pScheduler->mNextNew = 0;
+	pScheduler->mActiveNum = 0;
+	pScheduler->mCursor = 0;
+	pScheduler->mSpilled = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+Behavior* BehaviorStart(BehaviorScheduler *pScheduler, BehaviorFunc Func, void *pOwner)
+{
+	unsigned long index;
+	Behavior *pBehavior;
+
+	if (pScheduler->mFreeNum > 0)
+		index = pScheduler->mpFree[--pScheduler->mFreeNum];
+	else if (pScheduler->mNextNew < pScheduler->mCapacity)
+		index = pScheduler->mNextNew++;
+	else
+		return 0;
+	pBehavior = pScheduler->mpBehaviors + index;
+
+	memset(pBehavior, 0, sizeof(Behavior));
+	pBehavior->mpFunc = Func;
+	pBehavior->mpOwner = pOwner;
+
+	// Marked as run this frame, so a behavior started by another one waits for the next frame
+	pBehavior->mFrame = pScheduler->mFrame;
+	pBehavior->mLastTime = pScheduler->mTime;
+
+	pScheduler->mpActive[pScheduler->mActiveNum++] = index;
+
+	return pBehavior;
+}
+
+// ---------------------------------------------------------------------------
+
+void BehaviorStop(Behavior *pBehavior)
+{
+	pBehavior->mpFunc = 0;
+	pBehavior->mpOwner = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+void BehaviorSchedulerRun(BehaviorScheduler *pScheduler, float FrameTime, f64 Budget)
+{
+	unsigned long visitNum = pScheduler->mActiveNum, visited, resumed = 0;
+	f64 start, now;
+
+	pScheduler->mTime += FrameTime;
+	pScheduler->mFrame++;
+	pScheduler->mSpilled = 0;
+
+	AEGetTime(&start);
+
+	// Round robin from where the last run stopped, so spilled behaviors go first
+	for (visited = 0; visited < visitNum && pScheduler->mActiveNum > 0; visited++)
+	{
+		unsigned long index;
+		Behavior *pBehavior;
+
+		if (pScheduler->mCursor >= pScheduler->mActiveNum)
+			pScheduler->mCursor = 0;
+
+		index = pScheduler->mpActive[pScheduler->mCursor];
+		pBehavior = pScheduler->mpBehaviors + index;
+
+		// Moved down by a removal after it already ran
+		if (pBehavior->mFrame == pScheduler->mFrame)
+		{
+			pScheduler->mCursor++;
+			continue;
+		}
+
+		pBehavior->mFrame = pScheduler->mFrame;
+		pBehavior->mDt = (float)(pScheduler->mTime - pBehavior->mLastTime);
+		pBehavior->mLastTime = pScheduler->mTime;
+
+		if (0 == pBehavior->mpFunc || pBehavior->mpFunc(pBehavior) == BEHAVIOR_DONE)
+		{
+			pBehavior->mpFunc = 0;
+			pScheduler->mpFree[pScheduler->mFreeNum++] = index;
+			pScheduler->mpActive[pScheduler->mCursor] = pScheduler->mpActive[--pScheduler->mActiveNum];
+		}
+		else
+			pScheduler->mCursor++;
+
+		if (++resumed % BEHAVIOR_BUDGET_CHECK == 0)
+		{
+			AEGetTime(&now);
+			if (now - start > Budget)
+			{
+				pScheduler->mSpilled = visitNum - visited - 1;
+				break;
+			}
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+// Counts frames, sleeps a little, then finishes
+static int BehaviorBenchmarkFunc(Behavior *pBehavior)
+{
+	BEHAVIOR_BEGIN(pBehavior);
+
+	for (pBehavior->mState.mFloat[0] = 0.0f; pBehavior->mState.mFloat[0] < 10.0f; pBehavior->mState.mFloat[0] += 1.0f)
+		BEHAVIOR_NEXT_FRAME(pBehavior);
+
+	BEHAVIOR_WAIT_SECONDS(pBehavior, 0.5f);
+	BEHAVIOR_AWAIT(pBehavior, pBehavior->mDt >= 0.0f);
+
+	BEHAVIOR_END(pBehavior);
+}
+
+// ---------------------------------------------------------------------------
+
+void BehaviorBenchmark(unsigned long Num)
+{
+	BehaviorScheduler scheduler;
+	f64 start, runTime, bytes;
+	unsigned long i;
+
+	BehaviorSchedulerInit(&scheduler, Num);
+	bytes = (f64)Num * (sizeof(Behavior) + 2 * sizeof(unsigned long));
+
+	for (i = 0; i < Num; i++)
+		BehaviorStart(&scheduler, BehaviorBenchmarkFunc, 0);
+
+	// Unlimited budget, every behavior runs every frame
+	AEGetTime(&start);
+	for (i = 0; i < BEHAVIOR_BENCHMARK_FRAMES; i++)
+		BehaviorSchedulerRun(&scheduler, 1.0f / 60.0f, 1.0);
+	AEGetTime(&runTime);
+	runTime -= start;
+
+	StartupPrintf("Behavior: %lu behaviors in %.2f MB, %.3f ms per frame, %lu left running\n",
+		Num, bytes / (1024.0 * 1024.0), runTime * 1000.0 / BEHAVIOR_BENCHMARK_FRAMES, scheduler.mActiveNum);
+
+	BehaviorSchedulerFree(&scheduler);
+}
@@ -0,0 +1,137 @@
+/* Start Header -------------------------------------------------------
+Copyright Bounds.c
+Purpose:  Implementation of the per-frame bounds cache
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Bounds.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "AEEngine.h"
+#include "Bounds.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#define BOUNDS_USE_SSE	1
+#include <xmmintrin.h>
+#else
+#define BOUNDS_USE_SSE	0
+#endif
+
+#define BOUNDS_ARRAY_NUM	16
+
+// ---------------------------------------------------------------------------
+
+static void BoundsComputeScalar(BoundsCache *p, long i)
+{
+	float sx = p->mpScaleX[i], sy = p->mpScaleY[i];
+	float c = p->mpCos[i], s = p->mpSin[i];
+	float lx = p->mpLocalCenterX[i] * sx, ly = p->mpLocalCenterY[i] * sy;
+	float hx = p->mpLocalHalfX[i] * fabsf(sx), hy = p->mpLocalHalfY[i] * fabsf(sy);
+
+	// Center of the rotated box, and half extents of its axis aligned hull
+	float cx = p->mpPosX[i] + c * lx - s * ly;
+	float cy = p->mpPosY[i] + s * lx + c * ly;
+	float ex = fabsf(c) * hx + fabsf(s) * hy;
+	float ey = fabsf(s) * hx + fabsf(c) * hy;
+
+	p->mpMinX[i] = cx - ex;
+	p->mpMaxX[i] = cx + ex;
+	p->mpMinY[i] = cy - ey;
+	p->mpMaxY[i] = cy + ey;
+	p->mpRadius[i] = p->mpLocalRadius[i] * (fabsf(sx) > fabsf(sy) ? fabsf(sx) : fabsf(sy));
+}
+
+// ---------------------------------------------------------------------------
+
+void BoundsCacheInit(BoundsCache *pCache, long Capacity)
+{
+	float *pBlock;
+	long n = (Capacity + 3) & ~3;
+
+	pBlock = (float *)calloc(BOUNDS_ARRAY_NUM * n, sizeof(float));
+	AE_ASSERT_ALLOC(pBlock);
+
+	pCache->mCapacity = n;
+
+	pCache->mpPosX = pBlock;				pBlock += n;
+	pCache->mpPosY = pBlock;				pBlock += n;
+	pCache->mpCos = pBlock;					pBlock += n;
+	pCache->mpSin = pBlock;					pBlock += n;
+	pCache->mpScaleX = pBlock;				pBlock += n;
+	pCache->mpScaleY = pBlock;				pBlock += n;
+	pCache->mpLocalCenterX = pBlock;		pBlock += n;
+	pCache->mpLocalCenterY = pBlock;		pBlock += n;
+	pCache->mpLocalHalfX = pBlock;			pBlock += n;
+	pCache->mpLocalHalfY = pBlock;			pBlock += n;
+	pCache->mpLocalRadius = pBlock;			pBlock += n;
+	pCache->mpMinX = pBlock;				pBlock += n;
+	pCache->mpMinY = pBlock;				pBlock += n;
+	pCache->mpMaxX = pBlock;				pBlock += n;
+	pCache->mpMaxY = pBlock;				pBlock += n;
+	pCache->mpRadius = pBlock;
+}
+
+// ---------------------------------------------------------------------------
+
+void BoundsCacheFree(BoundsCache *pCache)
+{
+	// Every array lives in the block starting at mpPosX
+	free(pCache->mpPosX);
+	memset(pCache, 0, sizeof(BoundsCache));
+}
+
+// ---------------------------------------------------------------------------
+
+void BoundsCacheCompute(BoundsCache *p, long Start, long Count)
+{
+	long i = Start, end = Start + Count;
+
+#if BOUNDS_USE_SSE
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 sx = _mm_loadu_ps(p->mpScaleX + i);
+		__m128 sy = _mm_loadu_ps(p->mpScaleY + i);
+		__m128 c = _mm_loadu_ps(p->mpCos + i);
+		__m128 s = _mm_loadu_ps(p->mpSin + i);
+		__m128 asx = _mm_andnot_ps(signMask, sx);
+		__m128 asy = _mm_andnot_ps(signMask, sy);
+		__m128 ac = _mm_andnot_ps(signMask, c);
+		__m128 as = _mm_andnot_ps(signMask, s);
+
+		__m128 lx = _mm_mul_ps(_mm_loadu_ps(p->mpLocalCenterX + i), sx);
+		__m128 ly = _mm_mul_ps(_mm_loadu_ps(p->mpLocalCenterY + i), sy);
+		__m128 hx = _mm_mul_ps(_mm_loadu_ps(p->mpLocalHalfX + i), asx);
+		__m128 hy = _mm_mul_ps(_mm_loadu_ps(p->mpLocalHalfY + i), asy);
+
+		__m128 cx = _mm_add_ps(_mm_loadu_ps(p->mpPosX + i), _mm_sub_ps(_mm_mul_ps(c, lx), _mm_mul_ps(s, ly)));
+		__m128 cy = _mm_add_ps(_mm_loadu_ps(p->mpPosY + i), _mm_add_ps(_mm_mul_ps(s, lx), _mm_mul_ps(c, ly)));
+		__m128 ex = _mm_add_ps(_mm_mul_ps(ac, hx), _mm_mul_ps(as, hy));
+		__m128 ey = _mm_add_ps(_mm_mul_ps(as, hx), _mm_mul_ps(ac, hy));
+
+		_mm_storeu_ps(p->mpMinX + i, _mm_sub_ps(cx, ex));
+		_mm_storeu_ps(p->mpMaxX + i, _mm_add_ps(cx, ex));
+		_mm_storeu_ps(p->mpMinY + i, _mm_sub_ps(cy, ey));
+		_mm_storeu_ps(p->mpMaxY + i, _mm_add_ps(cy, ey));
+		_mm_storeu_ps(p->mpRadius + i, _mm_mul_ps(_mm_loadu_ps(p->mpLocalRadius + i), _mm_max_ps(asx, asy)));
+	}
+#endif
+
+	for (; i < end; i++)
+		BoundsComputeScalar(p, i);
+}
+
+// ---------------------------------------------------------------------------
+
+int BoundsCacheOverlap(BoundsCache *p, long A, long B)
+{
+	if (p->mpMaxX[A] < p->mpMinX[B] || p->mpMaxX[B] < p->mpMinX[A] || p->mpMaxY[A] < p->mpMinY[B] || p->mpMaxY[B] < p->mpMinY[A])
+		return 0;
+
+	return 1;
+}
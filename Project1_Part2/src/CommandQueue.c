@@ -0,0 +1,153 @@
+/* Start Header -------------------------------------------------------
+Copyright CommandQueue.c
+Purpose:  Implementation of the lock-free spawn/despawn command queue
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_CommandQueue.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "CommandQueue.h"
+
+// ---------------------------------------------------------------------------
+
+/*
+Claims the next command slot. Producers only ever race on mWriteIndex, so a single
+interlocked increment is enough; a slot past the capacity means the queue is full.
+*/
+static Command* CommandQueueClaim(CommandQueue *pQueue)
+{
+	long index = InterlockedIncrement(&pQueue->mWriteIndex) - 1;
+
+	if (index >= pQueue->mCapacity)
+	{
+		InterlockedIncrement(&pQueue->mDropped);
+		return 0;
+	}
+
+	return pQueue->mpCommands + index;
+}
+
+// ---------------------------------------------------------------------------
+
+void CommandQueueInit(CommandQueue *pQueue, long Capacity, long HandleCapacity)
+{
+	pQueue->mpCommands = (Command *)calloc(Capacity, sizeof(Command));
+	pQueue->mCapacity = Capacity;
+	pQueue->mWriteIndex = 0;
+	pQueue->mDropped = 0;
+
+	pQueue->mpFreeHandles = (unsigned long *)calloc(HandleCapacity, sizeof(unsigned long));
+	pQueue->mFreeHandleNum = 0;
+	pQueue->mFreeHandleCapacity = HandleCapacity;
+	pQueue->mReserveIndex = 0;
+
+	AE_ASSERT_ALLOC(pQueue->mpCommands);
+	AE_ASSERT_ALLOC(pQueue->mpFreeHandles);
+}
+
+// ---------------------------------------------------------------------------
+
+void CommandQueueFree(CommandQueue *pQueue)
+{
+	free(pQueue->mpCommands);
+	free(pQueue->mpFreeHandles);
+
+	memset(pQueue, 0, sizeof(CommandQueue));
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned long CommandQueueReserveHandle(CommandQueue *pQueue)
+{
+	long index = InterlockedIncrement(&pQueue->mReserveIndex) - 1;
+
+	if (index >= pQueue->mFreeHandleNum)
+		return COMMAND_HANDLE_INVALID;
+
+	return pQueue->mpFreeHandles[index];
+}
+
+// ---------------------------------------------------------------------------
+
+int CommandQueuePushSpawn(CommandQueue *pQueue, unsigned long Handle, unsigned long ObjectType, Vector2D *pPosition, Vector2D *pVelocity, float Angle, float Scale)
+{
+	Command *pCommand;
+
+	if (Handle == COMMAND_HANDLE_INVALID)
+		return 0;
+
+	pCommand = CommandQueueClaim(pQueue);
+	if (0 == pCommand)
+		return 0;
+
+	pCommand->mType = COMMAND_SPAWN;
+	pCommand->mHandle = Handle;
+	pCommand->mObjectType = ObjectType;
+	if (pPosition)
+		pCommand->mPosition = *pPosition;
+	else
+		Vector2DZero(&pCommand->mPosition);
+	if (pVelocity)
+		pCommand->mVelocity = *pVelocity;
+	else
+		Vector2DZero(&pCommand->mVelocity);
+	pCommand->mAngle = Angle;
+	pCommand->mScale = Scale;
+
+	// Publish last, the consumer never reads a command before this flag is set
+	InterlockedExchange(&pCommand->mReady, 1);
+
+	return 1;
+}
+
+// ---------------------------------------------------------------------------
+
+int CommandQueuePushDespawn(CommandQueue *pQueue, unsigned long Handle, unsigned long Generation)
+{
+	Command *pCommand = CommandQueueClaim(pQueue);
+	if (0 == pCommand)
+		return 0;
+
+	pCommand->mType = COMMAND_DESPAWN;
+	pCommand->mHandle = Handle;
+	pCommand->mGeneration = Generation;
+
+	InterlockedExchange(&pCommand->mReady, 1);
+
+	return 1;
+}
+
+// ---------------------------------------------------------------------------
+
+long CommandQueuePendingNum(CommandQueue *pQueue)
+{
+	long num = pQueue->mWriteIndex;
+
+	if (num > pQueue->mCapacity)
+		num = pQueue->mCapacity;
+
+	// At the sync point every claimed command must have been published
+	AE_ASSERT(num == 0 || pQueue->mpCommands[num - 1].mReady);
+
+	return num;
+}
+
+// ---------------------------------------------------------------------------
+
+void CommandQueueReset(CommandQueue *pQueue, unsigned long *pFreeHandles, long FreeHandleNum)
+{
+	long num = CommandQueuePendingNum(pQueue);
+	long i;
+
+	for (i = 0; i < num; i++)
+		pQueue->mpCommands[i].mReady = 0;
+
+	AE_ASSERT_PARM(FreeHandleNum >= 0 && FreeHandleNum <= pQueue->mFreeHandleCapacity);
+	memcpy(pQueue->mpFreeHandles, pFreeHandles, FreeHandleNum * sizeof(unsigned long));
+	pQueue->mFreeHandleNum = FreeHandleNum;
+
+	pQueue->mWriteIndex = 0;
+	pQueue->mReserveIndex = 0;
+}
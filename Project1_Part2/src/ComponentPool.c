@@ -0,0 +1,67 @@
+/* Start Header -------------------------------------------------------
+Copyright ComponentPool.c
+Purpose:  Implementation of the component pools
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_ComponentPool.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "ComponentPool.h"
+
+// ---------------------------------------------------------------------------
+
+void ComponentPoolInit(ComponentPool *pPool, unsigned long Capacity)
+{
+	pPool->mpFree = (unsigned long *)malloc(Capacity * sizeof(unsigned long));
+	AE_ASSERT_ALLOC(pPool->mpFree);
+
+	pPool->mCapacity = Capacity;
+	ComponentPoolClear(pPool);
+}
+
+// ---------------------------------------------------------------------------
+
+void ComponentPoolFree(ComponentPool *pPool)
+{
+	free(pPool->mpFree);
+	memset(pPool, 0, sizeof(ComponentPool));
+}
+
+// ---------------------------------------------------------------------------
+
+void ComponentPoolClear(ComponentPool *pPool)
+{
+	pPool->mFreeNum = 0;
+	pPool->mNextNew = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned long ComponentPoolAlloc(ComponentPool *pPool)
+{
+	if (pPool->mFreeNum > 0)
+		return pPool->mpFree[--pPool->mFreeNum];
+
+	if (pPool->mNextNew < pPool->mCapacity)
+		return pPool->mNextNew++;
+
+	return COMPONENT_POOL_NONE;
+}
+
+// ---------------------------------------------------------------------------
+
+void ComponentPoolRelease(ComponentPool *pPool, unsigned long Index)
+{
+	AE_ASSERT_PARM(Index < pPool->mNextNew && pPool->mFreeNum < pPool->mNextNew);
+
+	pPool->mpFree[pPool->mFreeNum++] = Index;
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned long ComponentPoolUsedNum(const ComponentPool *pPool)
+{
+	return pPool->mNextNew - pPool->mFreeNum;
+}
@@ -0,0 +1,245 @@
+/* Start Header -------------------------------------------------------
+Copyright DrawQueue.c
+Purpose:  Implementation of the sorted draw queue
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_DrawQueue.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "DrawQueue.h"
+#include "Startup.h"
+#include "Random.h"
+
+#define DRAW_KEY_BYTE_NUM				8
+
+#define DRAW_BENCHMARK_NUM				100000
+#define DRAW_BENCHMARK_FRAME_NUM		30
+#define DRAW_BENCHMARK_LAYER_NUM		4
+#define DRAW_BENCHMARK_DEPTH_NUM		4					// Depth bands per layer
+#define DRAW_BENCHMARK_MESH_NUM			32
+
+// ---------------------------------------------------------------------------
+
+void DrawQueueInit(DrawQueue *pQueue, unsigned long Capacity)
+{
+	memset(pQueue, 0, sizeof(DrawQueue));
+	pQueue->mCapacity = Capacity;
+
+	pQueue->mpKeys = (DrawKey *)malloc(Capacity * sizeof(DrawKey));
+	pQueue->mpScratchKeys = (DrawKey *)malloc(Capacity * sizeof(DrawKey));
+	pQueue->mpItems = (unsigned long *)malloc(Capacity * sizeof(unsigned long));
+	pQueue->mpScratchItems = (unsigned long *)malloc(Capacity * sizeof(unsigned long));
+	AE_ASSERT_ALLOC(pQueue->mpKeys && pQueue->mpScratchKeys && pQueue->mpItems && pQueue->mpScratchItems);
+}
+
+// ---------------------------------------------------------------------------
+
+void DrawQueueFree(DrawQueue *pQueue)
+{
+	free(pQueue->mpKeys);
+	free(pQueue->mpScratchKeys);
+	free(pQueue->mpItems);
+	free(pQueue->mpScratchItems);
+
+	memset(pQueue, 0, sizeof(DrawQueue));
+}
+
+// ---------------------------------------------------------------------------
+
+void DrawQueueClear(DrawQueue *pQueue)
+{
+	pQueue->mNum = 0;
+	memset(&pQueue->mStats, 0, sizeof(DrawQueueStats));
+}
+
+// ---------------------------------------------------------------------------
+
+void DrawQueuePush(DrawQueue *pQueue, DrawKey Key, unsigned long Item)
+{
+	if (pQueue->mNum == pQueue->mCapacity)
+		return;
+
+	pQueue->mpKeys[pQueue->mNum] = Key;
+	pQueue->mpItems[pQueue->mNum] = Item;
+	pQueue->mNum++;
+}
+
+// ---------------------------------------------------------------------------
+
+void DrawQueueSort(DrawQueue *pQueue)
+{
+	static unsigned long counts[DRAW_KEY_BYTE_NUM][256];
+	unsigned long k, num = pQueue->mNum;
+	int b, d;
+	f64 start, end;
+
+	AEGetTime(&start);
+	pQueue->mStats.mItemNum = num;
+	pQueue->mStats.mPassNum = 0;
+
+	// Every byte's histogram in one read of the keys
+	memset(counts, 0, sizeof(counts));
+	for (k = 0; k < num; k++)
+	{
+		DrawKey key = pQueue->mpKeys[k];
+
+		for (b = 0; b < DRAW_KEY_BYTE_NUM; b++)
+			counts[b][(key >> (8 * b)) & 0xFF]++;
+	}
+
+	for (b = 0; b < DRAW_KEY_BYTE_NUM && num > 1; b++)
+	{
+		unsigned long *pCount = counts[b];
+		unsigned long sum = 0;
+		DrawKey *pSwapKeys;
+		unsigned long *pSwapItems;
+
+		// Unused fields and narrow ones leave most bytes equal in every key, their pass would not move anything
+		if (pCount[(pQueue->mpKeys[0] >> (8 * b)) & 0xFF] == num)
+			continue;
+
+		for (d = 0; d < 256; d++)
+		{
+			unsigned long c = pCount[d];
+
+			pCount[d] = sum;
+			sum += c;
+		}
+
+		for (k = 0; k < num; k++)
+		{
+			DrawKey key = pQueue->mpKeys[k];
+			unsigned long dst = pCount[(key >> (8 * b)) & 0xFF]++;
+
+			pQueue->mpScratchKeys[dst] = key;
+			pQueue->mpScratchItems[dst] = pQueue->mpItems[k];
+		}
+
+		pSwapKeys = pQueue->mpKeys;
+		pQueue->mpKeys = pQueue->mpScratchKeys;
+		pQueue->mpScratchKeys = pSwapKeys;
+		pSwapItems = pQueue->mpItems;
+		pQueue->mpItems = pQueue->mpScratchItems;
+		pQueue->mpScratchItems = pSwapItems;
+
+		pQueue->mStats.mPassNum++;
+	}
+
+	AEGetTime(&end);
+	pQueue->mStats.mSortTime = end - start;
+}
+
+// ---------------------------------------------------------------------------
+
+void DrawQueueSubmit(DrawQueue *pQueue, DrawQueueFilter pFilter, DrawQueueFunc pDraw, void *pContext)
+{
+	unsigned long k;
+	unsigned int blend = 0;
+	unsigned long mesh = 0;
+
+	pQueue->mStats.mItemNum = 0;
+	pQueue->mStats.mBlendChangeNum = 0;
+	pQueue->mStats.mMeshChangeNum = 0;
+
+	for (k = 0; k < pQueue->mNum; k++)
+	{
+		DrawKey key = pQueue->mpKeys[k];
+		unsigned long changes = 0;
+
+		// Changes are counted from the previous item drawn
+		if (pFilter && !pFilter(pQueue->mpItems[k], pContext))
+			continue;
+
+		if (pQueue->mStats.mItemNum++ == 0 || DRAW_KEY_BLEND(key) != blend)
+		{
+			blend = DRAW_KEY_BLEND(key);
+			changes |= DRAW_CHANGE_BLEND;
+			pQueue->mStats.mBlendChangeNum++;
+		}
+
+		if (pQueue->mStats.mItemNum == 1 || DRAW_KEY_MESH(key) != mesh)
+		{
+			mesh = DRAW_KEY_MESH(key);
+			changes |= DRAW_CHANGE_MESH;
+			pQueue->mStats.mMeshChangeNum++;
+		}
+
+		if (pDraw)
+			pDraw(key, pQueue->mpItems[k], changes, pContext);
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+static int DrawKeyCompare(const void *pA, const void *pB)
+{
+	DrawKey a = *(const DrawKey *)pA, b = *(const DrawKey *)pB;
+
+	return (a > b) - (a < b);
+}
+
+// ---------------------------------------------------------------------------
+
+void DrawQueueBenchmark(void)
+{
+	DrawQueue queue;
+	Random random;
+	DrawKey *pReference;
+	f64 start, end, radixTime = 0.0, qsortTime = 0.0;
+	unsigned long i, frame, passNum = 0, mismatchNum = 0;
+	unsigned long pushedBlendNum = 0, pushedMeshNum = 0, sortedBlendNum = 0, sortedMeshNum = 0;
+
+	DrawQueueInit(&queue, DRAW_BENCHMARK_NUM);
+	pReference = (DrawKey *)malloc(DRAW_BENCHMARK_NUM * sizeof(DrawKey));
+	AE_ASSERT_ALLOC(pReference);
+	RandomInit(&random, 2016, 0);
+
+	for (frame = 0; frame < DRAW_BENCHMARK_FRAME_NUM; frame++)
+	{
+		DrawQueueClear(&queue);
+
+		// Pushed in slot order: layers, depths and meshes come mixed, the last layer is translucent
+		for (i = 0; i < DRAW_BENCHMARK_NUM; i++)
+		{
+			unsigned long layer = RandomU32(&random) % DRAW_BENCHMARK_LAYER_NUM;
+			unsigned long depth = RandomU32(&random) % DRAW_BENCHMARK_DEPTH_NUM;
+			unsigned long mesh = RandomU32(&random) % DRAW_BENCHMARK_MESH_NUM;
+			unsigned int blend = (layer == DRAW_BENCHMARK_LAYER_NUM - 1) ? AE_GFX_BM_ADD : AE_GFX_BM_BLEND;
+
+			DrawQueuePush(&queue, DRAW_KEY(layer, depth, blend, mesh), i);
+		}
+
+		DrawQueueSubmit(&queue, 0, 0, 0);
+		pushedBlendNum += queue.mStats.mBlendChangeNum;
+		pushedMeshNum += queue.mStats.mMeshChangeNum;
+		memcpy(pReference, queue.mpKeys, DRAW_BENCHMARK_NUM * sizeof(DrawKey));
+
+		DrawQueueSort(&queue);
+		radixTime += queue.mStats.mSortTime;
+		passNum = queue.mStats.mPassNum;
+
+		DrawQueueSubmit(&queue, 0, 0, 0);
+		sortedBlendNum += queue.mStats.mBlendChangeNum;
+		sortedMeshNum += queue.mStats.mMeshChangeNum;
+
+		AEGetTime(&start);
+		qsort(pReference, DRAW_BENCHMARK_NUM, sizeof(DrawKey), DrawKeyCompare);
+		AEGetTime(&end);
+		qsortTime += end - start;
+
+		for (i = 0; i < DRAW_BENCHMARK_NUM; i++)
+			mismatchNum += (pReference[i] != queue.mpKeys[i]);
+	}
+
+	StartupPrintf("DrawQueue: %d items x %d frames, radix sort %.3f ms (%lu passes), qsort %.3f ms per frame, %lu keys out of order\n",
+		DRAW_BENCHMARK_NUM, DRAW_BENCHMARK_FRAME_NUM, radixTime * 1000.0 / DRAW_BENCHMARK_FRAME_NUM, passNum,
+		qsortTime * 1000.0 / DRAW_BENCHMARK_FRAME_NUM, mismatchNum);
+	StartupPrintf("DrawQueue: state changes per frame, push order %lu blend / %lu mesh, sorted %lu blend / %lu mesh\n",
+		pushedBlendNum / DRAW_BENCHMARK_FRAME_NUM, pushedMeshNum / DRAW_BENCHMARK_FRAME_NUM,
+		sortedBlendNum / DRAW_BENCHMARK_FRAME_NUM, sortedMeshNum / DRAW_BENCHMARK_FRAME_NUM);
+
+	free(pReference);
+	DrawQueueFree(&queue);
+}
@@ -0,0 +1,185 @@
+/* Start Header -------------------------------------------------------
+Copyright EventBus.c
+Purpose:  Implementation of the event bus
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_EventBus.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "EventBus.h"
+#include "Startup.h"
+
+#define EVENT_BENCHMARK_NUM			(1 << 22)
+#define EVENT_BENCHMARK_BATCH		1024				// Events published between two dispatches
+
+// ---------------------------------------------------------------------------
+
+void EventBusInit(EventBus *pBus, unsigned long Capacity)
+{
+	unsigned long capacity = 1, r;
+
+	while (capacity < Capacity)
+		capacity <<= 1;
+
+	memset(pBus, 0, sizeof(EventBus));
+
+	for (r = 0; r < EVENT_RING_MAX; r++)
+	{
+		pBus->mRings[r].mpEvents = (Event *)malloc(capacity * sizeof(Event));
+		AE_ASSERT_ALLOC(pBus->mRings[r].mpEvents);
+		pBus->mRings[r].mMask = capacity - 1;
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void EventBusFree(EventBus *pBus)
+{
+	unsigned long r;
+
+	for (r = 0; r < EVENT_RING_MAX; r++)
+		free(pBus->mRings[r].mpEvents);
+
+	memset(pBus, 0, sizeof(EventBus));
+}
+
+// ---------------------------------------------------------------------------
+
+void EventBusClear(EventBus *pBus)
+{
+	unsigned long r;
+
+	for (r = 0; r < EVENT_RING_MAX; r++)
+	{
+		EventRing *pRing = pBus->mRings + r;
+
+		pRing->mTail = pRing->mHead;
+		pRing->mTailCache = pRing->mHead;
+		pRing->mDropped = 0;
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+int EventBusSubscribe(EventBus *pBus, unsigned short Type, EventHandler Handler, void *pContext)
+{
+	EventSubscriber *pSubscriber;
+
+	AE_ASSERT_PARM(Type < EVENT_TYPE_MAX);
+
+	if (pBus->mSubscriberNum[Type] >= EVENT_SUBSCRIBER_MAX)
+		return 0;
+
+	pSubscriber = pBus->mSubscribers[Type] + pBus->mSubscriberNum[Type]++;
+	pSubscriber->mpHandler = Handler;
+	pSubscriber->mpContext = pContext;
+
+	return 1;
+}
+
+// ---------------------------------------------------------------------------
+
+int EventPublish(EventRing *pRing, unsigned short Type, unsigned short Data, unsigned long Instance, float X, float Y)
+{
+	unsigned long head = pRing->mHead;
+	Event *pEvent;
+
+	// The consumer's counter is only read when the cached one says the ring is full
+	if (head - pRing->mTailCache > pRing->mMask)
+	{
+		pRing->mTailCache = pRing->mTail;
+
+		if (head - pRing->mTailCache > pRing->mMask)
+		{
+			pRing->mDropped++;
+			return 0;
+		}
+	}
+
+	pEvent = pRing->mpEvents + (head & pRing->mMask);
+	pEvent->mType = Type;
+	pEvent->mData = Data;
+	pEvent->mInstance = Instance;
+	pEvent->mX = X;
+	pEvent->mY = Y;
+
+	// Volatile stores are releases with VS, the event is complete before the consumer sees the new head
+	pRing->mHead = head + 1;
+
+	return 1;
+}
+
+// ---------------------------------------------------------------------------
+
+void EventBusDispatch(EventBus *pBus)
+{
+	unsigned long r, s;
+
+	for (r = 0; r < EVENT_RING_MAX; r++)
+	{
+		EventRing *pRing = pBus->mRings + r;
+		unsigned long tail = pRing->mTail, head = pRing->mHead;
+
+		while (tail != head)
+		{
+			unsigned long first = tail & pRing->mMask, num = 1;
+			const Event *pFirst = pRing->mpEvents + first;
+			unsigned short type = pFirst->mType;
+
+			// Run of the same type, cut at the end of the ring
+			while (tail + num != head && first + num <= pRing->mMask && pFirst[num].mType == type)
+				num++;
+
+			if (type < EVENT_TYPE_MAX)
+				for (s = 0; s < pBus->mSubscriberNum[type]; s++)
+					pBus->mSubscribers[type][s].mpHandler(pFirst, num, pBus->mSubscribers[type][s].mpContext);
+
+			tail += num;
+		}
+
+		// The slots can be written again
+		pRing->mTail = tail;
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+static void EventBusBenchmarkHandler(const Event *pEvents, unsigned long Num, void *pContext)
+{
+	unsigned long *pCount = (unsigned long *)pContext;
+
+	*pCount += Num + (pEvents[Num - 1].mData & 1);
+}
+
+// ---------------------------------------------------------------------------
+
+void EventBusBenchmark(void)
+{
+	EventBus bus;
+	f64 start, publishTime = 0.0, dispatchTime = 0.0, mid, end;
+	unsigned long count = 0, i, b;
+
+	EventBusInit(&bus, EVENT_BENCHMARK_BATCH);
+	EventBusSubscribe(&bus, 0, EventBusBenchmarkHandler, &count);
+	EventBusSubscribe(&bus, 1, EventBusBenchmarkHandler, &count);
+
+	for (i = 0; i < EVENT_BENCHMARK_NUM; i += EVENT_BENCHMARK_BATCH)
+	{
+		AEGetTime(&start);
+		for (b = 0; b < EVENT_BENCHMARK_BATCH; b++)
+			EventPublish(bus.mRings, (unsigned short)((b >> 4) & 1), (unsigned short)b, i + b, 0.0f, 0.0f);
+		AEGetTime(&mid);
+		EventBusDispatch(&bus);
+		AEGetTime(&end);
+
+		publishTime += mid - start;
+		dispatchTime += end - mid;
+	}
+
+	StartupPrintf("EventBus: %d events, publish %.1f ns, dispatch %.1f ns per event, %lu dropped (%lu)\n", EVENT_BENCHMARK_NUM,
+		publishTime * 1e9 / EVENT_BENCHMARK_NUM, dispatchTime * 1e9 / EVENT_BENCHMARK_NUM, bus.mRings[0].mDropped, count);
+
+	EventBusFree(&bus);
+}
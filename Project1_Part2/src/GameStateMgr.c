@@ -13,6 +13,7 @@
 
 #include "GameStateMgr.h"
 #include "GameState_Asteroids.h"
+#include "Startup.h"
 
 // ---------------------------------------------------------------------------
 // globals
@@ -76,6 +77,8 @@ void GameStateMgrUpdate()
 
 void GSM_MainLoop(void)
 {
+	unsigned long frameNum = 0;
+
 	while (gGameStateCurr != GS_QUIT)
 	{
 		// reset the system modules
@@ -86,12 +89,14 @@ void GSM_MainLoop(void)
 		{
 			GameStateMgrUpdate();
 			GameStateLoad();
+			StartupMark("GameStateLoad");
 		}
 		else
 			gGameStateNext = gGameStateCurr = gGameStatePrev;
 
 		// Initialize the gamestate
 		GameStateInit();
+		StartupMark("GameStateInit");
 
 		while (gGameStateCurr == gGameStateNext)
 		{
@@ -101,10 +106,21 @@ void GSM_MainLoop(void)
 
 			GameStateUpdate();
 
-			GameStateDraw();
+			// Headless runs only simulate
+			if (!gStartupHeadless)
+				GameStateDraw();
 
 			AESysFrameEnd();
 
+			if (frameNum++ == 0)
+			{
+				StartupMark("First frame");
+				StartupReport();
+			}
+
+			if (gStartupHeadless && frameNum >= STARTUP_HEADLESS_FRAME_NUM)
+				gGameStateNext = GS_QUIT;
+
 			// check if forcing the application to quit
 			if ((0 == AESysDoesWindowExist()) || AEInputCheckTriggered(VK_ESCAPE))
 				gGameStateNext = GS_QUIT;
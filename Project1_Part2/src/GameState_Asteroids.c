@@ -12,12 +12,36 @@
 #include "Matrix2D.h"
 #include "Vector2D.h"
 #include "Math2D.h"
+#include "CommandQueue.h"
+#include "BarnesHut.h"
+#include "Bounds.h"
+#include "MeshBuilder.h"
+#include "AssetPack.h"
+#include "AsteroidsData.h"
+#include "AsteroidOutline.h"
+#include "World.h"
+#include "MultiView.h"
+#include "Random.h"
+#include "Query.h"
+#include "Behavior.h"
+#include "RenderTrace.h"
+#include "EventBus.h"
+#include "InputQueue.h"
+#include "AsyncLog.h"
+#include "ComponentPool.h"
+#include "Projectile.h"
+#include "Island.h"
+#include "Substep.h"
+#include "Pipeline3D.h"
+#include "DrawQueue.h"
+#include "Atlas.h"
 
 // ---------------------------------------------------------------------------
 // Defines
 
 #define SHAPE_NUM_MAX				32					// The total number of different vertex buffer (Shape)
-#define GAME_OBJ_INST_NUM_MAX		2048				// The total number of different game object instances
+#define GAME_OBJ_INST_NUM_MAX		8192				// The total number of different game object instances
+#define COMMAND_NUM_MAX				4096				// The total number of spawn/despawn commands per frame
 
 
 // Feel free to change these values in ordet to make the game more fun
@@ -34,26 +58,120 @@
 #define ASTEROID_SHIP_SCALE		4.f  //Asteroid is 4x larger than ship -- not really but eh
 #define ASTEROID_SPEED				50.f
 #define BULLET_SIZE		5.f
+#define BULLET_COLOR	0xFFFF0000				// Same as the bullet shape, the projectile meshes are built without it
 #define ASTEROID_SIZE	50.f
 #define MISSILE_WIDTH	10.f
 #define MISSILE_HEIGHT  5.f
 #define MISSILE_SPEED	75.f
-enum OBJECT_TYPE
+#define MISSILE_RETARGET_DELAY			0.25f				// Seconds between two target searches when no asteroid is left
+
+// Asteroid fragmentation: a hit asteroid splits into ASTEROID_FRAGMENT_NUM smaller ones, up to ASTEROID_FRAGMENT_DEPTH times
+#define ASTEROID_FRAGMENT_NUM			2
+#define ASTEROID_FRAGMENT_DEPTH			2
+#define ASTEROID_FRAGMENT_SCALE			0.5f				// Fragment size relative to its parent
+#define ASTEROID_FRAGMENT_SPEED			40.f				// Speed added to the parent's velocity (m/s)
+#define ASTEROID_FRAGMENT_JITTER		0.5f				// Random speed variation, as a fraction of ASTEROID_FRAGMENT_SPEED
+#define ASTEROID_FRAGMENT_STRESS_NUM	4096				// Fragments created by the 'F' stress test cascade, split parents included
+#define ASTEROID_FRAGMENT_STRESS_BUDGET	2.0					// Milliseconds the cascade should fit in, within one frame
+
+// Procedural asteroid outlines: every asteroid shares one of ASTEROID_VARIANT_NUM meshes of its size class
+#define ASTEROID_CLASS_NUM				3					// Small, medium, large
+#define ASTEROID_VARIANT_NUM			8
+#define ASTEROID_OUTLINE_SEED			2016
+#define ASTEROID_OUTLINE_ROUGHNESS		0.6f
+
+// Gravity-well mode ('G'): asteroids attract each other and bend bullet/missile paths
+#define GRAVITY_CONSTANT				20.f
+#define GRAVITY_THETA					0.5f				// Barnes-Hut opening angle, lower is more accurate
+#define GRAVITY_SOFTENING				25.f
+#define ASTEROID_DENSITY				1.f					// Asteroid mass per unit of area
+
+// World mode ('W'): the camera follows the ship over an endless field of chunks, only the ones around it are live
+#define WORLD_CHUNK_SIZE				512.f
+#define WORLD_ACTIVE_RADIUS				1					// Live chunks: (2 * radius + 1)^2 around the camera
+#define WORLD_CHUNK_ASTEROID_NUM		6					// Asteroids seeded in a chunk on its first visit
+
+#define QUERY_BENCHMARK_REPEAT			1000				// Passes over the instances timed by the 'Q' benchmark
+
+#define BEHAVIOR_FRAME_BUDGET			0.002				// Seconds of behavior scripts per frame, the rest spill to the next one
+#define BEHAVIOR_BENCHMARK_NUM			10000				// Behaviors run by the 'K' benchmark
+
+#define RENDER_TRACE_FRAME_NUM			60					// Frames recorded by 'T' into Render.trace
+
+#define PROJECTILE_CAPACITY				131072				// Bullets alive at once, the oldest are dropped past it
+#define PROJECTILE_BENCHMARK_NUM		100000				// Bullets kept alive by the 'J' benchmark
+
+#define FOOTPRINT_ENTITY_NUM			1000000				// Entity count the 'O' report extrapolates to
+
+#define PIPELINE_3D_IMAGE_FILE			"Asteroids3D.ppm"	// Last frame of the 'D' benchmark
+
+#define ATLAS_SIZE_MAX					1024
+#define ATLAS_SEED						2016
+#define SHAPE_VERTEX_MAX				256					// Vertices of one shape, mapped onto its atlas region before the mesh is created
+
+// Draw layers, back to front. Within a layer items are drawn by depth, then grouped by blend mode and mesh
+enum DRAW_LAYER
 {
-	// list of game object types
-	OBJECT_TYPE_SHIP = 0,
-	OBJECT_TYPE_BULLET,
-	OBJECT_TYPE_ASTEROID,
-	OBJECT_TYPE_HOMING_MISSILE,
+	DRAW_LAYER_ASTEROID = 0,							// Depth: split depth, fragments over their bigger neighbours
+	DRAW_LAYER_BULLET,									// Bullets and missiles, over the asteroids
+	DRAW_LAYER_SHIP,
+	DRAW_LAYER_HUD,										// Ships left, over everything
 
-	OBJECT_TYPE_NUM
+	DRAW_LAYER_NUM
 };
+#define DRAW_ITEM_PROJECTILES			GAME_OBJ_INST_NUM_MAX		// Draw item of the bullet batch, the instance slots come first
+#define DRAW_ITEM_LIFE					(GAME_OBJ_INST_NUM_MAX + 1)	// Draw item of the first ship left icon
+#define DRAW_MESH_PROJECTILES			SHAPE_NUM_MAX				// Mesh of the bullet batch in the keys, the shapes use their index
+#define DRAW_QUEUE_CAPACITY				(GAME_OBJ_INST_NUM_MAX + 64)
+#define DRAW_VIEW_ALL					-1					// DrawListSubmit draws every item, without the view masks
+#define HUD_LIFE_SIZE					(0.75f * SHIP_SIZE)
+#define HUD_LIFE_MARGIN					(1.5f * SHIP_SIZE)			// From the top left corner of the view, and between two icons
+
+#define SUBSTEP_OBSTACLE_NONE			-1					// No asteroid within reach this frame
+#define SUBSTEP_OBSTACLE_HIT			-2					// Touched its asteroid, the sub-steps stopped there
+
+// Random streams: each system draws from its own, so one does not shift the others' sequences
+#define RANDOM_SEED						2016
+enum RANDOM_STREAM
+{
+	RANDOM_STREAM_FRAGMENT = 0,
+	RANDOM_STREAM_VARIANT,
+	RANDOM_STREAM_WORLD,								// First of the world streams, one per chunk
+
+	RANDOM_STREAM_NUM
+};
+
+#define EVENT_RING_CAPACITY				1024				// Events a producer can publish between two dispatches
+#define EVENT_RING_MAIN					0
+enum EVENT_TYPE
+{
+	EVENT_ASTEROID_DESTROYED = 0,						// mData: split depth of the asteroid
+	EVENT_SHIP_HIT,										// mInstance: the asteroid that hit the ship
 
+	EVENT_TYPE_NUM
+};
 // ---------------------------------------------------------------------------
 // object mFlag definition
 
 #define FLAG_ACTIVE		0x00000001
 
+// ---------------------------------------------------------------------------
+// Instances and components refer to each other by index, 16 bits while the pools fit
+
+#if GAME_OBJ_INST_NUM_MAX <= 0xFFFF
+typedef unsigned short			ComponentIndex;
+#define COMPONENT_INDEX_NONE	0xFFFF
+#else
+typedef unsigned long			ComponentIndex;
+#define COMPONENT_INDEX_NONE	0xFFFFFFFF
+#endif
+
+// component of an instance, only valid while it has one
+#define INST_SPRITE(pInst)			(sgSprites + (pInst)->mSprite)
+#define INST_TRANSFORM(pInst)		(sgTransforms + (pInst)->mTransform)
+#define INST_PHYSICS(pInst)			(sgPhysics + (pInst)->mPhysics)
+#define INST_TARGET(pInst)			(sgTargets + (pInst)->mTarget)
+
 // ---------------------------------------------------------------------------
 // Struct/Class definitions
 
@@ -66,6 +184,12 @@ typedef struct
 	unsigned long			mType;				// Object type (Ship, bullet, etc..)
 	AEGfxVertexList*		mpMesh;				// This will hold the triangles which will form the shape of the object
 
+	unsigned long			mVertexNum;			// Number of vertices added to the mesh
+	float					mLocalMinX;			// Local AABB of the vertices, computed at load
+	float					mLocalMinY;
+	float					mLocalMaxX;
+	float					mLocalMaxY;
+	float					mLocalRadius;		// Largest distance between a vertex and the shape's origin
 }Shape;
 
 // ---------------------------------------------------------------------------
@@ -74,7 +198,7 @@ typedef struct
 {
 	Shape *mpShape;
 
-	GameObjectInstance *	mpOwner;			// This component's owner
+	ComponentIndex			mOwner;				// This component's owner, slot in sgGameObjectInstanceList
 }Component_Sprite;
 
 // ---------------------------------------------------------------------------
@@ -88,7 +212,7 @@ typedef struct
 
 	Matrix2D					mTransform;			// Object transformation matrix: Each frame, calculate the object instance's transformation matrix and save it here
 
-	GameObjectInstance *	mpOwner;			// This component's owner
+	ComponentIndex			mOwner;				// This component's owner, slot in sgGameObjectInstanceList
 }Component_Transform;
 
 // ---------------------------------------------------------------------------
@@ -97,16 +221,17 @@ typedef struct
 {
 	Vector2D					mVelocity;			// Current velocity
 
-	GameObjectInstance *	mpOwner;			// This component's owner
+	ComponentIndex			mOwner;				// This component's owner, slot in sgGameObjectInstanceList
 }Component_Physics;
 
 // ---------------------------------------------------------------------------
 
 typedef struct
 {
-	GameObjectInstance *		mpTarget;		// Target, used by the homing missile
+	ComponentIndex				mTarget;		// Target slot, used by the homing missile. COMPONENT_INDEX_NONE for none
+	unsigned short				mGeneration;	// The target slot's generation when it was picked, it changes once the target is destroyed
 
-	GameObjectInstance *		mpOwner;		// This component's owner
+	ComponentIndex				mOwner;			// This component's owner, slot in sgGameObjectInstanceList
 }Component_Target;
 
 // ---------------------------------------------------------------------------
@@ -115,14 +240,106 @@ typedef struct
 //Game object instance structure
 struct GameObjectInstance
 {
-	unsigned long				mFlag;						// Bit mFlag, used to indicate if the object instance is active or not
+	unsigned char				mFlag;						// Bit mFlag, used to indicate if the object instance is active or not
+	unsigned char				mSplitDepth;				// Number of times this asteroid's ancestors were split
+	unsigned short				mGeneration;				// Bumped every time the slot's instance is destroyed, tells a reused slot from the old instance
 
-	Component_Sprite			*mpComponent_Sprite;		// Sprite component
-	Component_Transform			*mpComponent_Transform;		// Transform component
-	Component_Physics			*mpComponent_Physics;		// Physics component
-	Component_Target			*mpComponent_Target;		// Target component, used by the homing missile
+	// Indices in the component pools, COMPONENT_INDEX_NONE when the instance has no such component
+	ComponentIndex				mSprite;					// Sprite component, in sgSprites
+	ComponentIndex				mTransform;					// Transform component, in sgTransforms
+	ComponentIndex				mPhysics;					// Physics component, in sgPhysics
+	ComponentIndex				mTarget;					// Target component, in sgTargets, used by the homing missile
+
+	ComponentIndex				mBehavior;					// Script started from the prefab, frame in sgBehaviors
 };
 
+// ---------------------------------------------------------------------------
+// Layouts FootprintReport compares the current one with, never instantiated, so that sizeof counts the padding
+
+// Before the pools: every component malloced on its own, instances and components linked by pointers
+typedef struct
+{
+	unsigned long				mFlag;
+	unsigned long				mSplitDepth;
+	void						*mpSprite, *mpTransform, *mpPhysics, *mpTarget, *mpBehavior;
+}FootprintPointerInstance;
+
+typedef struct
+{
+	Shape						*mpShape;
+	void						*mpOwner;
+}FootprintPointerSprite;
+
+typedef struct
+{
+	Vector2D					mPosition;
+	float						mAngle, mScaleX, mScaleY;
+	Matrix2D					mTransform;
+	void						*mpOwner;
+}FootprintPointerTransform;
+
+typedef struct
+{
+	Vector2D					mVelocity;
+	void						*mpOwner;
+}FootprintPointerPhysics;
+
+typedef struct
+{
+	void						*mpTarget;
+	void						*mpOwner;
+}FootprintPointerTarget;
+
+// Past 64K entities: the same as the current layout with 32 bit indices
+typedef struct
+{
+	unsigned char				mFlag;
+	unsigned char				mSplitDepth;
+	unsigned short				mGeneration;
+	unsigned long				mSprite, mTransform, mPhysics, mTarget, mBehavior;
+}FootprintWideInstance;
+
+typedef struct
+{
+	Shape						*mpShape;
+	unsigned long				mOwner;
+}FootprintWideSprite;
+
+typedef struct
+{
+	Vector2D					mPosition;
+	float						mAngle, mScaleX, mScaleY;
+	Matrix2D					mTransform;
+	unsigned long				mOwner;
+}FootprintWideTransform;
+
+typedef struct
+{
+	Vector2D					mVelocity;
+	unsigned long				mOwner;
+}FootprintWidePhysics;
+
+typedef struct
+{
+	unsigned long				mTarget;
+	unsigned short				mGeneration;
+	unsigned long				mOwner;
+}FootprintWideTarget;
+
+// ---------------------------------------------------------------------------
+
+// Initial component values of an object type, copied as is into every new instance
+typedef struct
+{
+	Component_Sprite			mSprite;
+	Component_Transform			mTransform;
+	Component_Physics			mPhysics;
+	Component_Target			mTarget;
+
+	unsigned long				mHasTarget;					// Only the homing missile carries a target component
+	BehaviorFunc				mpBehavior;					// Script started with every instance, 0 for none
+}Prefab;
+
 // ---------------------------------------------------------------------------
 // Static variables
 
@@ -133,6 +350,27 @@ static unsigned long		sgShapeNum;													// The number of defined shapes
 // list of object instances
 static GameObjectInstance		sgGameObjectInstanceList[GAME_OBJ_INST_NUM_MAX];		// Each element in this array represents a unique game object instance
 static unsigned long			sgGameObjectInstanceNum;								// The number of active game object instances
+static unsigned long			sgFreedSlots[GAME_OBJ_INST_NUM_MAX];					// Slots freed since the last flush, not published to the queue yet
+static unsigned long			sgFreedSlotNum;
+
+// component pools, indexed by the instances
+static Component_Sprite			sgSprites[GAME_OBJ_INST_NUM_MAX];
+static Component_Transform		sgTransforms[GAME_OBJ_INST_NUM_MAX];
+static Component_Physics		sgPhysics[GAME_OBJ_INST_NUM_MAX];
+static Component_Target			sgTargets[GAME_OBJ_INST_NUM_MAX];
+static ComponentPool			sgSpritePool;
+static ComponentPool			sgTransformPool;
+static ComponentPool			sgPhysicsPool;
+static ComponentPool			sgTargetPool;
+
+// bullets are not game object instances, they only need a position and a velocity
+static ProjectileSystem			sgProjectiles;
+
+// asteroid against asteroid contacts, one body slot per instance slot
+static IslandSolver				sgIslands;
+
+// one prefab per object type, built once the shapes exist
+static Prefab					sgPrefabs[OBJECT_TYPE_NUM];
 
 // pointer ot the ship object
 static GameObjectInstance*		sgpShip;												// Pointer to the "Ship" game object instance
@@ -145,11 +383,159 @@ static long						sgShipLives;											// The number of lives left
 // the score = number of asteroid destroyed
 static unsigned long			sgScore;												// Current score
 
+// raised by the event subscribers, applied once after the dispatch however the bus split the events into runs
+static int						sgShipHit;												// The ship was hit this frame
+static int						sgStatusChanged;										// The score or the lives changed this frame
+
+// spawn/despawn commands pushed by jobs, drained on the main thread at the frame sync point
+static CommandQueue				sgCommandQueue;
+static unsigned long			sgFreeHandles[GAME_OBJ_INST_NUM_MAX];					// Scratch list of free slots, published to the queue each frame
+
+// gravity-well mode
+static int						sgGravityMode;											// Toggled with 'G'
+static BarnesHut				sgGravityTree;
+static Vector2D					sgGravityBodies[GAME_OBJ_INST_NUM_MAX];					// Asteroid positions, the attracting bodies
+static float					sgGravityMasses[GAME_OBJ_INST_NUM_MAX];
+static Vector2D					sgGravityQueries[GAME_OBJ_INST_NUM_MAX + PROJECTILE_CAPACITY];	// Every attracted instance, then every live bullet
+static Vector2D					sgGravityAccelerations[GAME_OBJ_INST_NUM_MAX + PROJECTILE_CAPACITY];
+static GameObjectInstance*		sgGravityQueryInstances[GAME_OBJ_INST_NUM_MAX];
+static unsigned long			sgGravityQueryBullets[PROJECTILE_CAPACITY];				// Ring slot of each bullet query
+
+// world bounds of every slot, computed once per frame before collisions
+static BoundsCache				sgBounds;
+
+// adaptive sub-steps: movers batched by step count, against last frame's asteroid bounds
+static SubstepBatches			sgSubsteps;
+static long						sgSubstepObstacles[GAME_OBJ_INST_NUM_MAX];				// Nearest asteroid of each fast mover, SUBSTEP_OBSTACLE_NONE for the others
+static long						sgObstacleSlots[GAME_OBJ_INST_NUM_MAX];					// Asteroid slots, the obstacles
+static long						sgObstacleNum;
+static float					sgObstacleThinnest;										// Smallest side of any asteroid box
+
+// draw calls of a view, sorted by layer, depth and state before they are submitted
+static DrawQueue				sgDrawQueue;
+static DrawQueueStats			sgDrawStats;											// Last frame's, summed over the views
+
+// sprite images of every object type, packed at load into one texture so the draw queue keeps a single texture state
+static Atlas					sgAtlas;
+static AEGfxTexture*			sgpAtlasTexture;										// Null when the atlas could not be built, the shapes are then drawn in flat colors
+static long						sgAtlasRegionOfType[OBJECT_TYPE_NUM];
+
+// world mode, chunks outside the active area hold their asteroids as frozen records
+static int						sgWorldMode;
+static World					sgWorld;
+
+// split screen ('P' cycles 1 to VIEW_NUM_MAX views). View 0 follows the ship, the others follow asteroids
+static long						sgViewNum = 1;
+static unsigned char			sgViewMasks[GAME_OBJ_INST_NUM_MAX];						// Bit v: visible in view v
+static unsigned short			sgDrawSlots[GAME_OBJ_INST_NUM_MAX];						// Instances drawn this frame, by any view
+
+// instances listed by component signature, for the QUERY_EACH loops
+static Query					sgQuery;
+
+// gameplay events, handled by the subscribers below at the frame sync point
+static EventBus					sgEvents;
+
+// behavior scripts of the instances, resumed once per frame within BEHAVIOR_FRAME_BUDGET
+static BehaviorScheduler		sgBehaviors;
+
+// gameplay random streams, restarted by Init
+static Random					sgRandomFragment;
+static Random					sgRandomVariant;
+
+// outline variants, indexed by size class then variant. They live in sgShapes
+static Shape*					sgpAsteroidVariants[ASTEROID_CLASS_NUM][ASTEROID_VARIANT_NUM];
+
+// shapes and waves, mapped from Data\Asteroids.pak or pointing at the built in data
+static AssetPack				sgAssetPack;
+static const AssetPackWave*		sgpWaves;
+static const AssetPackSpawn*	sgpSpawns;
+static unsigned long			sgWaveNum;
+
 // ---------------------------------------------------------------------------
 
 // functions to create/destroy a game object instance
 static GameObjectInstance*			GameObjectInstanceCreate(unsigned int ObjectType);			// From OBJECT_TYPE enum
 static void							GameObjectInstanceDestroy(GameObjectInstance* pInst);
+static void							GameObjectInstanceInit(GameObjectInstance* pInst, unsigned int ObjectType);
+static unsigned long				GameObjectInstanceCreateBatch(unsigned int ObjectType, unsigned long Count, GameObjectInstance **ppInstances);
+
+// creates the shape's mesh from a vertex (and optional index) array, and computes the shape's local bounds
+static void							ShapeMeshCreate(Shape *pShape, const MeshVertex *pVertices, unsigned long VertexNum, const unsigned short *pIndices, unsigned long IndexNum);
+static void							ShapeBoundsAdd(Shape *pShape, float x, float y);
+static void							ShapesLoad(void);
+static void							SpritesAtlasBuild(void);
+static AEGfxVertexList*				ShapeMeshBuild(const Shape *pShape, const MeshVertex *pVertices, unsigned long VertexNum, const unsigned short *pIndices, unsigned long IndexNum);
+static void							WaveSpawn(unsigned long Wave);
+static void							AsteroidVariantsBuild(void);
+static void							AsteroidVariantAssign(GameObjectInstance *pInst);
+
+// copies the transform and shape bounds of slots [Start, Start + Count) into the bounds cache, then computes their world bounds
+static void							GameObjectBoundsUpdate(long Start, long Count);
+
+// builds the per type prefabs from the loaded shapes
+static void							PrefabsBuild(void);
+
+// destroys the asteroid and spawns its fragments in ppFragments (ASTEROID_FRAGMENT_NUM at most). Returns the number of fragments
+static unsigned long				AsteroidFragment(GameObjectInstance *pAsteroid, unsigned long MaxDepth, GameObjectInstance **ppFragments);
+static void							AsteroidFragmentStressTest(void);
+
+// adds the asteroids' gravitational pull to the velocities of asteroids, bullets and missiles
+static void							GravityApply(float dt);
+
+// bounces the asteroids off each other, every other slot is an empty body
+static void							AsteroidCollisionsSolve(float dt);
+
+// integrates every mover in batches of equal sub-step counts: one step unless it could skip over the nearest asteroid
+static void							MoversIntegrate(float dt);
+static void							SubstepObstaclesGather(void);
+static unsigned char				MoverSubstepLevel(long Slot, float dt);
+
+// destroys every asteroid holding a bullet, with the bullet
+static void							BulletHitsResolve(void);
+
+// world mode
+static void							WorldStream(void);
+static void							WorldChunkSeed(WorldChunk *pChunk);
+static void							WorldChunkThaw(WorldChunk *pChunk);
+
+// split screen
+static void							GameStateAsteroidsDrawViews(void);
+static void							DrawListBuild(const unsigned short *pSlots, unsigned long Num);
+static void							DrawListSubmit(long View);
+static int							DrawItemVisible(unsigned long Item, void *pContext);
+static void							DrawItemSubmit(DrawKey Key, unsigned long Item, unsigned long Changes, void *pContext);
+
+// 'Q': query loop against the hand written one
+static void							QueryBenchmark(void);
+
+// prints the bytes per entity of the index layout next to the old pointer one, and the live pool usage
+static void							FootprintReport(void);
+
+// fires a bullet that left the ship Age seconds before the end of the frame
+static void							BulletFire(float Age, float FrameTime);
+
+// event subscribers: scoring, ship hit, status line, Log.txt
+static void							EventsScoreUpdate(const Event *pEvents, unsigned long Num, void *pContext);
+static void							EventsShipHit(const Event *pEvents, unsigned long Num, void *pContext);
+static void							EventsStatusChanged(const Event *pEvents, unsigned long Num, void *pContext);
+static void							EventsLog(const Event *pEvents, unsigned long Num, void *pContext);
+
+// respawns the ship and logs the status once per dispatch, from the flags raised by the subscribers
+static void							EventsApply(void);
+
+// homing missile script: find an asteroid, chase it until it is gone, repeat
+static int							MissileBehavior(Behavior *pBehavior);
+static ComponentIndex				MissileTargetFind(void);
+static void							MissileSteer(GameObjectInstance *pInst, float Dt);
+
+// applies all the queued spawn/despawn commands, then publishes the free handles for the next frame
+static void							GameObjectCommandsFlush(void);
+
+// destroys every instance at once: a memset of the instances, the pools and the other tables cleared in constant time
+static void							GameObjectInstancesReset(void);
+
+// warns about any pool slot, query entry or behavior frame no live instance accounts for
+static void							GameObjectAccountingCheck(void);
 
 // ---------------------------------------------------------------------------
 
@@ -169,8 +555,6 @@ static void RemoveComponent_Target(GameObjectInstance *pInst);
 // "Load" function of this state
 void GameStateAsteroidsLoad(void)
 {
-	Shape* pShape = NULL;
-
 	// Zero the shapes array
 	memset(sgShapes, 0, sizeof(Shape) * SHAPE_NUM_MAX);
 	// No shapes at this point
@@ -179,95 +563,56 @@ void GameStateAsteroidsLoad(void)
 	// The ship object instance hasn't been created yet, so this "sgpShip" pointer is initialized to 0
 	sgpShip = 0;
 
+	AsyncLogInit();
+	CommandQueueInit(&sgCommandQueue, COMMAND_NUM_MAX, GAME_OBJ_INST_NUM_MAX);
 
+	// Fire and thrust keys are stamped by the input thread, nothing to record without a window to focus
+	if (!gStartupHeadless)
+	{
+		const unsigned char keys[] = { VK_SPACE, VK_UP, VK_DOWN };
 
-	/// Create the game objects(shapes) : Ships, Bullet, Asteroid and Missile
-	// How to:
-	// -- Remember to create normalized shapes, which means all the vertices' coordinates should be in the [-0.5;0.5] range. Use the object instances' scale values to resize the shape.
-	// -- Call “AEGfxMeshStart” to inform the graphics manager that you are about the start sending triangles.
-	// -- Call “AEGfxTriAdd” to add 1 triangle.
-	// -- A triangle is formed by 3 counter clockwise vertices (points).
-	// -- Create all the points between (-0.5, -0.5) and (0.5, 0.5), and use the object instance's scale to change the size.
-	// -- Each point can have its own color.
-	// -- The color format is : ARGB, where each 2 hexadecimal digits represent the value of the Alpha, Red, Green and Blue respectively. Note that alpha blending(Transparency) is not implemented.
-	// -- Each point can have its own texture coordinate (set them to 0.0f in case you’re not applying a texture).
-	// -- An object (Shape) can have multiple triangles.
-	// -- Call “AEGfxMeshEnd” to inform the graphics manager that you are done creating a mesh, which will return a pointer to the mesh you just created.
-
-	
-
-	// =====================
-	// Create the ship shape
-	// =====================
-
-	pShape = sgShapes + sgShapeNum++;
-	pShape->mType = OBJECT_TYPE_SHIP;
-
-	AEGfxMeshStart();
-	AEGfxTriAdd(
-		-0.5f,  0.5f, 0xFFFF0000, 0.0f, 0.0f, 
-		-0.5f, -0.5f, 0xFFFF0000, 0.0f, 0.0f,
-		 0.5f,  0.0f, 0xFFFFFFFF, 0.0f, 0.0f); 
-	pShape->mpMesh = AEGfxMeshEnd();
-
-
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	// TO DO 4:
-	// -- Create the bullet shape
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	pShape = sgShapes + sgShapeNum++;
-	pShape->mType = OBJECT_TYPE_BULLET;
-
-	AEGfxMeshStart();
-	AEGfxTriAdd(-0.5f, 0.5f, 0xFFFF0000, 0.0f, 0.0f,
-		-0.5f, -0.5f, 0xFFFF0000, 0.0f, 0.0f,
-		0.5f, -0.5f, 0xFFFF0000, 0.0f, 0.0f);
-	AEGfxTriAdd(-0.5f, 0.5f, 0xFFFF0000, 0.0f, 0.0f,
-		0.5f, 0.5f, 0xFFFF0000, 0.0f, 0.0f,
-		0.5f, -0.5f, 0xFFFF0000, 0.0f, 0.0f);
-	pShape->mpMesh = AEGfxMeshEnd();
-
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	// TO DO 7:
-	// -- Create the asteroid shape
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	//Same as bullet, just different scale?
-	pShape = sgShapes + sgShapeNum++;
-	pShape->mType = OBJECT_TYPE_ASTEROID;
-
-	AEGfxMeshStart();
-	AEGfxTriAdd(-0.5f, 0.5f, 0xFFFFFF00, 0.0f, 0.0f,
-		-0.5f, -0.5f, 0xFFFFFF00, 0.0f, 0.0f,
-		0.5f, -0.5f, 0xFFFFFF00, 0.0f, 0.0f);
-	AEGfxTriAdd(-0.5f, 0.5f, 0xFFFFFF00, 0.0f, 0.0f,
-		0.5f, 0.5f, 0xFFFFFF00, 0.0f, 0.0f,
-		0.5f, -0.5f, 0xFFFFFF00, 0.0f, 0.0f);
-	pShape->mpMesh = AEGfxMeshEnd();
+		InputQueueStart(AESysGetWindowHandle(), keys, sizeof(keys));
+	}
 
+	// The gravity tree is only needed once 'G' is pressed, lazy mode waits until then
+	if (!gStartupLazy)
+		BarnesHutInit(&sgGravityTree, GAME_OBJ_INST_NUM_MAX, GRAVITY_THETA, GRAVITY_CONSTANT, GRAVITY_SOFTENING);
+	BoundsCacheInit(&sgBounds, GAME_OBJ_INST_NUM_MAX);
+	QueryInit(&sgQuery, GAME_OBJ_INST_NUM_MAX);
+	ComponentPoolInit(&sgSpritePool, GAME_OBJ_INST_NUM_MAX);
+	ComponentPoolInit(&sgTransformPool, GAME_OBJ_INST_NUM_MAX);
+	ComponentPoolInit(&sgPhysicsPool, GAME_OBJ_INST_NUM_MAX);
+	ComponentPoolInit(&sgTargetPool, GAME_OBJ_INST_NUM_MAX);
+	ProjectileSystemInit(&sgProjectiles, PROJECTILE_CAPACITY);
+	IslandSolverInit(&sgIslands, GAME_OBJ_INST_NUM_MAX);
+	SubstepBatchesInit(&sgSubsteps, GAME_OBJ_INST_NUM_MAX);
+	DrawQueueInit(&sgDrawQueue, DRAW_QUEUE_CAPACITY);
+	BehaviorSchedulerInit(&sgBehaviors, GAME_OBJ_INST_NUM_MAX);
+
+	EventBusInit(&sgEvents, EVENT_RING_CAPACITY);
+	EventBusSubscribe(&sgEvents, EVENT_ASTEROID_DESTROYED, EventsScoreUpdate, 0);
+	EventBusSubscribe(&sgEvents, EVENT_SHIP_HIT, EventsShipHit, 0);
+	EventBusSubscribe(&sgEvents, EVENT_ASTEROID_DESTROYED, EventsStatusChanged, 0);
+	EventBusSubscribe(&sgEvents, EVENT_SHIP_HIT, EventsStatusChanged, 0);
+	EventBusSubscribe(&sgEvents, EVENT_ASTEROID_DESTROYED, EventsLog, 0);
+	EventBusSubscribe(&sgEvents, EVENT_SHIP_HIT, EventsLog, 0);
 
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	// TO DO 10:
-	// -- Create the homing missile shape
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	//Same as bullet, just different scale?
-	pShape = sgShapes + sgShapeNum++;
-	pShape->mType = OBJECT_TYPE_HOMING_MISSILE;
 
-	AEGfxMeshStart();
-	AEGfxTriAdd(-0.5f, 0.5f, 0xFFFFFFFF, 0.0f, 0.0f,
-		-0.5f, -0.5f, 0xFFFFFFFF, 0.0f, 0.0f,
-		0.5f, -0.5f, 0xFFFFFFFF, 0.0f, 0.0f);
-	AEGfxTriAdd(-0.5f, 0.5f, 0xFFFFFFFF, 0.0f, 0.0f,
-		0.5f, 0.5f, 0xFFFFFFFF, 0.0f, 0.0f,
-		0.5f, -0.5f, 0xFFFFFFFF, 0.0f, 0.0f);
-	pShape->mpMesh = AEGfxMeshEnd();
 
+	/// Create the game objects(shapes) : Ships, Bullet, Asteroid and Missile
+	// How to:
+	// -- Remember to create normalized shapes, which means all the vertices' coordinates should be in the [-0.5;0.5] range. Use the object instances' scale values to resize the shape.
+	// -- The shapes live in "AsteroidsData.h", and are baked into Data\Asteroids.pak by tools\AssetPacker.c.
+	// -- A triangle is formed by 3 counter clockwise vertices (points), or by 3 consecutive indices.
+	// -- The color format is : ARGB, where each 2 hexadecimal digits represent the value of the Alpha, Red, Green and Blue respectively. Note that alpha blending(Transparency) is not implemented.
+	// -- Shapes are textured from the sprite atlas, their vertex colors tint it.
+	// -- Headless runs draw nothing, the atlas is skipped and the meshes keep their flat colors.
+	if (!gStartupHeadless)
+		SpritesAtlasBuild();
+	ShapesLoad();
+	AsteroidVariantsBuild();
+
+	PrefabsBuild();
 }
 
 // ---------------------------------------------------------------------------
@@ -276,12 +621,15 @@ void GameStateAsteroidsLoad(void)
 void GameStateAsteroidsInit(void)
 {
 	AEGfxSetBackgroundColor(0.0f, 0.0f, 0.0f);
-	AEGfxSetBlendMode(AE_GFX_BM_BLEND);
+	RenderTraceSetBlendMode(AE_GFX_BM_BLEND);
 
-	// zero the game object instance array
-	memset(sgGameObjectInstanceList, 0, sizeof(GameObjectInstance)* GAME_OBJ_INST_NUM_MAX);
 	// No game object instances (sprites) at this point
-	sgGameObjectInstanceNum = 0;
+	GameObjectInstancesReset();
+	EventBusClear(&sgEvents);
+
+	// every game replays the same streams, starting with the first wave's variants
+	RandomInit(&sgRandomFragment, RANDOM_SEED, RANDOM_STREAM_FRAGMENT);
+	RandomInit(&sgRandomVariant, RANDOM_SEED, RANDOM_STREAM_VARIANT);
 
 	// create the main ship
 	sgpShip = GameObjectInstanceCreate(OBJECT_TYPE_SHIP);
@@ -295,32 +643,16 @@ void GameStateAsteroidsInit(void)
 	/////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-		GameObjectInstance* p = GameObjectInstanceCreate(OBJECT_TYPE_ASTEROID);
-		Vector2DSet(&(p->mpComponent_Transform->mPosition), 75, 321);
-		Vector2DSet(&(p->mpComponent_Physics->mVelocity), 60, -45);
-		p->mpComponent_Transform->mScaleX *= 3;
-		p->mpComponent_Transform->mScaleY *= 3;
-
-
-		 p = GameObjectInstanceCreate(OBJECT_TYPE_ASTEROID);
-		Vector2DSet(&(p->mpComponent_Transform->mPosition), -75, 75);
-		Vector2DSet(&(p->mpComponent_Physics->mVelocity), -30, 20);
-		p->mpComponent_Transform->mScaleX *= 2;
-		p->mpComponent_Transform->mScaleY *= 2;
-
-
-		p = GameObjectInstanceCreate(OBJECT_TYPE_ASTEROID);
-		Vector2DSet(&(p->mpComponent_Transform->mPosition),200, 10);
-		Vector2DSet(&(p->mpComponent_Physics->mVelocity),-10,22 );
-
-		p = NULL;
-	
-
+	WaveSpawn(0);
 
+	// publish the free handles so spawners can reserve them during the first frame
+	GameObjectCommandsFlush();
 
 	// reset the score and the number of ship
 	sgScore			= 0;
 	sgShipLives		= SHIP_INITIAL_NUM;
+	sgShipHit		= 0;
+	sgStatusChanged	= 0;
 }
 
 // ---------------------------------------------------------------------------
@@ -331,6 +663,10 @@ void GameStateAsteroidsUpdate(void)
 	unsigned long i;
 	float winMaxX, winMaxY, winMinX, winMinY;
 	double frameTime;
+	InputEvent inputEvents[INPUT_QUEUE_CAPACITY];
+	unsigned long inputNum = 0;
+	f64 inputStart, inputEnd, inputLength;
+	float thrustForward, thrustBackward;
 
 	// ==========================================================================================
 	// Getting the window's world edges (These changes whenever the camera moves or zooms in/out)
@@ -351,6 +687,20 @@ void GameStateAsteroidsUpdate(void)
 	// Update according to input
 	// =========================
 
+	// Presses with their exact time and the part of the frame each key was held, when the input thread runs
+	if (InputQueueIsRunning())
+	{
+		inputNum = InputQueueRead(inputEvents, INPUT_QUEUE_CAPACITY, &inputStart, &inputEnd);
+		inputLength = max(inputEnd - inputStart, INPUT_WINDOW_MIN);
+		thrustForward = InputQueueHeldFraction(VK_UP);
+		thrustBackward = InputQueueHeldFraction(VK_DOWN);
+	}
+	else
+	{
+		thrustForward = AEInputCheckCurr(VK_UP) ? 1.0f : 0.0f;
+		thrustBackward = AEInputCheckCurr(VK_DOWN) ? 1.0f : 0.0f;
+	}
+
 	/////////////////////////////////////////////////////////////////////////////////////////////////
 	/////////////////////////////////////////////////////////////////////////////////////////////////
 	// TO DO 3:
@@ -360,44 +710,44 @@ void GameStateAsteroidsUpdate(void)
 	// -- IMPORTANT: The current input code moves the ship by simply adjusting its position
 	/////////////////////////////////////////////////////////////////////////////////////////////////
 	/////////////////////////////////////////////////////////////////////////////////////////////////
-	if (AEInputCheckCurr(VK_UP))
+	if (thrustForward > 0.0f)
 	{
 		Vector2D accel;
-		Vector2DSet(&accel, cosf(sgpShip->mpComponent_Transform->mAngle), sinf(sgpShip->mpComponent_Transform->mAngle));
+		Vector2DSet(&accel, cosf(INST_TRANSFORM(sgpShip)->mAngle), sinf(INST_TRANSFORM(sgpShip)->mAngle));
 		Vector2DScale(&accel, &accel, SHIP_ACCEL_FORWARD);
 
 		Vector2D curVel;
-		Vector2DSet(&curVel, sgpShip->mpComponent_Physics->mVelocity.x, sgpShip->mpComponent_Physics->mVelocity.y);
-		Vector2DScaleAdd(&(sgpShip->mpComponent_Physics->mVelocity), &accel, &curVel, frameTime);
-		Vector2DScale(&(sgpShip->mpComponent_Physics->mVelocity), &(sgpShip->mpComponent_Physics->mVelocity), FRICTION);
-		//Vector2DScale(&(sgpShip->mpComponent_Physics->mVelocity), &(sgpShip->mpComponent_Physics->mVelocity), FRICTION);
-		//Vector2DAdd(&sgpShip->mpComponent_Transform->mPosition, &sgpShip->mpComponent_Transform->mPosition, &added);
+		Vector2DSet(&curVel, INST_PHYSICS(sgpShip)->mVelocity.x, INST_PHYSICS(sgpShip)->mVelocity.y);
+		Vector2DScaleAdd(&(INST_PHYSICS(sgpShip)->mVelocity), &accel, &curVel, frameTime * thrustForward);
+		Vector2DScale(&(INST_PHYSICS(sgpShip)->mVelocity), &(INST_PHYSICS(sgpShip)->mVelocity), FRICTION);
+		//Vector2DScale(&(INST_PHYSICS(sgpShip)->mVelocity), &(INST_PHYSICS(sgpShip)->mVelocity), FRICTION);
+		//Vector2DAdd(&INST_TRANSFORM(sgpShip)->mPosition, &INST_TRANSFORM(sgpShip)->mPosition, &added);
 	}
 
-	if (AEInputCheckCurr(VK_DOWN))
+	if (thrustBackward > 0.0f)
 	{
 		Vector2D accel;
-		Vector2DSet(&accel, cosf(sgpShip->mpComponent_Transform->mAngle), sinf(sgpShip->mpComponent_Transform->mAngle));
+		Vector2DSet(&accel, cosf(INST_TRANSFORM(sgpShip)->mAngle), sinf(INST_TRANSFORM(sgpShip)->mAngle));
 		Vector2DScale(&accel, &accel, SHIP_ACCEL_BACKWARD);
 
 		Vector2D curVel;
-		Vector2DSet(&curVel, sgpShip->mpComponent_Physics->mVelocity.x, sgpShip->mpComponent_Physics->mVelocity.y);
-		Vector2DScaleAdd(&(sgpShip->mpComponent_Physics->mVelocity), &accel, &curVel, frameTime);
-		Vector2DScale(&(sgpShip->mpComponent_Physics->mVelocity), &(sgpShip->mpComponent_Physics->mVelocity), FRICTION);
-		//Vector2DScale(&(sgpShip->mpComponent_Physics->mVelocity), &(sgpShip->mpComponent_Physics->mVelocity), FRICTION);
-		//Vector2DAdd(&sgpShip->mpComponent_Transform->mPosition, &sgpShip->mpComponent_Transform->mPosition, &added);
+		Vector2DSet(&curVel, INST_PHYSICS(sgpShip)->mVelocity.x, INST_PHYSICS(sgpShip)->mVelocity.y);
+		Vector2DScaleAdd(&(INST_PHYSICS(sgpShip)->mVelocity), &accel, &curVel, frameTime * thrustBackward);
+		Vector2DScale(&(INST_PHYSICS(sgpShip)->mVelocity), &(INST_PHYSICS(sgpShip)->mVelocity), FRICTION);
+		//Vector2DScale(&(INST_PHYSICS(sgpShip)->mVelocity), &(INST_PHYSICS(sgpShip)->mVelocity), FRICTION);
+		//Vector2DAdd(&INST_TRANSFORM(sgpShip)->mPosition, &INST_TRANSFORM(sgpShip)->mPosition, &added);
 	}
 
 	if (AEInputCheckCurr(VK_LEFT))
 	{
-		sgpShip->mpComponent_Transform->mAngle += SHIP_ROT_SPEED * (float)(frameTime);
-		sgpShip->mpComponent_Transform->mAngle = AEWrap(sgpShip->mpComponent_Transform->mAngle, -PI, PI);
+		INST_TRANSFORM(sgpShip)->mAngle += SHIP_ROT_SPEED * (float)(frameTime);
+		INST_TRANSFORM(sgpShip)->mAngle = AEWrap(INST_TRANSFORM(sgpShip)->mAngle, -PI, PI);
 	}
 
 	if (AEInputCheckCurr(VK_RIGHT))
 	{
-		sgpShip->mpComponent_Transform->mAngle -= SHIP_ROT_SPEED * (float)(frameTime);
-		sgpShip->mpComponent_Transform->mAngle = AEWrap(sgpShip->mpComponent_Transform->mAngle, -PI, PI);
+		INST_TRANSFORM(sgpShip)->mAngle -= SHIP_ROT_SPEED * (float)(frameTime);
+		INST_TRANSFORM(sgpShip)->mAngle = AEWrap(INST_TRANSFORM(sgpShip)->mAngle, -PI, PI);
 	}
 
 	/////////////////////////////////////////////////////////////////////////////////////////////////
@@ -406,14 +756,16 @@ void GameStateAsteroidsUpdate(void)
 	// -- Create a bullet instance when SPACE is triggered, using the "GameObjInstCreate" function
 	/////////////////////////////////////////////////////////////////////////////////////////////////
 	/////////////////////////////////////////////////////////////////////////////////////////////////
-	if (AEInputCheckTriggered(VK_SPACE))
+	// Every press fires, even several in one frame, each from where the ship was at that time
+	if (InputQueueIsRunning())
 	{
-		//Double check this
-		GameObjectInstance* t;
-		t = (GameObjectInstanceCreate(OBJECT_TYPE_BULLET));
-		Vector2DSet(&(t->mpComponent_Physics->mVelocity), BULLET_SPEED * cosf(sgpShip->mpComponent_Transform->mAngle), BULLET_SPEED * sinf(sgpShip->mpComponent_Transform->mAngle));
-		t = NULL;
-
+		for (i = 0; i < inputNum; i++)
+			if (inputEvents[i].mKey == VK_SPACE && inputEvents[i].mDown)
+				BulletFire((float)((inputEnd - max(inputEvents[i].mTime, inputStart)) / inputLength * frameTime), (float)frameTime);
+	}
+	else if (AEInputCheckTriggered(VK_SPACE))
+	{
+		BulletFire(0.0f, (float)frameTime);
 	}
 
 	/////////////////////////////////////////////////////////////////////////////////////////////////
@@ -425,52 +777,143 @@ void GameStateAsteroidsUpdate(void)
 	if (AEInputCheckTriggered('M'))
 	{
 		//GameObjectInstanceCreate(OBJECT_TYPE_HOMING_MISSILE);
-	//	Vector2DSet(&(GameObjectInstanceCreate(OBJECT_TYPE_HOMING_MISSILE)->mpComponent_Physics->mVelocity), sgpShip->mpComponent_Physics->mVelocity.x, sgpShip->mpComponent_Physics->mVelocity.y);
+	//	Vector2DSet(&(INST_PHYSICS(GameObjectInstanceCreate(OBJECT_TYPE_HOMING_MISSILE))->mVelocity), INST_PHYSICS(sgpShip)->mVelocity.x, INST_PHYSICS(sgpShip)->mVelocity.y);
 
-		GameObjectInstance* t;
-		t = (GameObjectInstanceCreate(OBJECT_TYPE_HOMING_MISSILE));
-		Vector2DSet(&(t->mpComponent_Physics->mVelocity), MISSILE_SPEED * cosf(sgpShip->mpComponent_Transform->mAngle), MISSILE_SPEED * sinf(sgpShip->mpComponent_Transform->mAngle));
-		
-		t = NULL;
+		Vector2D vel;
+		Vector2DSet(&vel, MISSILE_SPEED * cosf(INST_TRANSFORM(sgpShip)->mAngle), MISSILE_SPEED * sinf(INST_TRANSFORM(sgpShip)->mAngle));
+		CommandQueuePushSpawn(&sgCommandQueue, CommandQueueReserveHandle(&sgCommandQueue), OBJECT_TYPE_HOMING_MISSILE, &(INST_TRANSFORM(sgpShip)->mPosition), &vel, INST_TRANSFORM(sgpShip)->mAngle, 1.0f);
 	}
 
+	// Stress test: shatter a new asteroid into ASTEROID_FRAGMENT_STRESS_NUM fragments in one frame
+	if (AEInputCheckTriggered('F'))
+	{
+		AsteroidFragmentStressTest();
+	}
 
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	// TO DO 2:
-	// Update the positions of all active game object instances
-	// -- Positions are updated here (P1 = V1*t + P0)
-	// -- If implemented correctly, you will be able to control the ship (basic 2D movement)
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////////////////
+	if (AEInputCheckTriggered('G'))
+	{
+		sgGravityMode = !sgGravityMode;
 
+		if (0 == sgGravityTree.mpNodes)
+			BarnesHutInit(&sgGravityTree, GAME_OBJ_INST_NUM_MAX, GRAVITY_THETA, GRAVITY_CONSTANT, GRAVITY_SOFTENING);
+	}
 
+	if (AEInputCheckTriggered('W'))
+	{
+		sgWorldMode = !sgWorldMode;
 
+		if (0 == sgWorld.mpChunks)
+			WorldInit(&sgWorld, WORLD_CHUNK_SIZE, WORLD_ACTIVE_RADIUS);
 
-	for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+		// Back to the single screen field; the frozen chunks wait for the next time
+		if (!sgWorldMode)
+			AEGfxSetCamPosition(0.0f, 0.0f);
+	}
+
+	if (AEInputCheckTriggered('P'))
 	{
-		GameObjectInstance* pInst = sgGameObjectInstanceList + i;
+		sgViewNum = sgViewNum % VIEW_NUM_MAX + 1;
+	}
 
-		// skip non-active object
-		if ((pInst->mFlag & FLAG_ACTIVE) == 0 || pInst == NULL)
-			continue;
+	if (AEInputCheckTriggered('B'))
+	{
+		BarnesHutBenchmark();
+	}
+
+	if (AEInputCheckTriggered('R'))
+	{
+		RandomBenchmark();
+	}
+
+	if (AEInputCheckTriggered('Q'))
+	{
+		QueryBenchmark();
+	}
+
+	if (AEInputCheckTriggered('O'))
+	{
+		FootprintReport();
+	}
+
+	if (AEInputCheckTriggered('J'))
+	{
+		ProjectileBenchmark(PROJECTILE_BENCHMARK_NUM);
+	}
+
+	if (AEInputCheckTriggered('I'))
+	{
+		IslandSolverBenchmark();
+	}
+
+	if (AEInputCheckTriggered('U'))
+	{
+		SubstepBenchmark();
+	}
+
+	if (AEInputCheckTriggered('D'))
+	{
+		double verticesPerSecond[2], pixelsPerSecond[2];
 
+		Pipeline3DBenchmark(verticesPerSecond, pixelsPerSecond, PIPELINE_3D_IMAGE_FILE);
+		StartupPrintf("Pipeline3D: %.2f M vertices/s, %.2f M pixels/s (1 thread) / %.2f M vertices/s, %.2f M pixels/s (%d threads), last frame in %s\n",
+			verticesPerSecond[0] * 1e-6, pixelsPerSecond[0] * 1e-6, verticesPerSecond[1] * 1e-6, pixelsPerSecond[1] * 1e-6,
+			PIPELINE_3D_THREAD_NUM, PIPELINE_3D_IMAGE_FILE);
+	}
+
+	if (AEInputCheckTriggered('Z'))
+	{
+		StartupPrintf("Draw: %lu items, sort %.3f ms (%lu passes), %lu blend / %lu mesh changes last frame\n",
+			sgDrawStats.mItemNum, sgDrawStats.mSortTime * 1000.0, sgDrawStats.mPassNum,
+			sgDrawStats.mBlendChangeNum, sgDrawStats.mMeshChangeNum);
+		DrawQueueBenchmark();
+	}
 
-		//if (pInst->mFlag == OBJECT_TYPE_SHIP)
-	//	{
+	if (AEInputCheckTriggered('K'))
+	{
+		BehaviorBenchmark(BEHAVIOR_BENCHMARK_NUM);
+	}
 
-		//}
+	if (AEInputCheckTriggered('T'))
+	{
+		RenderTraceCaptureStart(RENDER_TRACE_FRAME_NUM);
+	}
 
-		Vector2D curPos;
-		curPos.x = pInst->mpComponent_Transform->mPosition.x;
-		curPos.y = pInst->mpComponent_Transform->mPosition.y;
+	if (AEInputCheckTriggered('E'))
+	{
+		EventBusBenchmark();
+	}
 
-		pInst->mpComponent_Transform->mPosition.x = (curPos.x + (pInst->mpComponent_Physics->mVelocity.x) * frameTime);
+	if (AEInputCheckTriggered('L'))
+	{
+		AsyncLogBenchmark();
+	}
 
-		pInst->mpComponent_Transform->mPosition.y = (curPos.y + (pInst->mpComponent_Physics->mVelocity.y) * frameTime);
+	if (AEInputCheckTriggered('V'))
+	{
+		MeshBuilderBenchmark();
+	}
 
+	if (sgGravityMode)
+	{
+		GravityApply((float)frameTime);
 	}
 
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// TO DO 2:
+	// Update the positions of all active game object instances
+	// -- Positions are updated here (P1 = V1*t + P0)
+	// -- If implemented correctly, you will be able to control the ship (basic 2D movement)
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+
+
+	// Fast movers get more sub-steps than the slow ones, each batch is integrated in one go
+	MoversIntegrate((float)frameTime);
+
 	/////////////////////////////////////////////////////////////////////////////////////////////////
 	/////////////////////////////////////////////////////////////////////////////////////////////////
 	// TO DO 6: Specific game object behavior, according to type
@@ -489,81 +932,41 @@ void GameStateAsteroidsUpdate(void)
 			continue;
 
 		// check if the object is a ship
-		if (pInst->mpComponent_Sprite->mpShape->mType == OBJECT_TYPE_SHIP)
-		{
-			// warp the ship from one end of the screen to the other
-			pInst->mpComponent_Transform->mPosition.x = AEWrap(pInst->mpComponent_Transform->mPosition.x, winMinX - SHIP_SIZE, winMaxX + SHIP_SIZE);
-			pInst->mpComponent_Transform->mPosition.y = AEWrap(pInst->mpComponent_Transform->mPosition.y, winMinY - SHIP_SIZE, winMaxY + SHIP_SIZE);
-		}
-
-		// Bullet behavior
-		else if (pInst->mpComponent_Sprite->mpShape->mType == OBJECT_TYPE_BULLET)
+		if (INST_SPRITE(pInst)->mpShape->mType == OBJECT_TYPE_SHIP)
 		{
-
-			if (pInst->mpComponent_Transform->mPosition.x > winMaxX || pInst->mpComponent_Transform->mPosition.x < winMinX || pInst->mpComponent_Transform->mPosition.y > winMaxY || pInst->mpComponent_Transform->mPosition.y < winMinY)
+			// warp the ship from one end of the screen to the other, the world mode camera follows it instead
+			if (!sgWorldMode)
 			{
-				GameObjectInstanceDestroy(pInst);
+				INST_TRANSFORM(pInst)->mPosition.x = AEWrap(INST_TRANSFORM(pInst)->mPosition.x, winMinX - SHIP_SIZE, winMaxX + SHIP_SIZE);
+				INST_TRANSFORM(pInst)->mPosition.y = AEWrap(INST_TRANSFORM(pInst)->mPosition.y, winMinY - SHIP_SIZE, winMaxY + SHIP_SIZE);
 			}
 		}
 
 		// Asteroid behavior
-		else if (pInst->mpComponent_Sprite->mpShape->mType == OBJECT_TYPE_ASTEROID)
+		else if (INST_SPRITE(pInst)->mpShape->mType == OBJECT_TYPE_ASTEROID && !sgWorldMode)
 		{
 
-			pInst->mpComponent_Transform->mPosition.x = AEWrap(pInst->mpComponent_Transform->mPosition.x, winMinX - ASTEROID_SIZE, winMaxX + ASTEROID_SIZE);
-			pInst->mpComponent_Transform->mPosition.y = AEWrap(pInst->mpComponent_Transform->mPosition.y, winMinY - ASTEROID_SIZE, winMaxY + ASTEROID_SIZE);
+			INST_TRANSFORM(pInst)->mPosition.x = AEWrap(INST_TRANSFORM(pInst)->mPosition.x, winMinX - ASTEROID_SIZE, winMaxX + ASTEROID_SIZE);
+			INST_TRANSFORM(pInst)->mPosition.y = AEWrap(INST_TRANSFORM(pInst)->mPosition.y, winMinY - ASTEROID_SIZE, winMaxY + ASTEROID_SIZE);
 		}
 
 		// Homing missile behavior (Not every game object instance will have this component!)
 
-		else if (pInst->mpComponent_Sprite->mpShape->mType == OBJECT_TYPE_HOMING_MISSILE)
+		else if (INST_SPRITE(pInst)->mpShape->mType == OBJECT_TYPE_HOMING_MISSILE)
 		{
-			pInst->mpComponent_Transform->mPosition.x = AEWrap(pInst->mpComponent_Transform->mPosition.x, winMinX - MISSILE_WIDTH, winMaxX + MISSILE_WIDTH);
-			pInst->mpComponent_Transform->mPosition.y = AEWrap(pInst->mpComponent_Transform->mPosition.y, winMinY - MISSILE_HEIGHT, winMaxY + MISSILE_HEIGHT);
-
-
-			if (pInst->mpComponent_Target->mpTarget == NULL  || pInst->mpComponent_Target->mpTarget->mFlag != FLAG_ACTIVE)
-			{
-				for (int i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
-				{
-					if (sgGameObjectInstanceList[i].mFlag == FLAG_ACTIVE && sgGameObjectInstanceList[i].mpComponent_Sprite->mpShape->mType == OBJECT_TYPE_ASTEROID)
-					{
-						pInst->mpComponent_Target->mpTarget = &sgGameObjectInstanceList[i];
-						i = GAME_OBJ_INST_NUM_MAX;
-					}
-				}
-			}
-
-			//Homing logic goes here
-			if (pInst->mpComponent_Target->mpTarget != NULL && pInst->mpComponent_Target->mpTarget->mFlag == FLAG_ACTIVE)
+			if (!sgWorldMode)
 			{
-				Vector2D mVel, normal, asteroidVec;
-
-				Vector2DSet(&mVel, pInst->mpComponent_Physics->mVelocity.x, pInst->mpComponent_Physics->mVelocity.y);
-				Vector2DSet(&normal, -1 * mVel.y, mVel.x);
-				Vector2DSet(&asteroidVec, (pInst->mpComponent_Target->mpTarget->mpComponent_Transform->mPosition.x) - (pInst->mpComponent_Transform->mPosition.x), (pInst->mpComponent_Target->mpTarget->mpComponent_Transform->mPosition.y) - (pInst->mpComponent_Transform->mPosition.y));
-
-				float angle = (mVel.x * asteroidVec.x + mVel.y * asteroidVec.y) / (Vector2DLength(&mVel) * Vector2DLength(&asteroidVec));  //May need to turn to radians, check disssss
-				float a = min(HOMING_MISSILE_ROT_SPEED * frameTime, acosf(angle ));
-
-				if (normal.x * asteroidVec.x + normal.y * asteroidVec.y < 0)
-				{
-					a = -a;
-				}
-
-			float curAngle =	pInst->mpComponent_Transform->mAngle + a;
-				pInst->mpComponent_Transform->mAngle += a;
-				//float curAngle = pInst->mpComponent_Transform->mAngle +a;
-				Vector2DSet(&(pInst->mpComponent_Physics->mVelocity), cosf(curAngle), sinf(curAngle));
-				Vector2DNormalize(&(pInst->mpComponent_Physics->mVelocity), &(pInst->mpComponent_Physics->mVelocity));
-				Vector2DScale(&(pInst->mpComponent_Physics->mVelocity), &(pInst->mpComponent_Physics->mVelocity), MISSILE_SPEED, MISSILE_SPEED);
+				INST_TRANSFORM(pInst)->mPosition.x = AEWrap(INST_TRANSFORM(pInst)->mPosition.x, winMinX - MISSILE_WIDTH, winMaxX + MISSILE_WIDTH);
+				INST_TRANSFORM(pInst)->mPosition.y = AEWrap(INST_TRANSFORM(pInst)->mPosition.y, winMinY - MISSILE_HEIGHT, winMaxY + MISSILE_HEIGHT);
 			}
 		}
+	}
 
+	// Homing missiles and any other scripted instance
+	BehaviorSchedulerRun(&sgBehaviors, frameTime, BEHAVIOR_FRAME_BUDGET);
 
-
-
-	}
+	// Asteroids bounce off each other, resting clusters sleep until something hits them
+	AsteroidCollisionsSolve((float)frameTime);
 
 
 	/////////////////////////////////////////////////////////////////////////////////////////////////
@@ -603,11 +1006,30 @@ void GameStateAsteroidsUpdate(void)
 	*/
 
 
+	// Freeze what left the live area, thaw what came into it
+	if (sgWorldMode)
+		WorldStream();
+
+	// World bounds of every instance, shared by all the tests below
+	GameObjectBoundsUpdate(0, GAME_OBJ_INST_NUM_MAX);
+
+	// Bullets: moved, destroyed when outside the viewport, and sorted for the hit queries.
+	// They all share one speed, so they are a single batch, sub-stepped so none skips over the thinnest asteroid
+	{
+		int steps = 1 << SubstepLevel(BULLET_SPEED * (float)frameTime, BULLET_SIZE + sgObstacleThinnest), s;
+
+		for (s = 0; s < steps; s++)
+		{
+			ProjectileUpdate(&sgProjectiles, (float)frameTime / steps, winMinX, winMinY, winMaxX, winMaxY);
+			BulletHitsResolve();
+		}
+	}
+
 	for (int i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
 	{
 	
 
-		if ( sgGameObjectInstanceList[i].mFlag == FLAG_ACTIVE && sgGameObjectInstanceList[i].mpComponent_Sprite->mpShape->mType == OBJECT_TYPE_ASTEROID)
+		if ( sgGameObjectInstanceList[i].mFlag == FLAG_ACTIVE && INST_SPRITE(&sgGameObjectInstanceList[i])->mpShape->mType == OBJECT_TYPE_ASTEROID)
 		{
 			for (int j = 0; j < GAME_OBJ_INST_NUM_MAX; j++)
 			{
@@ -618,40 +1040,37 @@ void GameStateAsteroidsUpdate(void)
 				else{
 					if (sgGameObjectInstanceList[j].mFlag == FLAG_ACTIVE)
 					{
-						if (sgGameObjectInstanceList[j].mpComponent_Sprite->mpShape->mType == OBJECT_TYPE_SHIP)
+						if (INST_SPRITE(&sgGameObjectInstanceList[j])->mpShape->mType == OBJECT_TYPE_SHIP)
 						{
-							if (1 == StaticRectToStaticRect(&(sgGameObjectInstanceList[i].mpComponent_Transform->mPosition), sgGameObjectInstanceList[i].mpComponent_Transform->mScaleX, sgGameObjectInstanceList[i].mpComponent_Transform->mScaleY, &(sgGameObjectInstanceList[j].mpComponent_Transform->mPosition), sgGameObjectInstanceList[j].mpComponent_Transform->mScaleX, sgGameObjectInstanceList[j].mpComponent_Transform->mScaleY))
+							if (1 == BoundsCacheOverlap(&sgBounds, i, j))
 							{
+								Vector2D position = INST_TRANSFORM(&sgGameObjectInstanceList[i])->mPosition;
+
 								GameObjectInstanceDestroy(&(sgGameObjectInstanceList[i]));
 								//GameObjectInstanceDestroy(&(sgGameObjectInstanceList[j]));
 								//sgpShip = GameObjectInstanceCreate(OBJECT_TYPE_SHIP);
 
-
-								Vector2DSet(&sgpShip->mpComponent_Transform->mPosition, sgpShipStartPos.x, sgpShipStartPos.y);
-								Vector2DSet(&sgpShip->mpComponent_Physics->mVelocity, sgpShipStartPhys.x, sgpShipStartPhys.y);
-								//sgpShip->mpComponent_Transform = sgpShipStartPos;
-								//sgpShip->mpComponent_Physics = sgpShipStartPhys;
+								// the ship is reset by its subscriber at the sync point
+								EventPublish(sgEvents.mRings + EVENT_RING_MAIN, EVENT_SHIP_HIT, 0, i, position.x, position.y);
 							}
 						}
 
 
-						else if (sgGameObjectInstanceList[j].mpComponent_Sprite->mpShape->mType == OBJECT_TYPE_BULLET)
+						else if (INST_SPRITE(&sgGameObjectInstanceList[j])->mpShape->mType == OBJECT_TYPE_HOMING_MISSILE)
 						{
-							if (1 == StaticPointToStaticRect(&(sgGameObjectInstanceList[j].mpComponent_Transform->mPosition), &(sgGameObjectInstanceList[i].mpComponent_Transform->mPosition), sgGameObjectInstanceList[i].mpComponent_Transform->mScaleX, sgGameObjectInstanceList[i].mpComponent_Transform->mScaleY))
+							if (1 == BoundsCacheOverlap(&sgBounds, i, j))
 							{
-								GameObjectInstanceDestroy(&(sgGameObjectInstanceList[i]));
-								GameObjectInstanceDestroy(&(sgGameObjectInstanceList[j]));
-							}
-						}
+								GameObjectInstance *fragments[ASTEROID_FRAGMENT_NUM];
+								Vector2D position = INST_TRANSFORM(&sgGameObjectInstanceList[i])->mPosition;
+								unsigned long k, num;
 
+								EventPublish(sgEvents.mRings + EVENT_RING_MAIN, EVENT_ASTEROID_DESTROYED, (unsigned short)sgGameObjectInstanceList[i].mSplitDepth, i, position.x, position.y);
 
-						else if (sgGameObjectInstanceList[j].mpComponent_Sprite->mpShape->mType == OBJECT_TYPE_HOMING_MISSILE)
-						{
-							if (1 == StaticRectToStaticRect(&(sgGameObjectInstanceList[i].mpComponent_Transform->mPosition), sgGameObjectInstanceList[i].mpComponent_Transform->mScaleX, sgGameObjectInstanceList[i].mpComponent_Transform->mScaleY, &(sgGameObjectInstanceList[j].mpComponent_Transform->mPosition), sgGameObjectInstanceList[j].mpComponent_Transform->mScaleX, sgGameObjectInstanceList[j].mpComponent_Transform->mScaleY))
-							{
-								GameObjectInstanceDestroy(&(sgGameObjectInstanceList[i]));
 								GameObjectInstanceDestroy(&(sgGameObjectInstanceList[j]));
+								num = AsteroidFragment(&(sgGameObjectInstanceList[i]), ASTEROID_FRAGMENT_DEPTH, fragments);
 
+								for (k = 0; k < num; k++)
+									GameObjectBoundsUpdate(fragments[k] - sgGameObjectInstanceList, 1);
 							}
 						}
 					}
@@ -661,6 +1080,15 @@ void GameStateAsteroidsUpdate(void)
 	}
 
 
+	// ==========================================================
+	// frame sync point: apply the queued spawn/despawn commands
+	// ==========================================================
+
+	EventBusDispatch(&sgEvents);
+	EventsApply();
+	GameObjectCommandsFlush();
+
+
 	// =====================================
 	// calculate the matrix for all objects
 	// =====================================
@@ -684,13 +1112,13 @@ void GameStateAsteroidsUpdate(void)
 		/////////////////////////////////////////////////////////////////////////////////////////////////
 		/////////////////////////////////////////////////////////////////////////////////////////////////
 
-		Matrix2DScale(&scale, pInst->mpComponent_Transform->mScaleX, pInst->mpComponent_Transform->mScaleY);
-		Matrix2DRotRad(&rotate, pInst->mpComponent_Transform->mAngle);
-		Matrix2DTranslate(&trans, pInst->mpComponent_Transform->mPosition.x, pInst->mpComponent_Transform->mPosition.y);
+		Matrix2DScale(&scale, INST_TRANSFORM(pInst)->mScaleX, INST_TRANSFORM(pInst)->mScaleY);
+		Matrix2DRotRad(&rotate, INST_TRANSFORM(pInst)->mAngle);
+		Matrix2DTranslate(&trans, INST_TRANSFORM(pInst)->mPosition.x, INST_TRANSFORM(pInst)->mPosition.y);
 
-		Matrix2DIdentity(&(pInst->mpComponent_Transform->mTransform));
-		Matrix2DConcat(&(pInst->mpComponent_Transform->mTransform), &trans, &rotate);
-		Matrix2DConcat(&(pInst->mpComponent_Transform->mTransform), &(pInst->mpComponent_Transform->mTransform), &scale);
+		Matrix2DIdentity(&(INST_TRANSFORM(pInst)->mTransform));
+		Matrix2DConcat(&(INST_TRANSFORM(pInst)->mTransform), &trans, &rotate);
+		Matrix2DConcat(&(INST_TRANSFORM(pInst)->mTransform), &(INST_TRANSFORM(pInst)->mTransform), &scale);
 
 
 
@@ -704,140 +1132,1447 @@ void GameStateAsteroidsUpdate(void)
 
 void GameStateAsteroidsDraw(void)
 {
-	unsigned long i;
-	double frameTime;
-
+	unsigned long i, num = 0;
 
-	AEGfxSetRenderMode(AE_GFX_RM_COLOR);
-	AEGfxTextureSet(NULL, 0, 0);
-	AEGfxSetTintColor(1.0f, 1.0f, 1.0f, 1.0f);
 
-	// draw all object instances in the list
+	RenderTraceFrame();
 
-	for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	// One texture for every sprite, set once: the queue only has to group by blend mode and mesh
+	if (sgpAtlasTexture)
 	{
-		GameObjectInstance* pInst = sgGameObjectInstanceList + i;
-
-		// skip non-active object
+		RenderTraceSetRenderMode(AE_GFX_RM_TEXTURE);
+		RenderTraceTextureSet(sgpAtlasTexture, 0, 0);
+	}
+	else
+	{
+		RenderTraceSetRenderMode(AE_GFX_RM_COLOR);
+		RenderTraceTextureSet(NULL, 0, 0);
+	}
+	RenderTraceSetTintColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+	// Every view draws the same bullet meshes
+	ProjectileMeshBuild(&sgProjectiles, BULLET_SIZE, BULLET_COLOR, sgpAtlasTexture ? sgAtlas.mRegions + sgAtlasRegionOfType[OBJECT_TYPE_BULLET] : 0);
+	memset(&sgDrawStats, 0, sizeof(sgDrawStats));
+
+	if (sgViewNum > 1)
+	{
+		GameStateAsteroidsDrawViews();
+		return;
+	}
+
+	// draw all object instances in the list, the queue orders them
+
+	for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	{
+		GameObjectInstance* pInst = sgGameObjectInstanceList + i;
+
+		// skip non-active object
 		if ((pInst->mFlag & FLAG_ACTIVE) == 0  || pInst==NULL)
 			continue;
-		
-		// Already implemented. Explanation:
-		// Step 1 & 2 are done outside the for loop (AEGfxSetRenderMode, AEGfxTextureSet, AEGfxSetTintColor) since all our objects share the same material.
-		// If you want to have objects with difference materials (Some with textures, some without, some with transparency etc...)
-		// then you'll need to move those functions calls inside the for loop
-		// 1 - Set Render Mode (Color or texture)
-		// 2 - Set all needed parameters (Color blend, textures, etc..)
-		// 3 - Set the current object instance's mTransform matrix using "AEGfxSetTransform"
-		// 4 - Draw the shape used by the current object instance using "AEGfxMeshDraw"
 
-		AEGfxSetTransform(pInst->mpComponent_Transform->mTransform.m);
-		AEGfxMeshDraw(pInst->mpComponent_Sprite->mpShape->mpMesh, AE_GFX_MDM_TRIANGLES);
+		sgDrawSlots[num++] = (unsigned short)i;
+	}
+
+	DrawListBuild(sgDrawSlots, num);
+	DrawListSubmit(DRAW_VIEW_ALL);
+}
+
+// ---------------------------------------------------------------------------
+
+void DrawListBuild(const unsigned short *pSlots, unsigned long Num)
+{
+	unsigned long k;
+	long life;
+
+	DrawQueueClear(&sgDrawQueue);
+
+	for (k = 0; k < Num; k++)
+	{
+		GameObjectInstance *pInst = sgGameObjectInstanceList + pSlots[k];
+		Shape *pShape = INST_SPRITE(pInst)->mpShape;
+		unsigned long mesh = (unsigned long)(pShape - sgShapes);
+
+		switch (pShape->mType)
+		{
+		case OBJECT_TYPE_ASTEROID:
+			DrawQueuePush(&sgDrawQueue, DRAW_KEY(DRAW_LAYER_ASTEROID, pInst->mSplitDepth, AE_GFX_BM_BLEND, mesh), pSlots[k]);
+			break;
+		case OBJECT_TYPE_SHIP:
+			DrawQueuePush(&sgDrawQueue, DRAW_KEY(DRAW_LAYER_SHIP, 0, AE_GFX_BM_BLEND, mesh), pSlots[k]);
+			break;
+		default:
+			DrawQueuePush(&sgDrawQueue, DRAW_KEY(DRAW_LAYER_BULLET, 0, AE_GFX_BM_BLEND, mesh), pSlots[k]);
+			break;
+		}
+	}
+
+	if (sgProjectiles.mMeshNum)
+		DrawQueuePush(&sgDrawQueue, DRAW_KEY(DRAW_LAYER_BULLET, 0, AE_GFX_BM_BLEND, DRAW_MESH_PROJECTILES), DRAW_ITEM_PROJECTILES);
+
+	for (life = 0; life < sgShipLives; life++)
+		DrawQueuePush(&sgDrawQueue, DRAW_KEY(DRAW_LAYER_HUD, 0, AE_GFX_BM_BLEND, sgPrefabs[OBJECT_TYPE_SHIP].mSprite.mpShape - sgShapes), DRAW_ITEM_LIFE + life);
+
+	DrawQueueSort(&sgDrawQueue);
+
+	sgDrawStats.mPassNum += sgDrawQueue.mStats.mPassNum;
+	sgDrawStats.mSortTime += sgDrawQueue.mStats.mSortTime;
+}
+
+// ---------------------------------------------------------------------------
+
+void DrawListSubmit(long View)
+{
+	DrawQueueSubmit(&sgDrawQueue, View == DRAW_VIEW_ALL ? 0 : DrawItemVisible, DrawItemSubmit, &View);
+
+	sgDrawStats.mItemNum += sgDrawQueue.mStats.mItemNum;
+	sgDrawStats.mBlendChangeNum += sgDrawQueue.mStats.mBlendChangeNum;
+	sgDrawStats.mMeshChangeNum += sgDrawQueue.mStats.mMeshChangeNum;
+}
+
+// ---------------------------------------------------------------------------
+
+int DrawItemVisible(unsigned long Item, void *pContext)
+{
+	long view = *(const long *)pContext;
+
+	// The bullet batch and the HUD are in every view
+	return Item >= GAME_OBJ_INST_NUM_MAX || (sgViewMasks[Item] >> view) & 1;
+}
+
+// ---------------------------------------------------------------------------
+
+void DrawItemSubmit(DrawKey Key, unsigned long Item, unsigned long Changes, void *pContext)
+{
+	if (Changes & DRAW_CHANGE_BLEND)
+		RenderTraceSetBlendMode(DRAW_KEY_BLEND(Key));
+
+	if (Item < GAME_OBJ_INST_NUM_MAX)
+	{
+		GameObjectInstance *pInst = sgGameObjectInstanceList + Item;
+
+		RenderTraceSetTransform(INST_TRANSFORM(pInst)->mTransform.m);
+		RenderTraceMeshDraw(INST_SPRITE(pInst)->mpShape->mpMesh, AE_GFX_MDM_TRIANGLES);
+	}
+	else if (Item == DRAW_ITEM_PROJECTILES)
+	{
+		ProjectileDraw(&sgProjectiles);
+	}
+	else
+	{
+		// Ships left, pointing up along the top of the current view
+		Matrix2D scale, rotate, trans, transform;
+		float x = AEGfxGetWinMinX() + HUD_LIFE_MARGIN * (float)(Item - DRAW_ITEM_LIFE + 1);
+
+		Matrix2DScale(&scale, HUD_LIFE_SIZE, HUD_LIFE_SIZE);
+		Matrix2DRotRad(&rotate, 0.5f * PI);
+		Matrix2DTranslate(&trans, x, AEGfxGetWinMaxY() - HUD_LIFE_MARGIN);
+		Matrix2DConcat(&transform, &trans, &rotate);
+		Matrix2DConcat(&transform, &transform, &scale);
+
+		RenderTraceSetTransform(transform.m);
+		RenderTraceMeshDraw(sgPrefabs[OBJECT_TYPE_SHIP].mSprite.mpShape->mpMesh, AE_GFX_MDM_TRIANGLES);
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void GameStateAsteroidsDrawViews(void)
+{
+	View views[VIEW_NUM_MAX];
+	float camX, camY;
+	unsigned long i, num = 0;
+	long v, target = 0;
+	RECT client;
+
+	AEGfxGetCamPosition(&camX, &camY);
+	GetClientRect(AESysGetWindowHandle(), &client);
+	ViewsLayout(views, sgViewNum, client.right - client.left, client.bottom - client.top);
+
+	// Every view rectangle up front. The engine reports the world edges for the current viewport and camera
+	for (v = 0; v < sgViewNum; v++)
+	{
+		Vector2D center = INST_TRANSFORM(sgpShip)->mPosition;
+
+		// The other views follow the first active asteroids, or stay on the ship if there are too few
+		if (v > 0)
+		{
+			for (; target < GAME_OBJ_INST_NUM_MAX; target++)
+			{
+				GameObjectInstance *pInst = sgGameObjectInstanceList + target;
+
+				if ((pInst->mFlag & FLAG_ACTIVE) && INST_SPRITE(pInst)->mpShape->mType == OBJECT_TYPE_ASTEROID)
+				{
+					center = INST_TRANSFORM(pInst)->mPosition;
+					target++;
+					break;
+				}
+			}
+		}
+
+		AEGfxSetViewportPositionAndDimensions(views[v].mX, views[v].mY, views[v].mWidth, views[v].mHeight);
+		AEGfxSetCamPosition(center.x, center.y);
+		ViewSetCamera(views + v, center.x, center.y, 0.5f * (AEGfxGetWinMaxX() - AEGfxGetWinMinX()), 0.5f * (AEGfxGetWinMaxY() - AEGfxGetWinMinY()));
+	}
+
+	// Spawns from the last flush are not in the bounds yet
+	GameObjectBoundsUpdate(0, GAME_OBJ_INST_NUM_MAX);
+	ViewsCull(views, sgViewNum, &sgBounds, GAME_OBJ_INST_NUM_MAX, sgViewMasks);
+
+	// The instances seen by any view are keyed and sorted once, each view walks them through its mask bit
+	for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+		if ((sgGameObjectInstanceList[i].mFlag & FLAG_ACTIVE) && sgViewMasks[i])
+			sgDrawSlots[num++] = (unsigned short)i;
+
+	DrawListBuild(sgDrawSlots, num);
+
+	for (v = 0; v < sgViewNum; v++)
+	{
+		RenderTraceSetViewport(views[v].mX, views[v].mY, views[v].mWidth, views[v].mHeight);
+		RenderTraceSetCamPosition(views[v].mCamX, views[v].mCamY);
+
+		DrawListSubmit(v);
+	}
+
+	// Back to the full window, Update reads the window edges
+	RenderTraceSetViewport(0, 0, client.right - client.left, client.bottom - client.top);
+	RenderTraceSetCamPosition(camX, camY);
+}
+
+// ---------------------------------------------------------------------------
+
+void QueryBenchmark(void)
+{
+	f64 start, handTime, queryTime;
+	float sumHand = 0.0f, sumQuery = 0.0f;
+	unsigned long r, i;
+
+	// Same work as the position update, summed instead of stored so the game is left untouched
+	AEGetTime(&start);
+	for (r = 0; r < QUERY_BENCHMARK_REPEAT; r++)
+	{
+		for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+		{
+			GameObjectInstance* pInst = sgGameObjectInstanceList + i;
+
+			if ((pInst->mFlag & FLAG_ACTIVE) == 0 || COMPONENT_INDEX_NONE == pInst->mTransform || COMPONENT_INDEX_NONE == pInst->mPhysics)
+				continue;
+
+			sumHand += INST_TRANSFORM(pInst)->mPosition.x + INST_PHYSICS(pInst)->mVelocity.x * 0.016f;
+		}
+	}
+	AEGetTime(&handTime);
+	handTime -= start;
+
+	AEGetTime(&start);
+	for (r = 0; r < QUERY_BENCHMARK_REPEAT; r++)
+	{
+		QUERY_EACH(&sgQuery, COMPONENT_TRANSFORM | COMPONENT_PHYSICS, k)
+		{
+			GameObjectInstance* pInst = sgGameObjectInstanceList + k;
+
+			sumQuery += INST_TRANSFORM(pInst)->mPosition.x + INST_PHYSICS(pInst)->mVelocity.x * 0.016f;
+		}
+	}
+	AEGetTime(&queryTime);
+	queryTime -= start;
+
+	StartupPrintf("Query: %lu instances x %d, hand written loop %.3f ms, QUERY_EACH %.3f ms (%f %f)\n",
+		sgGameObjectInstanceNum, QUERY_BENCHMARK_REPEAT, handTime * 1000.0, queryTime * 1000.0, sumHand, sumQuery);
+}
+
+// ---------------------------------------------------------------------------
+
+void FootprintReport(void)
+{
+	// The old layout: the 4 separately malloced components carry about two pointers of heap header each
+	unsigned long heapHeader = 2 * sizeof(void *);
+	unsigned long pointerInst = sizeof(FootprintPointerInstance);
+	unsigned long pointerComponents = sizeof(FootprintPointerSprite) + sizeof(FootprintPointerTransform)
+		+ sizeof(FootprintPointerPhysics) + sizeof(FootprintPointerTarget) + 4 * heapHeader;
+
+	// The index layout: the instance, the pool slots and one free list entry per pool
+	unsigned long indexInst = sizeof(GameObjectInstance);
+	unsigned long indexComponents = sizeof(Component_Sprite) + sizeof(Component_Transform)
+		+ sizeof(Component_Physics) + sizeof(Component_Target) + 4 * sizeof(unsigned long);
+
+	// The same with 32 bit indices, as past 64K entities
+	unsigned long wideInst = sizeof(FootprintWideInstance);
+	unsigned long wideComponents = sizeof(FootprintWideSprite) + sizeof(FootprintWideTransform)
+		+ sizeof(FootprintWidePhysics) + sizeof(FootprintWideTarget) + 4 * sizeof(unsigned long);
+
+	StartupPrintf("Footprint: instance %lu -> %lu bytes, with components %lu -> %lu bytes (%d bit indices)\n",
+		pointerInst, indexInst, pointerInst + pointerComponents, indexInst + indexComponents, (int)(8 * sizeof(ComponentIndex)));
+	StartupPrintf("Footprint: %d entities, pointers %.1f MB, 32 bit indices %.1f MB\n", FOOTPRINT_ENTITY_NUM,
+		(double)FOOTPRINT_ENTITY_NUM * (pointerInst + pointerComponents) / (1024.0 * 1024.0),
+		(double)FOOTPRINT_ENTITY_NUM * (wideInst + wideComponents) / (1024.0 * 1024.0));
+	StartupPrintf("Footprint: %lu instances, pools in use sprite %lu, transform %lu, physics %lu, target %lu of %d\n",
+		sgGameObjectInstanceNum, ComponentPoolUsedNum(&sgSpritePool), ComponentPoolUsedNum(&sgTransformPool),
+		ComponentPoolUsedNum(&sgPhysicsPool), ComponentPoolUsedNum(&sgTargetPool), GAME_OBJ_INST_NUM_MAX);
+}
+
+// ---------------------------------------------------------------------------
+
+void BulletFire(float Age, float FrameTime)
+{
+	Vector2D vel, pos;
+
+	// The ship has not moved this frame yet and the bullet is moved by this frame's projectile update:
+	// start from where the ship was at the press, plus the distance flown since, less that update's step
+	Vector2DSet(&vel, BULLET_SPEED * cosf(INST_TRANSFORM(sgpShip)->mAngle), BULLET_SPEED * sinf(INST_TRANSFORM(sgpShip)->mAngle));
+	Vector2DScaleAdd(&pos, &(INST_PHYSICS(sgpShip)->mVelocity), &(INST_TRANSFORM(sgpShip)->mPosition), FrameTime - Age);
+	Vector2DScaleAdd(&pos, &vel, &pos, Age - FrameTime);
+
+	ProjectileFire(&sgProjectiles, pos.x, pos.y, vel.x, vel.y);
+}
+
+// ---------------------------------------------------------------------------
+
+void EventsScoreUpdate(const Event *pEvents, unsigned long Num, void *pContext)
+{
+	sgScore += Num;
+}
+
+// ---------------------------------------------------------------------------
+
+void EventsShipHit(const Event *pEvents, unsigned long Num, void *pContext)
+{
+	sgShipHit = 1;
+}
+
+// ---------------------------------------------------------------------------
+
+void EventsStatusChanged(const Event *pEvents, unsigned long Num, void *pContext)
+{
+	sgStatusChanged = 1;
+}
+
+// ---------------------------------------------------------------------------
+
+void EventsApply(void)
+{
+	// Several hits in the same frame cost a single life, whatever runs they were dispatched in
+	if (sgShipHit)
+	{
+		Vector2DSet(&INST_TRANSFORM(sgpShip)->mPosition, sgpShipStartPos.x, sgpShipStartPos.y);
+		Vector2DSet(&INST_PHYSICS(sgpShip)->mVelocity, sgpShipStartPhys.x, sgpShipStartPhys.y);
+
+		if (sgShipLives > 0)
+			--sgShipLives;
+	}
+
+	// Formatted and written by the log thread, the lives are on the HUD
+	if (sgStatusChanged)
+	{
+		if (sgShipHit && sgShipLives == 0)
+			AsyncLogWrite("score %lu, no ship left\n", sgScore);
+		else
+			AsyncLogWrite("score %lu, ships left %ld\n", sgScore, sgShipLives);
+	}
+
+	sgShipHit = 0;
+	sgStatusChanged = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+void EventsLog(const Event *pEvents, unsigned long Num, void *pContext)
+{
+	unsigned long i;
+
+	// One record per event, formatted by the log thread
+	for (i = 0; i < Num; i++)
+	{
+		if (pEvents[i].mType == EVENT_ASTEROID_DESTROYED)
+			AsyncLogWrite("asteroid %lu destroyed at (%.1f, %.1f), split depth %u\n", pEvents[i].mInstance, pEvents[i].mX, pEvents[i].mY, (unsigned int)pEvents[i].mData);
+		else
+			AsyncLogWrite("ship hit by asteroid %lu at (%.1f, %.1f)\n", pEvents[i].mInstance, pEvents[i].mX, pEvents[i].mY);
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+int MissileBehavior(Behavior *pBehavior)
+{
+	GameObjectInstance* pInst = (GameObjectInstance *)pBehavior->mpOwner;
+	Component_Target* pTarget = INST_TARGET(pInst);
+
+	BEHAVIOR_BEGIN(pBehavior);
+
+	for (;;)
+	{
+		pTarget->mTarget = MissileTargetFind();
+		if (COMPONENT_INDEX_NONE != pTarget->mTarget)
+			pTarget->mGeneration = sgGameObjectInstanceList[pTarget->mTarget].mGeneration;
+
+		// Nothing to chase, look again a bit later
+		if (COMPONENT_INDEX_NONE == pTarget->mTarget)
+		{
+			BEHAVIOR_WAIT_SECONDS(pBehavior, MISSILE_RETARGET_DELAY);
+			continue;
+		}
+
+		// Chase until the target is destroyed. Its slot may already hold a fragment or a bullet, the generation tells
+		while (sgGameObjectInstanceList[pTarget->mTarget].mFlag == FLAG_ACTIVE
+			&& sgGameObjectInstanceList[pTarget->mTarget].mGeneration == pTarget->mGeneration)
+		{
+			MissileSteer(pInst, pBehavior->mDt);
+			BEHAVIOR_NEXT_FRAME(pBehavior);
+		}
+	}
+
+	BEHAVIOR_END(pBehavior);
+}
+
+// ---------------------------------------------------------------------------
+
+ComponentIndex MissileTargetFind(void)
+{
+	QUERY_EACH(&sgQuery, COMPONENT_TRANSFORM | COMPONENT_SPRITE, i)
+	{
+		if (INST_SPRITE(sgGameObjectInstanceList + i)->mpShape->mType == OBJECT_TYPE_ASTEROID)
+			return (ComponentIndex)i;
+	}
+
+	return COMPONENT_INDEX_NONE;
+}
+
+// ---------------------------------------------------------------------------
+
+void MissileSteer(GameObjectInstance *pInst, float Dt)
+{
+	Vector2D mVel, normal, asteroidVec;
+	GameObjectInstance* pTarget = sgGameObjectInstanceList + INST_TARGET(pInst)->mTarget;
+
+	Vector2DSet(&mVel, INST_PHYSICS(pInst)->mVelocity.x, INST_PHYSICS(pInst)->mVelocity.y);
+	Vector2DSet(&normal, -1 * mVel.y, mVel.x);
+	Vector2DSet(&asteroidVec, (INST_TRANSFORM(pTarget)->mPosition.x) - (INST_TRANSFORM(pInst)->mPosition.x), (INST_TRANSFORM(pTarget)->mPosition.y) - (INST_TRANSFORM(pInst)->mPosition.y));
+
+	float angle = (mVel.x * asteroidVec.x + mVel.y * asteroidVec.y) / (Vector2DLength(&mVel) * Vector2DLength(&asteroidVec));  //May need to turn to radians, check disssss
+	float a = min(HOMING_MISSILE_ROT_SPEED * Dt, acosf(angle ));
+
+	if (normal.x * asteroidVec.x + normal.y * asteroidVec.y < 0)
+	{
+		a = -a;
+	}
+
+	float curAngle =	INST_TRANSFORM(pInst)->mAngle + a;
+	INST_TRANSFORM(pInst)->mAngle += a;
+	Vector2DSet(&(INST_PHYSICS(pInst)->mVelocity), cosf(curAngle), sinf(curAngle));
+	Vector2DNormalize(&(INST_PHYSICS(pInst)->mVelocity), &(INST_PHYSICS(pInst)->mVelocity));
+	Vector2DScale(&(INST_PHYSICS(pInst)->mVelocity), &(INST_PHYSICS(pInst)->mVelocity), MISSILE_SPEED, MISSILE_SPEED);
+}
+
+// ---------------------------------------------------------------------------
+
+void GameStateAsteroidsFree(void)
+{
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// TO DO 12:
+	//  -- Destroy all the active game object instances, using the “GameObjInstanceDestroy” function.
+	//  -- Reset the number of active game objects instances
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+
+	// The instances own nothing outside the pools, so they all go at once instead of one destroy each
+	GameObjectAccountingCheck();
+	GameObjectInstancesReset();
+}
+
+// ---------------------------------------------------------------------------
+
+void GameStateAsteroidsUnload(void)
+{
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	// TO DO 13:
+	//  -- Destroy all the shapes, using the “AEGfxMeshFree” function.
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////////////////
+	for (int i = 0; i < sgShapeNum; i++)  //CHECK - might be <= instead of <
+	{
+		AEGfxMeshFree(sgShapes[i].mpMesh);
+	}
+	RenderTraceMeshClear();
+
+	if (sgpAtlasTexture)
+		AEGfxTextureUnload(sgpAtlasTexture);
+	sgpAtlasTexture = 0;
+	RenderTraceTextureClear();
+	AtlasFree(&sgAtlas);
+
+	CommandQueueFree(&sgCommandQueue);
+	InputQueueStop();
+	AsyncLogFree();
+	BarnesHutFree(&sgGravityTree);
+	BoundsCacheFree(&sgBounds);
+	AssetPackClose(&sgAssetPack);
+	WorldFree(&sgWorld);
+	sgWorldMode = 0;
+	QueryFree(&sgQuery);
+	ComponentPoolFree(&sgSpritePool);
+	ComponentPoolFree(&sgTransformPool);
+	ComponentPoolFree(&sgPhysicsPool);
+	ComponentPoolFree(&sgTargetPool);
+	ProjectileSystemFree(&sgProjectiles);
+	IslandSolverFree(&sgIslands);
+	SubstepBatchesFree(&sgSubsteps);
+	DrawQueueFree(&sgDrawQueue);
+	BehaviorSchedulerFree(&sgBehaviors);
+	EventBusFree(&sgEvents);
+
+}
+
+// ---------------------------------------------------------------------------
+
+void GameObjectInstancesReset(void)
+{
+	unsigned long i;
+
+	memset(sgGameObjectInstanceList, 0, sizeof(GameObjectInstance) * GAME_OBJ_INST_NUM_MAX);
+	sgGameObjectInstanceNum = 0;
+	sgFreedSlotNum = 0;
+
+	// Every slot is free again, publish them all so direct creation and spawners both reserve from the queue
+	for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+		sgFreeHandles[i] = i;
+	CommandQueueReset(&sgCommandQueue, sgFreeHandles, GAME_OBJ_INST_NUM_MAX);
+
+	ComponentPoolClear(&sgSpritePool);
+	ComponentPoolClear(&sgTransformPool);
+	ComponentPoolClear(&sgPhysicsPool);
+	ComponentPoolClear(&sgTargetPool);
+	QueryClear(&sgQuery);
+	BehaviorSchedulerClear(&sgBehaviors);
+	ProjectileSystemClear(&sgProjectiles);
+	IslandSolverClear(&sgIslands);
+}
+
+// ---------------------------------------------------------------------------
+
+void GameObjectAccountingCheck(void)
+{
+	unsigned long queryNum = 0, targetNum = 0, behaviorNum = 0, signature, i;
+
+	// Every live instance holds one entry in the query, a sprite, a transform and a physics component
+	for (signature = 0; signature < QUERY_SIGNATURE_NUM; signature++)
+	{
+		queryNum += sgQuery.mBucketNum[signature];
+		if (signature & COMPONENT_TARGET)
+			targetNum += sgQuery.mBucketNum[signature];
+	}
+
+	// Stopped behaviors keep their frame until the scheduler visits them, only count the running ones
+	for (i = 0; i < sgBehaviors.mActiveNum; i++)
+		if (sgBehaviors.mpBehaviors[sgBehaviors.mpActive[i]].mpFunc)
+			behaviorNum++;
+
+	AE_WARNING_MESG(queryNum == sgGameObjectInstanceNum, "%lu query entries for %lu instances", queryNum, sgGameObjectInstanceNum);
+	AE_WARNING_MESG(ComponentPoolUsedNum(&sgSpritePool) == sgGameObjectInstanceNum, "%lu sprites leaked", ComponentPoolUsedNum(&sgSpritePool) - sgGameObjectInstanceNum);
+	AE_WARNING_MESG(ComponentPoolUsedNum(&sgTransformPool) == sgGameObjectInstanceNum, "%lu transforms leaked", ComponentPoolUsedNum(&sgTransformPool) - sgGameObjectInstanceNum);
+	AE_WARNING_MESG(ComponentPoolUsedNum(&sgPhysicsPool) == sgGameObjectInstanceNum, "%lu physics leaked", ComponentPoolUsedNum(&sgPhysicsPool) - sgGameObjectInstanceNum);
+	AE_WARNING_MESG(ComponentPoolUsedNum(&sgTargetPool) == targetNum, "%lu targets leaked", ComponentPoolUsedNum(&sgTargetPool) - targetNum);
+	AE_WARNING_MESG(behaviorNum <= targetNum, "%lu behaviors running for %lu scripted instances", behaviorNum, targetNum);
+
+	AsyncLogWrite("teardown: %lu instances, %lu targets, %lu behaviors, %lu bullets\n", sgGameObjectInstanceNum, targetNum, behaviorNum, sgProjectiles.mLiveNum);
+}
+
+// ---------------------------------------------------------------------------
+
+GameObjectInstance* GameObjectInstanceCreate(unsigned int ObjectType)			// From OBJECT_TYPE enum)
+{
+	GameObjectInstance* pInst;
+
+	// Cannot find empty slot => return 0
+	if (0 == GameObjectInstanceCreateBatch(ObjectType, 1, &pInst))
+		return 0;
+
+	// return the newly created instance
+	return pInst;
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned long GameObjectInstanceCreateBatch(unsigned int ObjectType, unsigned long Count, GameObjectInstance **ppInstances)
+{
+	unsigned long created = 0;
+
+	// Slots freed since the last flush first, the last freed first: they were never published, no spawner can hold them
+	while (created < Count && sgFreedSlotNum > 0)
+	{
+		GameObjectInstance* pInst = sgGameObjectInstanceList + sgFreedSlots[--sgFreedSlotNum];
+
+		AE_ASSERT(pInst->mFlag == 0);
+		GameObjectInstanceInit(pInst, ObjectType);
+		ppInstances[created++] = pInst;
+	}
+
+	// Then the published free slots, reserved like a spawn command's handle so the two never hand out the same slot
+	while (created < Count)
+	{
+		unsigned long handle = CommandQueueReserveHandle(&sgCommandQueue);
+		GameObjectInstance* pInst;
+
+		// Cannot find empty slot
+		if (handle == COMMAND_HANDLE_INVALID)
+			break;
+
+		pInst = sgGameObjectInstanceList + handle;
+		AE_ASSERT(pInst->mFlag == 0);
+		GameObjectInstanceInit(pInst, ObjectType);
+		ppInstances[created++] = pInst;
+	}
+
+	return created;
+}
+
+// ---------------------------------------------------------------------------
+
+void GameObjectInstanceInit(GameObjectInstance* pInst, unsigned int ObjectType)
+{
+	Prefab *pPrefab = sgPrefabs + ObjectType;
+
+	// Active the game object instance
+	pInst->mFlag = FLAG_ACTIVE;
+	pInst->mSplitDepth = 0;
+
+	// Copy the components from the object type's prefab. There is one pool slot per instance slot, they cannot run out
+	pInst->mSprite = (ComponentIndex)ComponentPoolAlloc(&sgSpritePool);
+	pInst->mTransform = (ComponentIndex)ComponentPoolAlloc(&sgTransformPool);
+	pInst->mPhysics = (ComponentIndex)ComponentPoolAlloc(&sgPhysicsPool);
+	pInst->mTarget = pPrefab->mHasTarget ? (ComponentIndex)ComponentPoolAlloc(&sgTargetPool) : COMPONENT_INDEX_NONE;
+
+	*INST_SPRITE(pInst) = pPrefab->mSprite;
+	*INST_TRANSFORM(pInst) = pPrefab->mTransform;
+	*INST_PHYSICS(pInst) = pPrefab->mPhysics;
+
+	INST_SPRITE(pInst)->mOwner = (ComponentIndex)(pInst - sgGameObjectInstanceList);
+	INST_TRANSFORM(pInst)->mOwner = (ComponentIndex)(pInst - sgGameObjectInstanceList);
+	INST_PHYSICS(pInst)->mOwner = (ComponentIndex)(pInst - sgGameObjectInstanceList);
+
+	if (pInst->mTarget != COMPONENT_INDEX_NONE)
+	{
+		*INST_TARGET(pInst) = pPrefab->mTarget;
+		INST_TARGET(pInst)->mOwner = (ComponentIndex)(pInst - sgGameObjectInstanceList);
+	}
+
+	QueryAdd(&sgQuery, pInst - sgGameObjectInstanceList, COMPONENT_TRANSFORM | COMPONENT_SPRITE | COMPONENT_PHYSICS | (pInst->mTarget != COMPONENT_INDEX_NONE ? COMPONENT_TARGET : 0));
+
+	pInst->mBehavior = COMPONENT_INDEX_NONE;
+	if (pPrefab->mpBehavior)
+	{
+		Behavior *pBehavior = BehaviorStart(&sgBehaviors, pPrefab->mpBehavior, pInst);
+
+		if (pBehavior)
+			pInst->mBehavior = (ComponentIndex)(pBehavior - sgBehaviors.mpBehaviors);
+	}
+
+	if (ObjectType == OBJECT_TYPE_SHIP)
+	{
+		Vector2DSet(&sgpShipStartPos, INST_TRANSFORM(pInst)->mPosition.x, INST_TRANSFORM(pInst)->mPosition.y);
+		Vector2DSet(&sgpShipStartPhys, INST_PHYSICS(pInst)->mVelocity.x, INST_PHYSICS(pInst)->mVelocity.y);
+	}
+
+	++sgGameObjectInstanceNum;
+}
+
+// ---------------------------------------------------------------------------
+
+void ShapeMeshCreate(Shape *pShape, const MeshVertex *pVertices, unsigned long VertexNum, const unsigned short *pIndices, unsigned long IndexNum)
+{
+	unsigned long i;
+
+	for (i = 0; i < VertexNum; i++)
+		ShapeBoundsAdd(pShape, pVertices[i].mX, pVertices[i].mY);
+
+	pShape->mpMesh = ShapeMeshBuild(pShape, pVertices, VertexNum, pIndices, IndexNum);
+}
+
+// ---------------------------------------------------------------------------
+
+AEGfxVertexList* ShapeMeshBuild(const Shape *pShape, const MeshVertex *pVertices, unsigned long VertexNum, const unsigned short *pIndices, unsigned long IndexNum)
+{
+	static MeshVertex vertices[SHAPE_VERTEX_MAX];
+
+	// Too big for the scratch copy: drawn untextured, with its vertex colors only
+	AE_WARNING_MESG(VertexNum <= SHAPE_VERTEX_MAX, "Shape of %lu vertices, SHAPE_VERTEX_MAX is %d", VertexNum, SHAPE_VERTEX_MAX);
+
+	if (!sgpAtlasTexture || pShape->mType >= OBJECT_TYPE_NUM || VertexNum > SHAPE_VERTEX_MAX)
+		return RenderTraceMeshCreate(pVertices, VertexNum, pIndices, IndexNum);
+
+	// The normalized shape square covers its type's region, whatever the outline inside it
+	memcpy(vertices, pVertices, VertexNum * sizeof(MeshVertex));
+	AtlasRegionMap(sgAtlas.mRegions + sgAtlasRegionOfType[pShape->mType], vertices, VertexNum);
+
+	return RenderTraceMeshCreate(vertices, VertexNum, pIndices, IndexNum);
+}
+
+// ---------------------------------------------------------------------------
+
+void ShapeBoundsAdd(Shape *pShape, float x, float y)
+{
+	float radius = sqrtf(x * x + y * y);
+
+	if (pShape->mVertexNum++ == 0)
+	{
+		pShape->mLocalMinX = pShape->mLocalMaxX = x;
+		pShape->mLocalMinY = pShape->mLocalMaxY = y;
+		pShape->mLocalRadius = radius;
+		return;
+	}
+
+	pShape->mLocalMinX = min(pShape->mLocalMinX, x);
+	pShape->mLocalMaxX = max(pShape->mLocalMaxX, x);
+	pShape->mLocalMinY = min(pShape->mLocalMinY, y);
+	pShape->mLocalMaxY = max(pShape->mLocalMaxY, y);
+	pShape->mLocalRadius = max(pShape->mLocalRadius, radius);
+}
+
+// ---------------------------------------------------------------------------
+
+void ShapesLoad(void)
+{
+	const AssetPackShape *pDescs = sgBuiltinShapes;
+	const MeshVertex *pVertices = sgBuiltinVertices;
+	const unsigned short *pIndices = sgBuiltinIndices;
+	unsigned long i, shapeNum = BUILTIN_SHAPE_NUM;
+	int packed;
+	f64 start, end;
+
+	// Cold start: open + mesh creation, compare with and without the pack
+	AEGetTime(&start);
+
+	// A pack failing its checks is closed, the built in tables are used instead
+	packed = AssetPackOpen(&sgAssetPack, ASSET_PACK_FILE, OBJECT_TYPE_NUM);
+
+	if (packed)
+	{
+		pDescs = sgAssetPack.mpShapes;
+		pVertices = sgAssetPack.mpVertices;
+		pIndices = sgAssetPack.mpIndices;
+		shapeNum = min(sgAssetPack.mpHeader->mShapeNum, SHAPE_NUM_MAX);
+
+		sgpWaves = sgAssetPack.mpWaves;
+		sgpSpawns = sgAssetPack.mpSpawns;
+		sgWaveNum = sgAssetPack.mpHeader->mWaveNum;
+	}
+	else
+	{
+		sgpWaves = sgBuiltinWaves;
+		sgpSpawns = sgBuiltinSpawns;
+		sgWaveNum = BUILTIN_WAVE_NUM;
+	}
+
+	for (i = 0; i < shapeNum; i++)
+	{
+		const AssetPackShape *pDesc = pDescs + i;
+		const unsigned short *pShapeIndices = pDesc->mIndexNum ? pIndices + pDesc->mIndexFirst : NULL;
+		Shape *pShape = sgShapes + sgShapeNum++;
+
+		pShape->mType = pDesc->mType;
+
+		if (packed)
+		{
+			// Ranges and indices were checked by AssetPackOpen, bounds were computed by the packer
+			pShape->mVertexNum = pDesc->mVertexNum;
+			pShape->mLocalMinX = pDesc->mLocalMinX;
+			pShape->mLocalMinY = pDesc->mLocalMinY;
+			pShape->mLocalMaxX = pDesc->mLocalMaxX;
+			pShape->mLocalMaxY = pDesc->mLocalMaxY;
+			pShape->mLocalRadius = pDesc->mLocalRadius;
+			pShape->mpMesh = ShapeMeshBuild(pShape, pVertices + pDesc->mVertexFirst, pDesc->mVertexNum, pShapeIndices, pDesc->mIndexNum);
+		}
+		else
+			ShapeMeshCreate(pShape, pVertices + pDesc->mVertexFirst, pDesc->mVertexNum, pShapeIndices, pDesc->mIndexNum);
+	}
+
+	AEGetTime(&end);
+
+	StartupPrintf("Shapes: %lu loaded from %s in %.3f ms\n", shapeNum, packed ? ASSET_PACK_FILE : "built in data", (end - start) * 1000.0);
+}
+
+// ---------------------------------------------------------------------------
+
+void SpritesAtlasBuild(void)
+{
+	AtlasImage images[OBJECT_TYPE_NUM];
+	long i;
+	f64 start, end;
+
+	AEGetTime(&start);
+
+	// Region i is object type i. Painted here since the game ships no image files
+	AtlasImagePaint(images + OBJECT_TYPE_SHIP, 64, 64, ATLAS_PAINT_HULL, ATLAS_SEED);
+	AtlasImagePaint(images + OBJECT_TYPE_BULLET, 16, 16, ATLAS_PAINT_GLOW, ATLAS_SEED + 1);
+	AtlasImagePaint(images + OBJECT_TYPE_ASTEROID, 128, 128, ATLAS_PAINT_ROCK, ATLAS_SEED + 2);
+	AtlasImagePaint(images + OBJECT_TYPE_HOMING_MISSILE, 32, 32, ATLAS_PAINT_HULL, ATLAS_SEED + 3);
+
+	sgpAtlasTexture = 0;
+	if (AtlasBuild(&sgAtlas, images, OBJECT_TYPE_NUM, ATLAS_SIZE_MAX))
+		sgpAtlasTexture = RenderTraceTextureCreate(sgAtlas.mpPixels, sgAtlas.mWidth, sgAtlas.mHeight);
+
+	for (i = 0; i < OBJECT_TYPE_NUM; i++)
+	{
+		sgAtlasRegionOfType[i] = i;
+		AtlasImageFree(images + i);
+	}
+
+	AEGetTime(&end);
+
+	AE_WARNING_MESG(sgpAtlasTexture, "Sprite atlas could not be created, drawing flat colors");
+	StartupPrintf("Atlas: %ld sprites in %ldx%ld in %.3f ms\n", sgAtlas.mRegionNum, sgAtlas.mWidth, sgAtlas.mHeight, (end - start) * 1000.0);
+}
+
+// ---------------------------------------------------------------------------
+
+void WaveSpawn(unsigned long Wave)
+{
+	unsigned long i;
+
+	if (Wave >= sgWaveNum)
+		return;
+
+	for (i = 0; i < sgpWaves[Wave].mSpawnNum; i++)
+	{
+		const AssetPackSpawn *pSpawn = sgpSpawns + sgpWaves[Wave].mSpawnFirst + i;
+		GameObjectInstance *pInst = GameObjectInstanceCreate(pSpawn->mObjectType);
+
+		if (0 == pInst)
+			return;
+
+		Vector2DSet(&(INST_TRANSFORM(pInst)->mPosition), pSpawn->mPosX, pSpawn->mPosY);
+		Vector2DSet(&(INST_PHYSICS(pInst)->mVelocity), pSpawn->mVelX, pSpawn->mVelY);
+		INST_TRANSFORM(pInst)->mScaleX *= pSpawn->mScale;
+		INST_TRANSFORM(pInst)->mScaleY *= pSpawn->mScale;
+
+		if (pSpawn->mObjectType == OBJECT_TYPE_ASTEROID)
+			AsteroidVariantAssign(pInst);
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void AsteroidVariantsBuild(void)
+{
+	MeshVertex vertices[ASTEROID_OUTLINE_POINT_MAX + 1];
+	unsigned short indices[3 * ASTEROID_OUTLINE_POINT_MAX];
+	unsigned long c, v;
+
+	memset(sgpAsteroidVariants, 0, sizeof(sgpAsteroidVariants));
+
+	for (c = 0; c < ASTEROID_CLASS_NUM; c++)
+	{
+		// Bigger rocks get more detail
+		unsigned long pointNum = 8 + 4 * c;
+
+		for (v = 0; v < ASTEROID_VARIANT_NUM && sgShapeNum < SHAPE_NUM_MAX; v++)
+		{
+			Shape *pShape = sgShapes + sgShapeNum++;
+			unsigned long indexNum = AsteroidOutlineGenerate(ASTEROID_OUTLINE_SEED + c * ASTEROID_VARIANT_NUM + v, pointNum, ASTEROID_OUTLINE_ROUGHNESS, 0xFFFFFF00, vertices, indices);
+
+			pShape->mType = OBJECT_TYPE_ASTEROID;
+			ShapeMeshCreate(pShape, vertices, pointNum + 1, indices, indexNum);
+			sgpAsteroidVariants[c][v] = pShape;
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void AsteroidVariantAssign(GameObjectInstance *pInst)
+{
+	Component_Transform *pTransform = INST_TRANSFORM(pInst);
+	unsigned long sizeClass, variant = RandomU32(&sgRandomVariant) % ASTEROID_VARIANT_NUM;
+
+	// Wave asteroids are 1x to 3x ASTEROID_SIZE, fragments halve from there
+	if (pTransform->mScaleX < ASTEROID_SIZE)
+		sizeClass = 0;
+	else if (pTransform->mScaleX < 2.0f * ASTEROID_SIZE)
+		sizeClass = 1;
+	else
+		sizeClass = 2;
+
+	// Without the variant, the instance keeps the prefab's square
+	if (sgpAsteroidVariants[sizeClass][variant])
+		INST_SPRITE(pInst)->mpShape = sgpAsteroidVariants[sizeClass][variant];
+}
+
+// ---------------------------------------------------------------------------
+
+void GameObjectBoundsUpdate(long Start, long Count)
+{
+	long i;
+
+	for (i = Start; i < Start + Count; i++)
+	{
+		GameObjectInstance* pInst = sgGameObjectInstanceList + i;
+		Component_Transform *pTransform;
+		Shape *pShape;
+
+		// Inactive slots get a zero size box at their last position. ViewsCull and the overlap
+		// tests still read it, every caller skips inactive slots by their flag
+		if ((pInst->mFlag & FLAG_ACTIVE) == 0)
+		{
+			sgBounds.mpScaleX[i] = sgBounds.mpScaleY[i] = 0.0f;
+			continue;
+		}
+
+		pTransform = INST_TRANSFORM(pInst);
+		pShape = INST_SPRITE(pInst)->mpShape;
+
+		sgBounds.mpPosX[i] = pTransform->mPosition.x;
+		sgBounds.mpPosY[i] = pTransform->mPosition.y;
+		sgBounds.mpCos[i] = cosf(pTransform->mAngle);
+		sgBounds.mpSin[i] = sinf(pTransform->mAngle);
+		sgBounds.mpScaleX[i] = pTransform->mScaleX;
+		sgBounds.mpScaleY[i] = pTransform->mScaleY;
+		sgBounds.mpLocalCenterX[i] = 0.5f * (pShape->mLocalMinX + pShape->mLocalMaxX);
+		sgBounds.mpLocalCenterY[i] = 0.5f * (pShape->mLocalMinY + pShape->mLocalMaxY);
+		sgBounds.mpLocalHalfX[i] = 0.5f * (pShape->mLocalMaxX - pShape->mLocalMinX);
+		sgBounds.mpLocalHalfY[i] = 0.5f * (pShape->mLocalMaxY - pShape->mLocalMinY);
+		sgBounds.mpLocalRadius[i] = pShape->mLocalRadius;
 	}
+
+	BoundsCacheCompute(&sgBounds, Start, Count);
 }
 
 // ---------------------------------------------------------------------------
 
-void GameStateAsteroidsFree(void)
+void PrefabsBuild(void)
 {
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	// TO DO 12:
-	//  -- Destroy all the active game object instances, using the “GameObjInstanceDestroy” function.
-	//  -- Reset the number of active game objects instances
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////////////////
+	unsigned long i;
+
+	memset(sgPrefabs, 0, sizeof(Prefab) * OBJECT_TYPE_NUM);
+
+	for (i = 0; i < OBJECT_TYPE_NUM; i++)
+		Matrix2DIdentity(&sgPrefabs[i].mTransform.mTransform);
+
+	// The pack may list its shapes in any order
+	for (i = sgShapeNum; i-- > 0;)
+		if (sgShapes[i].mType < OBJECT_TYPE_NUM)
+			sgPrefabs[sgShapes[i].mType].mSprite.mpShape = sgShapes + i;
+
+	sgPrefabs[OBJECT_TYPE_SHIP].mTransform.mScaleX = SHIP_SIZE;			//Initial scale is 1, setting it to predefined SHIP_SIZE
+	sgPrefabs[OBJECT_TYPE_SHIP].mTransform.mScaleY = SHIP_SIZE;
+	sgPrefabs[OBJECT_TYPE_BULLET].mTransform.mScaleX = BULLET_SIZE;
+	sgPrefabs[OBJECT_TYPE_BULLET].mTransform.mScaleY = BULLET_SIZE;
+	sgPrefabs[OBJECT_TYPE_ASTEROID].mTransform.mScaleX = ASTEROID_SIZE;
+	sgPrefabs[OBJECT_TYPE_ASTEROID].mTransform.mScaleY = ASTEROID_SIZE;
+	sgPrefabs[OBJECT_TYPE_HOMING_MISSILE].mTransform.mScaleX = MISSILE_WIDTH;
+	sgPrefabs[OBJECT_TYPE_HOMING_MISSILE].mTransform.mScaleY = MISSILE_HEIGHT;
+	sgPrefabs[OBJECT_TYPE_HOMING_MISSILE].mHasTarget = 1;
+	sgPrefabs[OBJECT_TYPE_HOMING_MISSILE].mTarget.mTarget = COMPONENT_INDEX_NONE;
+	sgPrefabs[OBJECT_TYPE_HOMING_MISSILE].mpBehavior = MissileBehavior;
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned long AsteroidFragment(GameObjectInstance *pAsteroid, unsigned long MaxDepth, GameObjectInstance **ppFragments)
+{
+	Component_Transform *pTransform = INST_TRANSFORM(pAsteroid);
+	Vector2D position = pTransform->mPosition;
+	Vector2D velocity = INST_PHYSICS(pAsteroid)->mVelocity;
+	float scaleX = pTransform->mScaleX * ASTEROID_FRAGMENT_SCALE;
+	float scaleY = pTransform->mScaleY * ASTEROID_FRAGMENT_SCALE;
+	unsigned long depth = pAsteroid->mSplitDepth + 1;
+	unsigned long num, k;
+	float offset;
+
+	// Free the parent first, so its slot is the first one the fragments reuse
+	GameObjectInstanceDestroy(pAsteroid);
 
-	for (int i = 0; sgGameObjectInstanceNum > 0 && i < GAME_OBJ_INST_NUM_MAX &&  sgGameObjectInstanceList[i].mFlag == FLAG_ACTIVE ; i++)
+	if (depth > MaxDepth)
+		return 0;
+
+	num = GameObjectInstanceCreateBatch(OBJECT_TYPE_ASTEROID, ASTEROID_FRAGMENT_NUM, ppFragments);
+
+	// Spread the fragments evenly around a random direction
+	offset = RandomFloat(&sgRandomFragment) * TWO_PI;
+
+	for (k = 0; k < num; k++)
 	{
-		GameObjectInstanceDestroy(&(sgGameObjectInstanceList[i]));
+		GameObjectInstance *pFragment = ppFragments[k];
+		float angle = offset + (TWO_PI * k) / num;
+		float speed = ASTEROID_FRAGMENT_SPEED * (1.0f + ASTEROID_FRAGMENT_JITTER * (RandomFloat(&sgRandomFragment) - 0.5f));
+		Vector2D dir;
+
+		pFragment->mSplitDepth = depth;
+		INST_TRANSFORM(pFragment)->mPosition = position;
+		INST_TRANSFORM(pFragment)->mAngle = angle;
+		INST_TRANSFORM(pFragment)->mScaleX = scaleX;
+		INST_TRANSFORM(pFragment)->mScaleY = scaleY;
+		AsteroidVariantAssign(pFragment);
+
+		Vector2DFromAngleRad(&dir, angle);
+		Vector2DScaleAdd(&INST_PHYSICS(pFragment)->mVelocity, &dir, &velocity, speed);
 	}
 
+	return num;
+}
+
+// ---------------------------------------------------------------------------
+
+void AsteroidFragmentStressTest(void)
+{
+	static GameObjectInstance *sFrontier[2][ASTEROID_FRAGMENT_STRESS_NUM];
+	unsigned long frontierNum, nextNum, created = 0, depth = 0, i;
+	unsigned long instanceNum = sgGameObjectInstanceNum;
+	GameObjectInstance **ppCurr = sFrontier[0], **ppNext = sFrontier[1];
+	f64 start, end, time;
+
+	AEGetTime(&start);
+
+	ppCurr[0] = GameObjectInstanceCreate(OBJECT_TYPE_ASTEROID);
+	if (0 == ppCurr[0])
+		return;
+	INST_TRANSFORM(ppCurr[0])->mScaleX *= 8.0f;
+	INST_TRANSFORM(ppCurr[0])->mScaleY *= 8.0f;
+	frontierNum = 1;
+
+	// Split the whole frontier, level by level, until enough fragments exist
+	while (frontierNum > 0 && created < ASTEROID_FRAGMENT_STRESS_NUM)
+	{
+		++depth;
+		nextNum = 0;
+
+		for (i = 0; i < frontierNum && created + ASTEROID_FRAGMENT_NUM <= ASTEROID_FRAGMENT_STRESS_NUM; i++)
+		{
+			unsigned long num = AsteroidFragment(ppCurr[i], depth, ppNext + nextNum);
+			nextNum += num;
+			created += num;
+		}
+
+		ppCurr = sFrontier[depth & 1];
+		ppNext = sFrontier[(depth + 1) & 1];
+		frontierNum = nextNum;
+	}
 
+	AEGetTime(&end);
+	time = (end - start) * 1000.0;
 
+	// Every split parent is gone, the live fragments are what the cascade added to the pool
+	StartupPrintf("Fragment cascade: %lu fragments created, %lu live, depth %lu, %.3f ms (budget %.1f ms)%s\n",
+		created, sgGameObjectInstanceNum - instanceNum, depth, time, ASTEROID_FRAGMENT_STRESS_BUDGET,
+		time > ASTEROID_FRAGMENT_STRESS_BUDGET ? " OVER BUDGET" : "");
+	AE_WARNING_MESG(time <= ASTEROID_FRAGMENT_STRESS_BUDGET, "Fragment cascade took %.3f ms, over its %.1f ms budget", time, ASTEROID_FRAGMENT_STRESS_BUDGET);
 }
 
 // ---------------------------------------------------------------------------
 
-void GameStateAsteroidsUnload(void)
+void GameObjectCommandsFlush(void)
 {
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	// TO DO 13:
-	//  -- Destroy all the shapes, using the “AEGfxMeshFree” function.
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	for (int i = 0; i < sgShapeNum; i++)  //CHECK - might be <= instead of <
+	long commandNum = CommandQueuePendingNum(&sgCommandQueue);
+	long freeNum = 0;
+	long i;
+
+	for (i = 0; i < commandNum; i++)
 	{
-		AEGfxMeshFree(sgShapes[i].mpMesh);
+		Command *pCommand = sgCommandQueue.mpCommands + i;
+		GameObjectInstance *pInst = sgGameObjectInstanceList + pCommand->mHandle;
+
+		// A despawn pushed before its instance was destroyed must not kill the one now in the slot
+		if (pCommand->mType == COMMAND_DESPAWN)
+		{
+			if (pInst->mGeneration == (unsigned short)pCommand->mGeneration)
+				GameObjectInstanceDestroy(pInst);
+			continue;
+		}
+
+		// The handle was reserved from the free list, so the slot cannot be in use
+		AE_ASSERT(pInst->mFlag == 0);
+
+		GameObjectInstanceInit(pInst, pCommand->mObjectType);
+		INST_TRANSFORM(pInst)->mPosition = pCommand->mPosition;
+		INST_TRANSFORM(pInst)->mAngle = pCommand->mAngle;
+		INST_TRANSFORM(pInst)->mScaleX *= pCommand->mScale;
+		INST_TRANSFORM(pInst)->mScaleY *= pCommand->mScale;
+		INST_PHYSICS(pInst)->mVelocity = pCommand->mVelocity;
+
+		if (pCommand->mObjectType == OBJECT_TYPE_ASTEROID)
+			AsteroidVariantAssign(pInst);
+	}
+
+	// Gather every free slot in one pass; producers hand them out next frame
+	for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	{
+		if (sgGameObjectInstanceList[i].mFlag == 0)
+			sgFreeHandles[freeNum++] = i;
 	}
 
+	CommandQueueReset(&sgCommandQueue, sgFreeHandles, freeNum);
+	sgFreedSlotNum = 0;
 }
 
 // ---------------------------------------------------------------------------
 
-GameObjectInstance* GameObjectInstanceCreate(unsigned int ObjectType)			// From OBJECT_TYPE enum)
+void GravityApply(float dt)
 {
-	unsigned long i;
-	
-	// loop through the object instance list to find a non-used object instance
+	long bodyNum = 0, queryNum = 0, bulletNum = 0, i;
+	unsigned long c;
+
+	for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	{
+		GameObjectInstance* pInst = sgGameObjectInstanceList + i;
+		Component_Transform *pTransform;
+
+		if ((pInst->mFlag & FLAG_ACTIVE) == 0 || pInst == sgpShip)
+			continue;
+
+		pTransform = INST_TRANSFORM(pInst);
+
+		if (INST_SPRITE(pInst)->mpShape->mType == OBJECT_TYPE_ASTEROID)
+		{
+			sgGravityBodies[bodyNum] = pTransform->mPosition;
+			sgGravityMasses[bodyNum] = pTransform->mScaleX * pTransform->mScaleY * ASTEROID_DENSITY;
+			++bodyNum;
+		}
+
+		sgGravityQueries[queryNum] = pTransform->mPosition;
+		sgGravityQueryInstances[queryNum] = pInst;
+		++queryNum;
+	}
+
+	// The bullets are only attracted, queried in the same pass after the instances
+	for (c = sgProjectiles.mHead; c != sgProjectiles.mTail; c++)
+	{
+		unsigned long slot = c & (sgProjectiles.mCapacity - 1);
+
+		if (0 == sgProjectiles.mpAlive[slot])
+			continue;
+
+		Vector2DSet(sgGravityQueries + queryNum + bulletNum, sgProjectiles.mpPosX[slot], sgProjectiles.mpPosY[slot]);
+		sgGravityQueryBullets[bulletNum++] = slot;
+	}
+
+	BarnesHutBuild(&sgGravityTree, sgGravityBodies, sgGravityMasses, bodyNum);
+	BarnesHutComputeAccelerations(&sgGravityTree, sgGravityQueries, queryNum + bulletNum, sgGravityAccelerations);
+
+	for (i = 0; i < queryNum; i++)
+	{
+		Component_Physics *pPhysics = INST_PHYSICS(sgGravityQueryInstances[i]);
+		Vector2DScaleAdd(&pPhysics->mVelocity, sgGravityAccelerations + i, &pPhysics->mVelocity, dt);
+	}
+
+	for (i = 0; i < bulletNum; i++)
+	{
+		sgProjectiles.mpVelX[sgGravityQueryBullets[i]] += sgGravityAccelerations[queryNum + i].x * dt;
+		sgProjectiles.mpVelY[sgGravityQueryBullets[i]] += sgGravityAccelerations[queryNum + i].y * dt;
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void AsteroidCollisionsSolve(float dt)
+{
+	long i;
+
 	for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
 	{
 		GameObjectInstance* pInst = sgGameObjectInstanceList + i;
+		Component_Transform *pTransform;
+		Shape *pShape;
 
-		// Check if current instance is not used
-		if (pInst->mFlag == 0)
+		if ((pInst->mFlag & FLAG_ACTIVE) == 0 || INST_SPRITE(pInst)->mpShape->mType != OBJECT_TYPE_ASTEROID)
 		{
-			// It is not used => use it to create the new instance
+			sgIslands.mpRadius[i] = 0.0f;
+			continue;
+		}
+
+		pTransform = INST_TRANSFORM(pInst);
+		pShape = INST_SPRITE(pInst)->mpShape;
+
+		// A circle between the outline's inner and outer extents, the same mass as for the gravity
+		sgIslands.mpPosX[i] = pTransform->mPosition.x;
+		sgIslands.mpPosY[i] = pTransform->mPosition.y;
+		sgIslands.mpVelX[i] = INST_PHYSICS(pInst)->mVelocity.x;
+		sgIslands.mpVelY[i] = INST_PHYSICS(pInst)->mVelocity.y;
+		sgIslands.mpRadius[i] = 0.25f * ((pShape->mLocalMaxX - pShape->mLocalMinX) * fabsf(pTransform->mScaleX)
+			+ (pShape->mLocalMaxY - pShape->mLocalMinY) * fabsf(pTransform->mScaleY));
+		sgIslands.mpInvMass[i] = 1.0f / (fabsf(pTransform->mScaleX * pTransform->mScaleY) * ASTEROID_DENSITY);
+	}
+
+	IslandSolverStep(&sgIslands, dt);
+
+	for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	{
+		if (sgIslands.mpRadius[i] <= 0.0f)
+			continue;
+
+		INST_TRANSFORM(sgGameObjectInstanceList + i)->mPosition.x = sgIslands.mpPosX[i];
+		INST_TRANSFORM(sgGameObjectInstanceList + i)->mPosition.y = sgIslands.mpPosY[i];
+		INST_PHYSICS(sgGameObjectInstanceList + i)->mVelocity.x = sgIslands.mpVelX[i];
+		INST_PHYSICS(sgGameObjectInstanceList + i)->mVelocity.y = sgIslands.mpVelY[i];
+	}
+}
+
+// ---------------------------------------------------------------------------
 
-			// Active the game object instance
-			pInst->mFlag = FLAG_ACTIVE;
+void MoversIntegrate(float dt)
+{
+	int level;
+
+	SubstepObstaclesGather();
+
+	// Only instances with a transform and a physics component are visited, no checks needed
+	SubstepBatchesClear(&sgSubsteps);
+	QUERY_EACH(&sgQuery, COMPONENT_TRANSFORM | COMPONENT_PHYSICS, i)
+	{
+		SubstepBatchesAdd(&sgSubsteps, i, MoverSubstepLevel(i, dt));
+	}
+	SubstepBatchesSort(&sgSubsteps);
 
-			pInst->mpComponent_Transform = 0;
-			pInst->mpComponent_Sprite = 0;
-			pInst->mpComponent_Physics = 0;
-			pInst->mpComponent_Target = 0;
+	for (level = 0; level < SUBSTEP_LEVEL_NUM; level++)
+	{
+		unsigned long first = sgSubsteps.mStart[level], last = sgSubsteps.mStart[level + 1], k;
+		float h = dt / (float)(1 << level);
+		int s;
 
-			// Add the components, based on the object type
-			switch (ObjectType)
+		for (s = 0; s < (1 << level); s++)
+		{
+			for (k = first; k < last; k++)
 			{
-			case OBJECT_TYPE_SHIP:
-				AddComponent_Sprite(pInst, OBJECT_TYPE_SHIP);
-				AddComponent_Transform(pInst, 0, 0.0f, SHIP_SIZE, SHIP_SIZE);   //Initial scale is 1, setting it to predefined SHIP_SIZE
-				AddComponent_Physics(pInst, 0);
-				Vector2DSet(&sgpShipStartPos, pInst->mpComponent_Transform->mPosition.x, pInst->mpComponent_Transform->mPosition.y);
-				Vector2DSet(&sgpShipStartPhys, pInst->mpComponent_Physics->mVelocity.x, pInst->mpComponent_Physics->mVelocity.y);
-				break;
-				
-			case OBJECT_TYPE_BULLET:
-				AddComponent_Sprite(pInst, OBJECT_TYPE_BULLET);
-				AddComponent_Transform(pInst, &(sgpShip->mpComponent_Transform->mPosition), 0.0f, BULLET_SIZE, BULLET_SIZE);
-				AddComponent_Physics(pInst, 0);
-				break;
-
-			case OBJECT_TYPE_ASTEROID:
-				AddComponent_Sprite(pInst, OBJECT_TYPE_ASTEROID);
-				AddComponent_Transform(pInst, 0, 0.0f,ASTEROID_SIZE, ASTEROID_SIZE);
-				AddComponent_Physics(pInst, 0);
-				break;
-
-			case OBJECT_TYPE_HOMING_MISSILE:
-				AddComponent_Sprite(pInst, OBJECT_TYPE_HOMING_MISSILE);
-				AddComponent_Transform(pInst, &(sgpShip->mpComponent_Transform->mPosition), (sgpShip->mpComponent_Transform->mAngle),MISSILE_WIDTH, MISSILE_HEIGHT);
-				AddComponent_Physics(pInst, 0);
-				AddComponent_Target(pInst, 0);
-				break;
+				long slot = sgSubstepObstacles[sgSubsteps.mpItems[k]];
+				GameObjectInstance* pInst = sgGameObjectInstanceList + sgSubsteps.mpItems[k];
+				Component_Transform *pTransform = INST_TRANSFORM(pInst);
+				float half;
+
+				if (slot == SUBSTEP_OBSTACLE_HIT)
+					continue;
+
+				pTransform->mPosition.x += INST_PHYSICS(pInst)->mVelocity.x * h;
+				pTransform->mPosition.y += INST_PHYSICS(pInst)->mVelocity.y * h;
+
+				// Stops inside the box of its asteroid, the collision tests find it there
+				if (slot == SUBSTEP_OBSTACLE_NONE)
+					continue;
+
+				half = 0.5f * min(fabsf(pTransform->mScaleX), fabsf(pTransform->mScaleY));
+				if (pTransform->mPosition.x + half >= sgBounds.mpMinX[slot] && pTransform->mPosition.x - half <= sgBounds.mpMaxX[slot]
+					&& pTransform->mPosition.y + half >= sgBounds.mpMinY[slot] && pTransform->mPosition.y - half <= sgBounds.mpMaxY[slot])
+					sgSubstepObstacles[sgSubsteps.mpItems[k]] = SUBSTEP_OBSTACLE_HIT;
 			}
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void SubstepObstaclesGather(void)
+{
+	long i;
+
+	// Last frame's bounds: the asteroids have moved a fraction of their size since
+	sgObstacleNum = 0;
+	sgObstacleThinnest = ASTEROID_SIZE;
+
+	for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	{
+		GameObjectInstance* pInst = sgGameObjectInstanceList + i;
+
+		if ((pInst->mFlag & FLAG_ACTIVE) == 0 || INST_SPRITE(pInst)->mpShape->mType != OBJECT_TYPE_ASTEROID || sgBounds.mpScaleX[i] == 0.0f)
+			continue;
+
+		sgObstacleSlots[sgObstacleNum++] = i;
+		sgObstacleThinnest = min(sgObstacleThinnest, min(sgBounds.mpMaxX[i] - sgBounds.mpMinX[i], sgBounds.mpMaxY[i] - sgBounds.mpMinY[i]));
+	}
+}
 
-			++sgGameObjectInstanceNum;
+// ---------------------------------------------------------------------------
+
+unsigned char MoverSubstepLevel(long Slot, float dt)
+{
+	GameObjectInstance* pInst = sgGameObjectInstanceList + Slot;
+	Component_Transform *pTransform = INST_TRANSFORM(pInst);
+	Vector2D *pVel = &INST_PHYSICS(pInst)->mVelocity;
+	float travel = sqrtf(pVel->x * pVel->x + pVel->y * pVel->y) * dt;
+	float size = min(fabsf(pTransform->mScaleX), fabsf(pTransform->mScaleY));
+	float nearest = travel * travel, thickness;
+	long k, obstacle = SUBSTEP_OBSTACLE_NONE;
+
+	sgSubstepObstacles[Slot] = SUBSTEP_OBSTACLE_NONE;
+
+	// The asteroids are the obstacles. Covering less than its size plus the thinnest of them, nothing can be skipped
+	if (INST_SPRITE(pInst)->mpShape->mType == OBJECT_TYPE_ASTEROID || travel <= size + sgObstacleThinnest)
+		return 0;
+
+	// Only the few fast movers get here: the nearest asteroid box closer than a frame of travel
+	for (k = 0; k < sgObstacleNum; k++)
+	{
+		long a = sgObstacleSlots[k];
+		float dx = max(max(sgBounds.mpMinX[a] - pTransform->mPosition.x, pTransform->mPosition.x - sgBounds.mpMaxX[a]), 0.0f);
+		float dy = max(max(sgBounds.mpMinY[a] - pTransform->mPosition.y, pTransform->mPosition.y - sgBounds.mpMaxY[a]), 0.0f);
 
-			// return the newly created instance
-			return pInst;
+		if (dx * dx + dy * dy < nearest)
+		{
+			nearest = dx * dx + dy * dy;
+			obstacle = a;
 		}
 	}
 
-	// Cannot find empty slot => return 0
-	return 0;
+	if (obstacle == SUBSTEP_OBSTACLE_NONE)
+		return 0;
+
+	sgSubstepObstacles[Slot] = obstacle;
+	thickness = min(sgBounds.mpMaxX[obstacle] - sgBounds.mpMinX[obstacle], sgBounds.mpMaxY[obstacle] - sgBounds.mpMinY[obstacle]);
+
+	return SubstepLevel(travel, size + thickness);
+}
+
+// ---------------------------------------------------------------------------
+
+void BulletHitsResolve(void)
+{
+	long i;
+
+	for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	{
+		GameObjectInstance *fragments[ASTEROID_FRAGMENT_NUM];
+		Vector2D position;
+		unsigned long k, num;
+		long slot;
+
+		if (sgGameObjectInstanceList[i].mFlag != FLAG_ACTIVE || INST_SPRITE(&sgGameObjectInstanceList[i])->mpShape->mType != OBJECT_TYPE_ASTEROID)
+			continue;
+
+		// Only the grid cells under the asteroid are visited
+		slot = ProjectileHitFind(&sgProjectiles, sgBounds.mpMinX[i], sgBounds.mpMinY[i], sgBounds.mpMaxX[i], sgBounds.mpMaxY[i]);
+		if (slot == PROJECTILE_NONE)
+			continue;
+
+		position = INST_TRANSFORM(&sgGameObjectInstanceList[i])->mPosition;
+		EventPublish(sgEvents.mRings + EVENT_RING_MAIN, EVENT_ASTEROID_DESTROYED, (unsigned short)sgGameObjectInstanceList[i].mSplitDepth, i, position.x, position.y);
+
+		ProjectileKill(&sgProjectiles, slot);
+		num = AsteroidFragment(&(sgGameObjectInstanceList[i]), ASTEROID_FRAGMENT_DEPTH, fragments);
+
+		// the fragments did not exist when the bounds were computed
+		for (k = 0; k < num; k++)
+			GameObjectBoundsUpdate(fragments[k] - sgGameObjectInstanceList, 1);
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void WorldStream(void)
+{
+	long camX, camY, x, y;
+	unsigned long i;
+
+	AEGfxSetCamPosition(INST_TRANSFORM(sgpShip)->mPosition.x, INST_TRANSFORM(sgpShip)->mPosition.y);
+	WorldChunkCoord(&sgWorld, INST_TRANSFORM(sgpShip)->mPosition.x, INST_TRANSFORM(sgpShip)->mPosition.y, &camX, &camY);
+
+	// Freeze the asteroids that drifted out of the live area, drop the missiles
+	for (i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	{
+		GameObjectInstance *pInst = sgGameObjectInstanceList + i;
+		Component_Transform *pTransform;
+		WorldRecord *pRecord;
+		WorldChunk *pChunk;
+		long chunkX, chunkY;
+		int created;
+
+		if ((pInst->mFlag & FLAG_ACTIVE) == 0 || pInst == sgpShip)
+			continue;
+
+		pTransform = INST_TRANSFORM(pInst);
+		WorldChunkCoord(&sgWorld, pTransform->mPosition.x, pTransform->mPosition.y, &chunkX, &chunkY);
+
+		if (WorldChunkIsActive(&sgWorld, chunkX, chunkY, camX, camY))
+			continue;
+
+		if (INST_SPRITE(pInst)->mpShape->mType == OBJECT_TYPE_ASTEROID)
+		{
+			// A chunk first reached by a drifting asteroid is created unseeded, it gets its own asteroids when the camera comes
+			pChunk = WorldChunkGet(&sgWorld, chunkX, chunkY, &created);
+			pRecord = WorldChunkFreeze(&sgWorld, pChunk, &pTransform->mPosition, &INST_PHYSICS(pInst)->mVelocity, pTransform->mAngle, pTransform->mScaleX);
+			pRecord->mType = OBJECT_TYPE_ASTEROID;
+			pRecord->mShape = (unsigned char)(INST_SPRITE(pInst)->mpShape - sgShapes);
+			pRecord->mSplitDepth = (unsigned char)pInst->mSplitDepth;
+		}
+
+		GameObjectInstanceDestroy(pInst);
+	}
+
+	// Seed the chunks seen for the first time, bring the frozen ones back to life.
+	// Thawed asteroids take their slots like any direct creation, never one reserved by a spawner this frame
+	for (y = camY - sgWorld.mActiveRadius; y <= camY + sgWorld.mActiveRadius; y++)
+	{
+		for (x = camX - sgWorld.mActiveRadius; x <= camX + sgWorld.mActiveRadius; x++)
+		{
+			int created;
+			WorldChunk *pChunk = WorldChunkGet(&sgWorld, x, y, &created);
+
+			if (!pChunk->mSeeded)
+			{
+				WorldChunkSeed(pChunk);
+				pChunk->mSeeded = 1;
+			}
+
+			if (pChunk->mRecordNum)
+				WorldChunkThaw(pChunk);
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void WorldChunkSeed(WorldChunk *pChunk)
+{
+	float values[6 * WORLD_CHUNK_ASTEROID_NUM];
+	Random random;
+	unsigned long k;
+
+	// The chunk's own stream: its content does not depend on the order chunks are visited in
+	RandomInit(&random, RANDOM_SEED, RANDOM_STREAM_WORLD + (((u32)pChunk->mX * 73856093u) ^ ((u32)pChunk->mY * 19349663u)));
+	RandomFillFloat(&random, values, 6 * WORLD_CHUNK_ASTEROID_NUM);
+
+	for (k = 0; k < WORLD_CHUNK_ASTEROID_NUM; k++)
+	{
+		const float *pValues = values + 6 * k;
+		float scale = ASTEROID_SIZE * (1.0f + 2.0f * pValues[0]);
+		float angle = pValues[1] * TWO_PI;
+		Vector2D position, velocity;
+		WorldRecord *pRecord;
+
+		Vector2DSet(&position, (pChunk->mX + pValues[2]) * sgWorld.mChunkSize, (pChunk->mY + pValues[3]) * sgWorld.mChunkSize);
+		Vector2DFromAngleRad(&velocity, pValues[4] * TWO_PI);
+		Vector2DScale(&velocity, &velocity, ASTEROID_SPEED * pValues[5]);
+
+		pRecord = WorldChunkFreeze(&sgWorld, pChunk, &position, &velocity, angle, scale);
+		pRecord->mType = OBJECT_TYPE_ASTEROID;
+		pRecord->mShape = (unsigned char)(sgPrefabs[OBJECT_TYPE_ASTEROID].mSprite.mpShape - sgShapes);
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void WorldChunkThaw(WorldChunk *pChunk)
+{
+	static GameObjectInstance *spInstances[GAME_OBJ_INST_NUM_MAX];
+	unsigned long num, k;
+
+	num = GameObjectInstanceCreateBatch(OBJECT_TYPE_ASTEROID, pChunk->mRecordNum, spInstances);
+
+	for (k = 0; k < num; k++)
+	{
+		GameObjectInstance *pInst = spInstances[k];
+		Component_Transform *pTransform = INST_TRANSFORM(pInst);
+		const WorldRecord *pRecord = pChunk->mpRecords + k;
+		float scale;
+
+		WorldRecordThaw(&sgWorld, pChunk, pRecord, &pTransform->mPosition, &INST_PHYSICS(pInst)->mVelocity, &pTransform->mAngle, &scale);
+		pTransform->mScaleX = pTransform->mScaleY = scale;
+		pInst->mSplitDepth = pRecord->mSplitDepth;
+
+		// Seeded records still have the prefab square, pick their outline now that the scale is known
+		if (pRecord->mShape < sgShapeNum && sgShapes + pRecord->mShape != sgPrefabs[OBJECT_TYPE_ASTEROID].mSprite.mpShape)
+			INST_SPRITE(pInst)->mpShape = sgShapes + pRecord->mShape;
+		else
+			AsteroidVariantAssign(pInst);
+	}
+
+	// A full pool leaves the rest frozen until slots free up
+	WorldChunkRemove(pChunk, num);
 }
 
 // ---------------------------------------------------------------------------
@@ -848,14 +2583,26 @@ void GameObjectInstanceDestroy(GameObjectInstance* pInst)
 	if (pInst->mFlag == 0)
 		return;
 
-	// Zero out the mFlag
+	// Zero out the mFlag, and let the targets held on this instance see it is gone
 	pInst->mFlag = 0;
+	pInst->mGeneration++;
+
+	// Let the next direct creation reuse this slot, it is published to the queue at the next flush
+	sgFreedSlots[sgFreedSlotNum++] = pInst - sgGameObjectInstanceList;
 
 	RemoveComponent_Transform(pInst);
 	RemoveComponent_Sprite(pInst);
 	RemoveComponent_Physics(pInst);
 	RemoveComponent_Target(pInst);
 
+	QueryRemove(&sgQuery, pInst - sgGameObjectInstanceList);
+
+	if (pInst->mBehavior != COMPONENT_INDEX_NONE)
+	{
+		BehaviorStop(sgBehaviors.mpBehaviors + pInst->mBehavior);
+		pInst->mBehavior = COMPONENT_INDEX_NONE;
+	}
+
 	--sgGameObjectInstanceNum;
 }
 
@@ -865,19 +2612,20 @@ void AddComponent_Transform(GameObjectInstance *pInst, Vector2D *pPosition, floa
 {
 	if (0 != pInst)
 	{
-		if (0 == pInst->mpComponent_Transform)
+		if (COMPONENT_INDEX_NONE == pInst->mTransform)
 		{
-			pInst->mpComponent_Transform = (Component_Transform *)calloc(1, sizeof(Component_Transform));
+			pInst->mTransform = (ComponentIndex)ComponentPoolAlloc(&sgTransformPool);
+			memset(INST_TRANSFORM(pInst), 0, sizeof(Component_Transform));
 		}
 
 		Vector2D zeroVec2;
 		Vector2DZero(&zeroVec2);
 
-		pInst->mpComponent_Transform->mScaleX = ScaleX;
-		pInst->mpComponent_Transform->mScaleY = ScaleY;
-		pInst->mpComponent_Transform->mPosition = pPosition ? *pPosition : zeroVec2;;
-		pInst->mpComponent_Transform->mAngle = Angle;
-		pInst->mpComponent_Transform->mpOwner = pInst;
+		INST_TRANSFORM(pInst)->mScaleX = ScaleX;
+		INST_TRANSFORM(pInst)->mScaleY = ScaleY;
+		INST_TRANSFORM(pInst)->mPosition = pPosition ? *pPosition : zeroVec2;;
+		INST_TRANSFORM(pInst)->mAngle = Angle;
+		INST_TRANSFORM(pInst)->mOwner = (ComponentIndex)(pInst - sgGameObjectInstanceList);
 	}
 }
 
@@ -887,13 +2635,13 @@ void AddComponent_Sprite(GameObjectInstance *pInst, unsigned int ShapeType)
 {
 	if (0 != pInst)
 	{
-		if (0 == pInst->mpComponent_Sprite)
+		if (COMPONENT_INDEX_NONE == pInst->mSprite)
 		{
-			pInst->mpComponent_Sprite = (Component_Sprite *)calloc(1, sizeof(Component_Sprite));
+			pInst->mSprite = (ComponentIndex)ComponentPoolAlloc(&sgSpritePool);
 		}
 	
-		pInst->mpComponent_Sprite->mpShape = sgShapes + ShapeType;
-		pInst->mpComponent_Sprite->mpOwner = pInst;
+		INST_SPRITE(pInst)->mpShape = sgShapes + ShapeType;
+		INST_SPRITE(pInst)->mOwner = (ComponentIndex)(pInst - sgGameObjectInstanceList);
 	}
 }
 
@@ -903,16 +2651,16 @@ void AddComponent_Physics(GameObjectInstance *pInst, Vector2D *pVelocity)
 {
 	if (0 != pInst)
 	{
-		if (0 == pInst->mpComponent_Physics)
+		if (COMPONENT_INDEX_NONE == pInst->mPhysics)
 		{
-			pInst->mpComponent_Physics = (Component_Physics *)calloc(1, sizeof(Component_Physics));
+			pInst->mPhysics = (ComponentIndex)ComponentPoolAlloc(&sgPhysicsPool);
 		}
 
 		Vector2D zeroVec2;
 		Vector2DZero(&zeroVec2);
 
-		pInst->mpComponent_Physics->mVelocity = pVelocity ? *pVelocity : zeroVec2;
-		pInst->mpComponent_Physics->mpOwner = pInst;
+		INST_PHYSICS(pInst)->mVelocity = pVelocity ? *pVelocity : zeroVec2;
+		INST_PHYSICS(pInst)->mOwner = (ComponentIndex)(pInst - sgGameObjectInstanceList);
 	}
 }
 
@@ -922,13 +2670,14 @@ void AddComponent_Target(GameObjectInstance *pInst, GameObjectInstance *pTarget)
 {
 	if (0 != pInst)
 	{
-		if (0 == pInst->mpComponent_Target)
+		if (COMPONENT_INDEX_NONE == pInst->mTarget)
 		{
-			pInst->mpComponent_Target = (Component_Target *)calloc(1, sizeof(Component_Target));
+			pInst->mTarget = (ComponentIndex)ComponentPoolAlloc(&sgTargetPool);
 		}
 
-		pInst->mpComponent_Target->mpTarget = pTarget;
-		pInst->mpComponent_Target->mpOwner = pInst;
+		INST_TARGET(pInst)->mTarget = pTarget ? (ComponentIndex)(pTarget - sgGameObjectInstanceList) : COMPONENT_INDEX_NONE;
+		INST_TARGET(pInst)->mGeneration = pTarget ? pTarget->mGeneration : 0;
+		INST_TARGET(pInst)->mOwner = (ComponentIndex)(pInst - sgGameObjectInstanceList);
 	}
 }
 
@@ -938,10 +2687,10 @@ void RemoveComponent_Transform(GameObjectInstance *pInst)
 {
 	if (0 != pInst)
 	{
-		if (0 != pInst->mpComponent_Transform)
+		if (COMPONENT_INDEX_NONE != pInst->mTransform)
 		{
-			free(pInst->mpComponent_Transform);
-			pInst->mpComponent_Transform = 0;
+			ComponentPoolRelease(&sgTransformPool, pInst->mTransform);
+			pInst->mTransform = COMPONENT_INDEX_NONE;
 		}
 	}
 }
@@ -952,10 +2701,10 @@ void RemoveComponent_Sprite(GameObjectInstance *pInst)
 {
 	if (0 != pInst)
 	{
-		if (0 != pInst->mpComponent_Sprite)
+		if (COMPONENT_INDEX_NONE != pInst->mSprite)
 		{
-			free(pInst->mpComponent_Sprite);
-			pInst->mpComponent_Sprite = 0;
+			ComponentPoolRelease(&sgSpritePool, pInst->mSprite);
+			pInst->mSprite = COMPONENT_INDEX_NONE;
 		}
 	}
 }
@@ -966,10 +2715,10 @@ void RemoveComponent_Physics(GameObjectInstance *pInst)
 {
 	if (0 != pInst)
 	{
-		if (0 != pInst->mpComponent_Physics)
+		if (COMPONENT_INDEX_NONE != pInst->mPhysics)
 		{
-			free(pInst->mpComponent_Physics);
-			pInst->mpComponent_Physics = 0;
+			ComponentPoolRelease(&sgPhysicsPool, pInst->mPhysics);
+			pInst->mPhysics = COMPONENT_INDEX_NONE;
 		}
 	}
 }
@@ -980,10 +2729,10 @@ void RemoveComponent_Target(GameObjectInstance *pInst)
 {
 	if (0 != pInst)
 	{
-		if (0 != pInst->mpComponent_Target)
+		if (COMPONENT_INDEX_NONE != pInst->mTarget)
 		{
-			free(pInst->mpComponent_Target);
-			pInst->mpComponent_Target = 0;
+			ComponentPoolRelease(&sgTargetPool, pInst->mTarget);
+			pInst->mTarget = COMPONENT_INDEX_NONE;
 		}
 	}
 }
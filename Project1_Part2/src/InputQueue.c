@@ -0,0 +1,265 @@
+/* Start Header -------------------------------------------------------
+Copyright InputQueue.c
+Purpose:  Implementation of the input thread and its event queue
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_InputQueue.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "InputQueue.h"
+
+// single producer (the input thread), single consumer (the game loop)
+static InputEvent				sgEvents[INPUT_QUEUE_CAPACITY];
+static volatile unsigned long	sgHead;
+static volatile unsigned long	sgTail;
+static volatile long			sgDropped;
+
+// input thread side
+static HANDLE					sgThread;
+static DWORD					sgThreadId;
+static HANDLE					sgReady;
+static volatile int				sgRunning;
+static HHOOK					sgHook;
+static HWND						sgWindow;
+static unsigned char			sgWatched[INPUT_KEY_NUM];
+static unsigned char			sgHookDown[INPUT_KEY_NUM];			// Filters the auto repeats out
+
+// game side
+static f64						sgLastRead;
+static unsigned char			sgReadDown[INPUT_KEY_NUM];			// Key state at the end of the last read
+static float					sgHeld[INPUT_KEY_NUM];
+static f64						sgFrequency;
+
+// ---------------------------------------------------------------------------
+
+f64 InputQueueTime(void)
+{
+	LARGE_INTEGER counter;
+
+	if (sgFrequency == 0.0)
+	{
+		LARGE_INTEGER frequency;
+
+		QueryPerformanceFrequency(&frequency);
+		sgFrequency = (f64)frequency.QuadPart;
+	}
+
+	QueryPerformanceCounter(&counter);
+
+	return (f64)counter.QuadPart / sgFrequency;
+}
+
+// ---------------------------------------------------------------------------
+
+static void InputQueuePush(unsigned char Key, unsigned char Down, f64 Time)
+{
+	unsigned long head = sgHead;
+	InputEvent *pEvent;
+
+	if (head - sgTail >= INPUT_QUEUE_CAPACITY)
+	{
+		InterlockedIncrement(&sgDropped);
+		return;
+	}
+
+	pEvent = sgEvents + (head & (INPUT_QUEUE_CAPACITY - 1));
+	pEvent->mTime = Time;
+	pEvent->mKey = Key;
+	pEvent->mDown = Down;
+
+	// Volatile store, released after the event
+	sgHead = head + 1;
+}
+
+// ---------------------------------------------------------------------------
+
+// Runs on the input thread. Must return quickly, Windows drops hooks that stall the keyboard
+static LRESULT CALLBACK InputQueueHook(int Code, WPARAM wParam, LPARAM lParam)
+{
+	if (Code == HC_ACTION)
+	{
+		const KBDLLHOOKSTRUCT *pKey = (const KBDLLHOOKSTRUCT *)lParam;
+		unsigned char key = (unsigned char)pKey->vkCode;
+		int down = (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN);
+
+		if (sgWatched[key])
+		{
+			f64 time = InputQueueTime();
+
+			// Presses only count for our window, releases always go through so no key stays stuck
+			if (down && !sgHookDown[key] && GetForegroundWindow() == sgWindow)
+			{
+				sgHookDown[key] = 1;
+				InputQueuePush(key, 1, time);
+			}
+			else if (!down && sgHookDown[key])
+			{
+				sgHookDown[key] = 0;
+				InputQueuePush(key, 0, time);
+			}
+		}
+	}
+
+	return CallNextHookEx(sgHook, Code, wParam, lParam);
+}
+
+// ---------------------------------------------------------------------------
+
+static DWORD WINAPI InputQueueThread(LPVOID pParam)
+{
+	MSG msg;
+
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+
+	// Creates the thread's message queue before the hook is reported as ready
+	PeekMessageA(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+	sgHook = SetWindowsHookExA(WH_KEYBOARD_LL, InputQueueHook, GetModuleHandleA(NULL), 0);
+	sgRunning = (sgHook != 0);
+	SetEvent(sgReady);
+
+	if (!sgRunning)
+		return 1;
+
+	// The hook is called from inside this loop, as soon as a key changes
+	while (GetMessageA(&msg, NULL, 0, 0) > 0)
+		;
+
+	UnhookWindowsHookEx(sgHook);
+	sgHook = 0;
+
+	return 0;
+}
+
+// ---------------------------------------------------------------------------
+
+int InputQueueStart(HWND Window, const unsigned char *pKeys, unsigned long KeyNum)
+{
+	unsigned long i;
+
+	if (sgThread)
+		return sgRunning;
+
+	memset(sgWatched, 0, sizeof(sgWatched));
+	memset(sgHookDown, 0, sizeof(sgHookDown));
+	memset(sgReadDown, 0, sizeof(sgReadDown));
+	memset(sgHeld, 0, sizeof(sgHeld));
+	for (i = 0; i < KeyNum; i++)
+		sgWatched[pKeys[i]] = 1;
+
+	sgWindow = Window;
+	sgHead = sgTail = 0;
+	sgDropped = 0;
+	sgLastRead = InputQueueTime();
+
+	sgReady = CreateEvent(NULL, FALSE, FALSE, NULL);
+	sgThread = sgReady ? CreateThread(NULL, 0, InputQueueThread, NULL, 0, &sgThreadId) : 0;
+
+	if (0 == sgThread)
+	{
+		AE_WARNING_MESG(0, "Could not start the input thread");
+		InputQueueStop();
+		return 0;
+	}
+
+	WaitForSingleObject(sgReady, INFINITE);
+
+	if (!sgRunning)
+	{
+		AE_WARNING_MESG(0, "Could not install the keyboard hook");
+		InputQueueStop();
+	}
+
+	return sgRunning;
+}
+
+// ---------------------------------------------------------------------------
+
+void InputQueueStop(void)
+{
+	if (sgThread)
+	{
+		PostThreadMessageA(sgThreadId, WM_QUIT, 0, 0);
+		WaitForSingleObject(sgThread, INFINITE);
+		CloseHandle(sgThread);
+	}
+
+	if (sgReady)
+		CloseHandle(sgReady);
+
+	sgThread = 0;
+	sgReady = 0;
+	sgRunning = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+int InputQueueIsRunning(void)
+{
+	return sgRunning;
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned long InputQueueRead(InputEvent *pEvents, unsigned long Max, f64 *pFrameStart, f64 *pFrameEnd)
+{
+	f64 start = sgLastRead, end = InputQueueTime(), length, downSince[INPUT_KEY_NUM];
+	unsigned long tail = sgTail, head = sgHead, num = 0, k;
+
+	// With events left for the next read, the window stops at the last one taken:
+	// a key whose release is still queued is not counted as held past it
+	if (head - tail > Max)
+		end = Max ? max(sgEvents[(tail + Max - 1) & (INPUT_QUEUE_CAPACITY - 1)].mTime, start) : start;
+
+	length = end - start;
+	if (length < INPUT_WINDOW_MIN)
+		length = INPUT_WINDOW_MIN;
+
+	for (k = 0; k < INPUT_KEY_NUM; k++)
+	{
+		sgHeld[k] = 0.0f;
+		downSince[k] = start;
+	}
+
+	// Events past Max stay queued for the next read
+	for (; tail != head && num < Max; tail++, num++)
+	{
+		InputEvent *pEvent = pEvents + num;
+		f64 time;
+
+		*pEvent = sgEvents[tail & (INPUT_QUEUE_CAPACITY - 1)];
+
+		// Stamped just before the previous read but queued after it
+		time = max(pEvent->mTime, start);
+
+		if (pEvent->mDown)
+			downSince[pEvent->mKey] = time;
+		else if (sgReadDown[pEvent->mKey])
+			sgHeld[pEvent->mKey] += (float)((time - downSince[pEvent->mKey]) / length);
+
+		sgReadDown[pEvent->mKey] = pEvent->mDown;
+	}
+
+	sgTail = tail;
+
+	for (k = 0; k < INPUT_KEY_NUM; k++)
+	{
+		if (sgReadDown[k])
+			sgHeld[k] += (float)((end - downSince[k]) / length);
+		sgHeld[k] = AEClamp(sgHeld[k], 0.0f, 1.0f);
+	}
+
+	sgLastRead = end;
+	*pFrameStart = start;
+	*pFrameEnd = end;
+
+	return num;
+}
+
+// ---------------------------------------------------------------------------
+
+float InputQueueHeldFraction(unsigned char Key)
+{
+	return sgHeld[Key];
+}
@@ -0,0 +1,628 @@
+/* Start Header -------------------------------------------------------
+Copyright Island.c
+Purpose:  Implementation of the island contact solver
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Island.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "Island.h"
+#include "Startup.h"
+#include "Random.h"
+#include "WorkerPool.h"
+#include <float.h>
+#include <math.h>
+
+#define ISLAND_WAKE_EPSILON				0.001f				// Velocity change that counts as a disturbance
+
+#define ISLAND_BENCHMARK_BODY_NUM		20000
+#define ISLAND_BENCHMARK_FRAME_NUM		120
+#define ISLAND_BENCHMARK_SIZE			6000.0f				// Side of the square field
+#define ISLAND_BENCHMARK_RAFT_SIDE		10					// Rafts of touching bodies, RAFT_SIDE x RAFT_SIDE
+#define ISLAND_BENCHMARK_RAFT_RADIUS	6.0f
+#define ISLAND_BENCHMARK_RAFT_NUM		(ISLAND_BENCHMARK_BODY_NUM / 2 / (ISLAND_BENCHMARK_RAFT_SIDE * ISLAND_BENCHMARK_RAFT_SIDE))
+#define ISLAND_BENCHMARK_RAFT_ROW_NUM	10					// Rafts per row of the field
+
+// One worker's share of a step: a run of islands
+typedef struct
+{
+	IslandSolver		*mpSolver;
+	long				mIslandFirst, mIslandEnd;
+	float				mDt;
+}IslandJob;
+
+// ---------------------------------------------------------------------------
+
+// Wakes a body, the rest of its island follows at the next IslandWakePropagate
+static void IslandWake(IslandSolver *p, long i)
+{
+	p->mpWake[p->mpSleepIsland[i]] = 1;
+	p->mpSleepIsland[i] = ISLAND_SLEEP_NONE;
+	p->mpRestTime[i] = 0.0f;
+}
+
+// ---------------------------------------------------------------------------
+
+static void IslandWakePropagate(IslandSolver *p)
+{
+	long i;
+
+	for (i = 0; i < p->mCapacity; i++)
+	{
+		if (p->mpSleepIsland[i] != ISLAND_SLEEP_NONE && p->mpWake[p->mpSleepIsland[i]])
+		{
+			p->mpSleepIsland[i] = ISLAND_SLEEP_NONE;
+			p->mpRestTime[i] = 0.0f;
+		}
+	}
+
+	memset(p->mpWake, 0, p->mCapacity);
+}
+
+// ---------------------------------------------------------------------------
+
+static long IslandFind(long *pParent, long i)
+{
+	// Path halving
+	while (pParent[i] != i)
+	{
+		pParent[i] = pParent[pParent[i]];
+		i = pParent[i];
+	}
+
+	return i;
+}
+
+// ---------------------------------------------------------------------------
+
+static void IslandContactAdd(IslandSolver *p, long A, long B)
+{
+	if (p->mContactNum == p->mContactCapacity)
+	{
+		p->mContactCapacity *= 2;
+		p->mpContactA = (long *)realloc(p->mpContactA, p->mContactCapacity * sizeof(long));
+		p->mpContactB = (long *)realloc(p->mpContactB, p->mContactCapacity * sizeof(long));
+		p->mpContactOrder = (long *)realloc(p->mpContactOrder, p->mContactCapacity * sizeof(long));
+		AE_ASSERT_ALLOC(p->mpContactA && p->mpContactB && p->mpContactOrder);
+	}
+
+	p->mpContactA[p->mContactNum] = A;
+	p->mpContactB[p->mContactNum] = B;
+	p->mContactNum++;
+}
+
+// ---------------------------------------------------------------------------
+
+// Bottom up merge sort of mpOrder on the left edges, through the mpCursor scratch
+static void IslandOrderSort(IslandSolver *p)
+{
+	long n = p->mCapacity, width, k;
+	long *pSrc = p->mpOrder, *pDst = p->mpCursor;
+
+	for (width = 1; width < n; width *= 2)
+	{
+		for (k = 0; k < n; k += 2 * width)
+		{
+			long a = k, aEnd = min(k + width, n), b = aEnd, bEnd = min(k + 2 * width, n), out = k;
+
+			while (a < aEnd && b < bEnd)
+				pDst[out++] = p->mpMinX[pSrc[b]] < p->mpMinX[pSrc[a]] ? pSrc[b++] : pSrc[a++];
+			while (a < aEnd)
+				pDst[out++] = pSrc[a++];
+			while (b < bEnd)
+				pDst[out++] = pSrc[b++];
+		}
+
+		pSrc = pDst;
+		pDst = pSrc == p->mpOrder ? p->mpCursor : p->mpOrder;
+	}
+
+	if (pSrc != p->mpOrder)
+		memcpy(p->mpOrder, pSrc, n * sizeof(long));
+}
+
+// ---------------------------------------------------------------------------
+
+// Sort and sweep on the left edges. Pairs asleep in the same island are skipped,
+// any other pair touching a sleeper wakes it
+static void IslandContactsFind(IslandSolver *p)
+{
+	long n = p->mCapacity, sortedNum, k, m;
+
+	for (k = 0; k < n; k++)
+		p->mpMinX[k] = p->mpRadius[k] > 0.0f ? p->mpPosX[k] - p->mpRadius[k] : FLT_MAX;
+
+	// Insertion sort: the order barely changes from one step to the next. After a clear it is arbitrary
+	if (p->mOrderStale)
+	{
+		IslandOrderSort(p);
+		p->mOrderStale = 0;
+	}
+
+	for (k = 1; k < n; k++)
+	{
+		long body = p->mpOrder[k];
+		float minX = p->mpMinX[body];
+
+		for (m = k; m > 0 && p->mpMinX[p->mpOrder[m - 1]] > minX; m--)
+			p->mpOrder[m] = p->mpOrder[m - 1];
+		p->mpOrder[m] = body;
+	}
+
+	// The sweep reads the bodies in sorted order, so they are gathered first. Empty slots are sorted last
+	for (sortedNum = 0; sortedNum < n && p->mpMinX[p->mpOrder[sortedNum]] != FLT_MAX; sortedNum++)
+	{
+		long body = p->mpOrder[sortedNum];
+
+		p->mpSortedMinX[sortedNum] = p->mpMinX[body];
+		p->mpSortedPosX[sortedNum] = p->mpPosX[body];
+		p->mpSortedPosY[sortedNum] = p->mpPosY[body];
+		p->mpSortedRadius[sortedNum] = p->mpRadius[body];
+		p->mpSortedSleepIsland[sortedNum] = p->mpSleepIsland[body];
+	}
+
+	p->mContactNum = 0;
+
+	for (k = 0; k < sortedNum; k++)
+	{
+		float ax = p->mpSortedPosX[k], ay = p->mpSortedPosY[k], ar = p->mpSortedRadius[k];
+		float maxX = ax + ar;
+		long sleepIsland = p->mpSortedSleepIsland[k];
+
+		for (m = k + 1; m < sortedNum && p->mpSortedMinX[m] <= maxX; m++)
+		{
+			float dx = p->mpSortedPosX[m] - ax, dy = p->mpSortedPosY[m] - ay, r = ar + p->mpSortedRadius[m];
+			long a, b;
+
+			if (dx * dx + dy * dy >= r * r)
+				continue;
+
+			if (sleepIsland != ISLAND_SLEEP_NONE && sleepIsland == p->mpSortedSleepIsland[m])
+				continue;
+
+			a = p->mpOrder[k];
+			b = p->mpOrder[m];
+
+			if (p->mpSleepIsland[a] != ISLAND_SLEEP_NONE)
+				IslandWake(p, a);
+			if (p->mpSleepIsland[b] != ISLAND_SLEEP_NONE)
+				IslandWake(p, b);
+
+			IslandContactAdd(p, a, b);
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+// Union-find over the contacts, then counting sorts of the contacts and their bodies by island
+static void IslandsBuild(IslandSolver *p)
+{
+	long n = p->mCapacity, c, i, island, sum;
+
+	for (i = 0; i < n; i++)
+	{
+		p->mpParent[i] = i;
+		p->mpIsland[i] = -1;
+	}
+
+	// The smaller root wins, so the islands do not depend on the contact order
+	for (c = 0; c < p->mContactNum; c++)
+	{
+		long ra = IslandFind(p->mpParent, p->mpContactA[c]);
+		long rb = IslandFind(p->mpParent, p->mpContactB[c]);
+
+		if (ra < rb)
+			p->mpParent[rb] = ra;
+		else if (rb < ra)
+			p->mpParent[ra] = rb;
+	}
+
+	// Numbered in the order of their first contact
+	p->mIslandNum = 0;
+	for (c = 0; c < p->mContactNum; c++)
+	{
+		long root = IslandFind(p->mpParent, p->mpContactA[c]);
+
+		if (p->mpIsland[root] < 0)
+			p->mpIsland[root] = p->mIslandNum++;
+	}
+
+	// Contacts by island
+	memset(p->mpCursor, 0, (p->mIslandNum + 1) * sizeof(long));
+	for (c = 0; c < p->mContactNum; c++)
+		p->mpCursor[p->mpIsland[IslandFind(p->mpParent, p->mpContactA[c])]]++;
+
+	for (island = 0, sum = 0; island < p->mIslandNum; island++)
+	{
+		long num = p->mpCursor[island];
+
+		p->mpIslandContactStart[island] = sum;
+		p->mpCursor[island] = sum;
+		sum += num;
+	}
+	p->mpIslandContactStart[p->mIslandNum] = sum;
+
+	for (c = 0; c < p->mContactNum; c++)
+		p->mpContactOrder[p->mpCursor[p->mpIsland[IslandFind(p->mpParent, p->mpContactA[c])]]++] = c;
+
+	// Bodies by island, a body is in one when its root has an island
+	memset(p->mpCursor, 0, (p->mIslandNum + 1) * sizeof(long));
+	for (i = 0; i < n; i++)
+	{
+		island = p->mpIsland[IslandFind(p->mpParent, i)];
+		if (island >= 0)
+			p->mpCursor[island]++;
+	}
+
+	for (island = 0, sum = 0; island < p->mIslandNum; island++)
+	{
+		long num = p->mpCursor[island];
+
+		p->mpIslandBodyStart[island] = sum;
+		p->mpCursor[island] = sum;
+		sum += num;
+	}
+	p->mpIslandBodyStart[p->mIslandNum] = sum;
+
+	for (i = 0; i < n; i++)
+	{
+		island = p->mpIsland[IslandFind(p->mpParent, i)];
+		if (island >= 0)
+			p->mpBodyOrder[p->mpCursor[island]++] = i;
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+static void IslandSolve(IslandSolver *p, long Island, float Dt)
+{
+	const long *pContacts = p->mpContactOrder + p->mpIslandContactStart[Island];
+	const long *pBodies = p->mpBodyOrder + p->mpIslandBodyStart[Island];
+	long contactNum = p->mpIslandContactStart[Island + 1] - p->mpIslandContactStart[Island];
+	long bodyNum = p->mpIslandBodyStart[Island + 1] - p->mpIslandBodyStart[Island];
+	float meanX = 0.0f, meanY = 0.0f, deviation = 0.0f, rest = FLT_MAX;
+	long it, k;
+
+	// Elastic impulses along the contact normals, only on approaching pairs
+	for (it = 0; it < ISLAND_ITERATION_NUM; it++)
+	{
+		for (k = 0; k < contactNum; k++)
+		{
+			long a = p->mpContactA[pContacts[k]], b = p->mpContactB[pContacts[k]];
+			float nx = p->mpPosX[b] - p->mpPosX[a], ny = p->mpPosY[b] - p->mpPosY[a];
+			float d = sqrtf(nx * nx + ny * ny), vn, j, invMass;
+
+			if (d <= 0.0f)
+				continue;
+
+			nx /= d;
+			ny /= d;
+			vn = (p->mpVelX[b] - p->mpVelX[a]) * nx + (p->mpVelY[b] - p->mpVelY[a]) * ny;
+			invMass = p->mpInvMass[a] + p->mpInvMass[b];
+
+			if (vn >= 0.0f || invMass <= 0.0f)
+				continue;
+
+			j = -(1.0f + ISLAND_RESTITUTION) * vn / invMass;
+			p->mpVelX[a] -= j * nx * p->mpInvMass[a];
+			p->mpVelY[a] -= j * ny * p->mpInvMass[a];
+			p->mpVelX[b] += j * nx * p->mpInvMass[b];
+			p->mpVelY[b] += j * ny * p->mpInvMass[b];
+		}
+	}
+
+	// Push overlapping pairs apart, heavier bodies move less
+	for (k = 0; k < contactNum; k++)
+	{
+		long a = p->mpContactA[pContacts[k]], b = p->mpContactB[pContacts[k]];
+		float nx = p->mpPosX[b] - p->mpPosX[a], ny = p->mpPosY[b] - p->mpPosY[a];
+		float d = sqrtf(nx * nx + ny * ny);
+		float invMass = p->mpInvMass[a] + p->mpInvMass[b];
+		float depth = p->mpRadius[a] + p->mpRadius[b] - d - ISLAND_SLOP, push;
+
+		if (depth <= 0.0f || invMass <= 0.0f)
+			continue;
+
+		// Coincident centers get pushed apart along x
+		if (d > 0.0f)
+		{
+			nx /= d;
+			ny /= d;
+		}
+		else
+		{
+			nx = 1.0f;
+			ny = 0.0f;
+		}
+
+		push = ISLAND_CORRECTION * depth / invMass;
+		p->mpPosX[a] -= push * nx * p->mpInvMass[a];
+		p->mpPosY[a] -= push * ny * p->mpInvMass[a];
+		p->mpPosX[b] += push * nx * p->mpInvMass[b];
+		p->mpPosY[b] += push * ny * p->mpInvMass[b];
+	}
+
+	// Resting: every body moves with the island's mean velocity
+	for (k = 0; k < bodyNum; k++)
+	{
+		meanX += p->mpVelX[pBodies[k]];
+		meanY += p->mpVelY[pBodies[k]];
+	}
+	meanX /= bodyNum;
+	meanY /= bodyNum;
+
+	for (k = 0; k < bodyNum; k++)
+	{
+		float dx = p->mpVelX[pBodies[k]] - meanX, dy = p->mpVelY[pBodies[k]] - meanY;
+
+		deviation = max(deviation, dx * dx + dy * dy);
+		rest = min(rest, p->mpRestTime[pBodies[k]]);
+	}
+
+	rest = deviation < ISLAND_SLEEP_SPEED * ISLAND_SLEEP_SPEED ? rest + Dt : 0.0f;
+
+	for (k = 0; k < bodyNum; k++)
+	{
+		long i = pBodies[k];
+
+		p->mpRestTime[i] = rest;
+
+		// Named after its lowest slot: no other sleeping island can hold that body, so the name is unique
+		if (rest >= ISLAND_SLEEP_TIME)
+		{
+			p->mpSleepIsland[i] = pBodies[0];
+			p->mpSleepVelX[i] = p->mpVelX[i];
+			p->mpSleepVelY[i] = p->mpVelY[i];
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+static void IslandJobRun(void *pParam)
+{
+	IslandJob *pJob = (IslandJob *)pParam;
+	long island;
+
+	for (island = pJob->mIslandFirst; island < pJob->mIslandEnd; island++)
+		IslandSolve(pJob->mpSolver, island, pJob->mDt);
+}
+
+// ---------------------------------------------------------------------------
+
+void IslandSolverInit(IslandSolver *pSolver, long Capacity)
+{
+	char *pBlock;
+	long k;
+
+	memset(pSolver, 0, sizeof(IslandSolver));
+	pSolver->mCapacity = Capacity;
+	pSolver->mThreaded = 1;
+	WorkerPoolStart();
+
+	// Every per slot array shares one block
+	pBlock = (char *)calloc(1, Capacity * (14 * sizeof(float) + 9 * sizeof(long) + sizeof(unsigned char)) + 3 * sizeof(long));
+	AE_ASSERT_ALLOC(pBlock);
+
+	pSolver->mpPosX = (float *)pBlock;				pBlock += Capacity * sizeof(float);
+	pSolver->mpPosY = (float *)pBlock;				pBlock += Capacity * sizeof(float);
+	pSolver->mpVelX = (float *)pBlock;				pBlock += Capacity * sizeof(float);
+	pSolver->mpVelY = (float *)pBlock;				pBlock += Capacity * sizeof(float);
+	pSolver->mpRadius = (float *)pBlock;			pBlock += Capacity * sizeof(float);
+	pSolver->mpInvMass = (float *)pBlock;			pBlock += Capacity * sizeof(float);
+	pSolver->mpSleepVelX = (float *)pBlock;			pBlock += Capacity * sizeof(float);
+	pSolver->mpSleepVelY = (float *)pBlock;			pBlock += Capacity * sizeof(float);
+	pSolver->mpRestTime = (float *)pBlock;			pBlock += Capacity * sizeof(float);
+	pSolver->mpMinX = (float *)pBlock;				pBlock += Capacity * sizeof(float);
+	pSolver->mpSortedMinX = (float *)pBlock;		pBlock += Capacity * sizeof(float);
+	pSolver->mpSortedPosX = (float *)pBlock;		pBlock += Capacity * sizeof(float);
+	pSolver->mpSortedPosY = (float *)pBlock;		pBlock += Capacity * sizeof(float);
+	pSolver->mpSortedRadius = (float *)pBlock;		pBlock += Capacity * sizeof(float);
+	pSolver->mpSleepIsland = (long *)pBlock;		pBlock += Capacity * sizeof(long);
+	pSolver->mpOrder = (long *)pBlock;				pBlock += Capacity * sizeof(long);
+	pSolver->mpSortedSleepIsland = (long *)pBlock;	pBlock += Capacity * sizeof(long);
+	pSolver->mpParent = (long *)pBlock;				pBlock += Capacity * sizeof(long);
+	pSolver->mpIsland = (long *)pBlock;				pBlock += Capacity * sizeof(long);
+	pSolver->mpBodyOrder = (long *)pBlock;			pBlock += Capacity * sizeof(long);
+	pSolver->mpIslandContactStart = (long *)pBlock;	pBlock += (Capacity + 1) * sizeof(long);
+	pSolver->mpIslandBodyStart = (long *)pBlock;	pBlock += (Capacity + 1) * sizeof(long);
+	pSolver->mpCursor = (long *)pBlock;				pBlock += (Capacity + 1) * sizeof(long);
+	pSolver->mpWake = (unsigned char *)pBlock;
+
+	pSolver->mContactCapacity = Capacity;
+	pSolver->mpContactA = (long *)malloc(Capacity * sizeof(long));
+	pSolver->mpContactB = (long *)malloc(Capacity * sizeof(long));
+	pSolver->mpContactOrder = (long *)malloc(Capacity * sizeof(long));
+	AE_ASSERT_ALLOC(pSolver->mpContactA && pSolver->mpContactB && pSolver->mpContactOrder);
+
+	for (k = 0; k < Capacity; k++)
+		pSolver->mpOrder[k] = k;
+
+	IslandSolverClear(pSolver);
+}
+
+// ---------------------------------------------------------------------------
+
+void IslandSolverFree(IslandSolver *pSolver)
+{
+	if (pSolver->mpPosX)
+		WorkerPoolStop();
+
+	// Every per slot array lives in the block starting at mpPosX
+	free(pSolver->mpPosX);
+	free(pSolver->mpContactA);
+	free(pSolver->mpContactB);
+	free(pSolver->mpContactOrder);
+
+	memset(pSolver, 0, sizeof(IslandSolver));
+}
+
+// ---------------------------------------------------------------------------
+
+void IslandSolverClear(IslandSolver *pSolver)
+{
+	long k;
+
+	memset(pSolver->mpRadius, 0, pSolver->mCapacity * sizeof(float));
+	memset(pSolver->mpRestTime, 0, pSolver->mCapacity * sizeof(float));
+	memset(pSolver->mpWake, 0, pSolver->mCapacity);
+
+	for (k = 0; k < pSolver->mCapacity; k++)
+		pSolver->mpSleepIsland[k] = ISLAND_SLEEP_NONE;
+
+	pSolver->mContactNum = 0;
+	pSolver->mIslandNum = 0;
+	pSolver->mSleepingNum = 0;
+	pSolver->mOrderStale = 1;
+}
+
+// ---------------------------------------------------------------------------
+
+void IslandSolverStep(IslandSolver *pSolver, float Dt)
+{
+	IslandJob jobs[ISLAND_THREAD_NUM];
+	long i, island;
+	int t;
+
+	// Empty slots and disturbed sleepers wake, with their whole island
+	for (i = 0; i < pSolver->mCapacity; i++)
+	{
+		if (pSolver->mpSleepIsland[i] == ISLAND_SLEEP_NONE)
+			continue;
+
+		if (pSolver->mpRadius[i] <= 0.0f
+			|| fabsf(pSolver->mpVelX[i] - pSolver->mpSleepVelX[i]) > ISLAND_WAKE_EPSILON
+			|| fabsf(pSolver->mpVelY[i] - pSolver->mpSleepVelY[i]) > ISLAND_WAKE_EPSILON)
+			IslandWake(pSolver, i);
+	}
+
+	IslandWakePropagate(pSolver);
+	IslandContactsFind(pSolver);
+	IslandWakePropagate(pSolver);
+	IslandsBuild(pSolver);
+
+	if (!pSolver->mThreaded || pSolver->mContactNum < ISLAND_PARALLEL_MIN)
+	{
+		for (island = 0; island < pSolver->mIslandNum; island++)
+			IslandSolve(pSolver, island, Dt);
+	}
+	else
+	{
+		long share = (pSolver->mContactNum + ISLAND_THREAD_NUM - 1) / ISLAND_THREAD_NUM;
+
+		// Runs of whole islands with about the same number of contacts each
+		island = 0;
+		for (t = 0; t < ISLAND_THREAD_NUM; t++)
+		{
+			jobs[t].mpSolver = pSolver;
+			jobs[t].mDt = Dt;
+			jobs[t].mIslandFirst = island;
+
+			while (island < pSolver->mIslandNum && (t == ISLAND_THREAD_NUM - 1 || pSolver->mpIslandContactStart[island] < share * (t + 1)))
+				island++;
+
+			jobs[t].mIslandEnd = island;
+		}
+
+		// Runs 1 to 3 go to the pool's workers, run 0 is solved here
+		WorkerPoolRun(IslandJobRun, jobs, sizeof(IslandJob), ISLAND_THREAD_NUM);
+	}
+
+	pSolver->mSleepingNum = 0;
+	for (i = 0; i < pSolver->mCapacity; i++)
+		if (pSolver->mpSleepIsland[i] != ISLAND_SLEEP_NONE)
+			pSolver->mSleepingNum++;
+}
+
+// ---------------------------------------------------------------------------
+
+void IslandSolverBenchmark(void)
+{
+	IslandSolver solvers[2];
+	Random random;
+	float raftX[ISLAND_BENCHMARK_RAFT_NUM], raftY[ISLAND_BENCHMARK_RAFT_NUM];
+	f64 times[2] = { 0.0, 0.0 }, start, end;
+	float dt = 1.0f / 60.0f;
+	long i, frame, s;
+
+	IslandSolverInit(solvers + 0, ISLAND_BENCHMARK_BODY_NUM);
+	IslandSolverInit(solvers + 1, ISLAND_BENCHMARK_BODY_NUM);
+	solvers[0].mThreaded = 0;
+	RandomInit(&random, 2016, 0);
+
+	// Half scattered over the bottom of the field at asteroid speeds, half in rafts of touching bodies
+	// drifting as one over the top. Each raft is shifted at random so their columns do not line up on the sweep axis
+	for (i = 0; i < ISLAND_BENCHMARK_RAFT_NUM; i++)
+	{
+		raftX[i] = RandomRange(&random, -0.25f, 0.25f);
+		raftY[i] = RandomRange(&random, -0.25f, 0.25f);
+	}
+
+	for (i = 0; i < ISLAND_BENCHMARK_BODY_NUM; i++)
+	{
+		float radius = RandomRange(&random, 5.0f, 12.0f);
+		float half = 0.5f * ISLAND_BENCHMARK_SIZE;
+
+		solvers[0].mpPosX[i] = RandomRange(&random, -half, half);
+		solvers[0].mpPosY[i] = RandomRange(&random, -half, 0.0f);
+		solvers[0].mpVelX[i] = RandomRange(&random, -40.0f, 40.0f);
+		solvers[0].mpVelY[i] = RandomRange(&random, -40.0f, 40.0f);
+
+		if (i >= ISLAND_BENCHMARK_BODY_NUM / 2)
+		{
+			long k = i - ISLAND_BENCHMARK_BODY_NUM / 2, side = ISLAND_BENCHMARK_RAFT_SIDE, raft = k / (side * side);
+			float spacing = 2.0f * ISLAND_BENCHMARK_RAFT_RADIUS - 0.1f;
+			float raftSpacing = ISLAND_BENCHMARK_SIZE / (ISLAND_BENCHMARK_RAFT_ROW_NUM + 1);
+			float raftSpacingY = half / (ISLAND_BENCHMARK_RAFT_ROW_NUM + 1);
+
+			radius = ISLAND_BENCHMARK_RAFT_RADIUS;
+			solvers[0].mpPosX[i] = -half + raftSpacing * (1 + raft % ISLAND_BENCHMARK_RAFT_ROW_NUM + raftX[raft]) + spacing * (k % side);
+			solvers[0].mpPosY[i] = raftSpacingY * (1 + raft / ISLAND_BENCHMARK_RAFT_ROW_NUM + raftY[raft]) + spacing * (k / side % side);
+			solvers[0].mpVelX[i] = 10.0f;
+			solvers[0].mpVelY[i] = 0.0f;
+		}
+
+		solvers[0].mpRadius[i] = radius;
+		solvers[0].mpInvMass[i] = 1.0f / (radius * radius);
+	}
+
+	memcpy(solvers[1].mpPosX, solvers[0].mpPosX, ISLAND_BENCHMARK_BODY_NUM * sizeof(float));
+	memcpy(solvers[1].mpPosY, solvers[0].mpPosY, ISLAND_BENCHMARK_BODY_NUM * sizeof(float));
+	memcpy(solvers[1].mpVelX, solvers[0].mpVelX, ISLAND_BENCHMARK_BODY_NUM * sizeof(float));
+	memcpy(solvers[1].mpVelY, solvers[0].mpVelY, ISLAND_BENCHMARK_BODY_NUM * sizeof(float));
+	memcpy(solvers[1].mpRadius, solvers[0].mpRadius, ISLAND_BENCHMARK_BODY_NUM * sizeof(float));
+	memcpy(solvers[1].mpInvMass, solvers[0].mpInvMass, ISLAND_BENCHMARK_BODY_NUM * sizeof(float));
+
+	for (frame = 0; frame < ISLAND_BENCHMARK_FRAME_NUM; frame++)
+	{
+		for (s = 0; s < 2; s++)
+		{
+			IslandSolver *p = solvers + s;
+
+			// The owner's integration
+			for (i = 0; i < ISLAND_BENCHMARK_BODY_NUM; i++)
+			{
+				p->mpPosX[i] += p->mpVelX[i] * dt;
+				p->mpPosY[i] += p->mpVelY[i] * dt;
+			}
+
+			AEGetTime(&start);
+			IslandSolverStep(p, dt);
+			AEGetTime(&end);
+			times[s] += end - start;
+		}
+	}
+
+	StartupPrintf("Islands: %d bodies x %d frames, %.3f ms per step (1 thread) / %.3f ms (%d threads), %s\n",
+		ISLAND_BENCHMARK_BODY_NUM, ISLAND_BENCHMARK_FRAME_NUM,
+		times[0] * 1000.0 / ISLAND_BENCHMARK_FRAME_NUM, times[1] * 1000.0 / ISLAND_BENCHMARK_FRAME_NUM, ISLAND_THREAD_NUM,
+		memcmp(solvers[0].mpPosX, solvers[1].mpPosX, ISLAND_BENCHMARK_BODY_NUM * sizeof(float)) == 0 ? "deterministic" : "NOT deterministic");
+	StartupPrintf("Islands: last step %ld contacts in %ld islands, %ld bodies sleeping\n",
+		solvers[1].mContactNum, solvers[1].mIslandNum, solvers[1].mSleepingNum);
+
+	IslandSolverFree(solvers + 0);
+	IslandSolverFree(solvers + 1);
+}
@@ -0,0 +1,168 @@
+/* Start Header -------------------------------------------------------
+Copyright MeshBuilder.c
+Purpose:  Implementation of the bulk mesh builder
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_MeshBuilder.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "MeshBuilder.h"
+#include "Startup.h"
+#include <math.h>
+
+#define MESH_BENCHMARK_NUM			10000
+#define MESH_BENCHMARK_OUTLINE_MAX	32					// Outline points of a benchmark asteroid
+
+// ---------------------------------------------------------------------------
+
+static unsigned long MeshVertexHash(const MeshVertex *pVertex)
+{
+	const unsigned char *pBytes = (const unsigned char *)pVertex;
+	unsigned long hash = 2166136261u;
+	unsigned long i;
+
+	// FNV-1a over the raw vertex, identical vertices are bitwise identical
+	for (i = 0; i < sizeof(MeshVertex); i++)
+		hash = (hash ^ pBytes[i]) * 16777619u;
+
+	return hash;
+}
+
+// ---------------------------------------------------------------------------
+
+AEGfxVertexList* MeshCreate(const MeshVertex *pVertices, unsigned long VertexNum, const unsigned short *pIndices, unsigned long IndexNum)
+{
+	unsigned long i, num = pIndices ? IndexNum : VertexNum;
+
+	AE_ASSERT_MESG(num % 3 == 0, "MeshCreate expects a triangle list");
+
+	AEGfxMeshStart();
+
+	// The engine only takes vertices one at a time, this is the single place that feeds it
+	for (i = 0; i < num; i++)
+	{
+		const MeshVertex *pVertex = pVertices + (pIndices ? pIndices[i] : i);
+		AEGfxVertexAdd(pVertex->mX, pVertex->mY, pVertex->mColor, pVertex->mU, pVertex->mV);
+	}
+
+	return AEGfxMeshEnd();
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned long MeshDeduplicate(const MeshVertex *pVertices, unsigned long VertexNum, MeshVertex *pOutVertices, unsigned short *pOutIndices)
+{
+	unsigned long tableSize = 16, mask, i, uniqueNum = 0;
+	long *pTable;
+
+	AE_ASSERT_MESG(VertexNum <= 0xFFFF, "MeshDeduplicate uses 16 bit indices");
+
+	while (tableSize < 2 * VertexNum)
+		tableSize <<= 1;
+	mask = tableSize - 1;
+
+	// Open addressing, -1 marks an empty bucket
+	pTable = (long *)malloc(tableSize * sizeof(long));
+	AE_ASSERT_ALLOC(pTable);
+	memset(pTable, 0xFF, tableSize * sizeof(long));
+
+	for (i = 0; i < VertexNum; i++)
+	{
+		unsigned long bucket = MeshVertexHash(pVertices + i) & mask;
+
+		while (pTable[bucket] >= 0 && memcmp(pOutVertices + pTable[bucket], pVertices + i, sizeof(MeshVertex)) != 0)
+			bucket = (bucket + 1) & mask;
+
+		if (pTable[bucket] < 0)
+		{
+			pOutVertices[uniqueNum] = pVertices[i];
+			pTable[bucket] = uniqueNum++;
+		}
+
+		pOutIndices[i] = (unsigned short)pTable[bucket];
+	}
+
+	free(pTable);
+
+	return uniqueNum;
+}
+
+// ---------------------------------------------------------------------------
+
+void MeshBuilderBenchmark(void)
+{
+	MeshVertex triangles[3 * MESH_BENCHMARK_OUTLINE_MAX];
+	MeshVertex unique[3 * MESH_BENCHMARK_OUTLINE_MAX];
+	unsigned short indices[3 * MESH_BENCHMARK_OUTLINE_MAX];
+	AEGfxVertexList **ppMeshes = (AEGfxVertexList **)malloc(MESH_BENCHMARK_NUM * sizeof(AEGfxVertexList *));
+	f64 start, end, triAddTime, meshCreateTime = 0.0;
+	unsigned long m, i, vertexTotal = 0, uniqueTotal = 0;
+
+	AE_ASSERT_ALLOC(ppMeshes);
+
+	for (m = 0; m < MESH_BENCHMARK_NUM; m++)
+	{
+		unsigned long outlineNum = MESH_BENCHMARK_OUTLINE_MAX / 2 + m % (MESH_BENCHMARK_OUTLINE_MAX / 2);
+		unsigned long uniqueNum;
+		float prevX = 0.0f, prevY = 0.0f, firstX = 0.0f, firstY = 0.0f;
+
+		// Fan of a jittered circle around the origin
+		for (i = 0; i <= outlineNum; i++)
+		{
+			float angle = (TWO_PI * (i % outlineNum)) / outlineNum;
+			float radius = (i == outlineNum) ? 0.0f : 0.35f + 0.15f * AERandFloat();
+			float x = (i == outlineNum) ? firstX : radius * cosf(angle);
+			float y = (i == outlineNum) ? firstY : radius * sinf(angle);
+			MeshVertex *pTri = triangles + 3 * (i - 1);
+
+			if (i == 0)
+			{
+				firstX = prevX = x;
+				firstY = prevY = y;
+				continue;
+			}
+
+			pTri[0].mX = 0.0f;	pTri[0].mY = 0.0f;	pTri[0].mColor = 0xFF808080;	pTri[0].mU = pTri[0].mV = 0.0f;
+			pTri[1].mX = prevX;	pTri[1].mY = prevY;	pTri[1].mColor = 0xFFFFFF00;	pTri[1].mU = pTri[1].mV = 0.0f;
+			pTri[2].mX = x;		pTri[2].mY = y;		pTri[2].mColor = 0xFFFFFF00;	pTri[2].mU = pTri[2].mV = 0.0f;
+
+			prevX = x;
+			prevY = y;
+		}
+
+		AEGetTime(&start);
+		uniqueNum = MeshDeduplicate(triangles, 3 * outlineNum, unique, indices);
+		ppMeshes[m] = MeshCreate(unique, uniqueNum, indices, 3 * outlineNum);
+		AEGetTime(&end);
+
+		meshCreateTime += end - start;
+		vertexTotal += 3 * outlineNum;
+		uniqueTotal += uniqueNum;
+	}
+
+	for (m = 0; m < MESH_BENCHMARK_NUM; m++)
+		AEGfxMeshFree(ppMeshes[m]);
+
+	// Same meshes through the per triangle path, for comparison
+	AEGetTime(&start);
+	for (m = 0; m < MESH_BENCHMARK_NUM; m++)
+	{
+		AEGfxMeshStart();
+		for (i = 0; i < vertexTotal / MESH_BENCHMARK_NUM / 3; i++)
+			AEGfxTriAdd(0.0f, 0.0f, 0xFF808080, 0.0f, 0.0f,
+				0.5f, 0.0f, 0xFFFFFF00, 0.0f, 0.0f,
+				0.0f, 0.5f, 0xFFFFFF00, 0.0f, 0.0f);
+		ppMeshes[m] = AEGfxMeshEnd();
+	}
+	AEGetTime(&end);
+	triAddTime = end - start;
+
+	for (m = 0; m < MESH_BENCHMARK_NUM; m++)
+		AEGfxMeshFree(ppMeshes[m]);
+	free(ppMeshes);
+
+	StartupPrintf("MeshCreate: %d meshes, %lu vertices (%lu unique) in %.2f ms, AEGfxTriAdd loop %.2f ms\n",
+		MESH_BENCHMARK_NUM, vertexTotal, uniqueTotal, meshCreateTime * 1000.0, triAddTime * 1000.0);
+}
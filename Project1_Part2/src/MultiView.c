@@ -0,0 +1,126 @@
+/* Start Header -------------------------------------------------------
+Copyright MultiView.c
+Purpose:  Implementation of the split screen views
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_MultiView.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include <string.h>
+#include "MultiView.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#define VIEWS_USE_SSE	1
+#include <xmmintrin.h>
+#else
+#define VIEWS_USE_SSE	0
+#endif
+
+// ---------------------------------------------------------------------------
+
+void ViewsLayout(View *pViews, long ViewNum, int WinWidth, int WinHeight)
+{
+	int halfWidth = WinWidth / 2, halfHeight = WinHeight / 2;
+	long v;
+
+	memset(pViews, 0, ViewNum * sizeof(View));
+
+	for (v = 0; v < ViewNum; v++)
+	{
+		View *pView = pViews + v;
+
+		if (ViewNum == 1)
+		{
+			pView->mWidth = WinWidth;
+			pView->mHeight = WinHeight;
+		}
+		else if (ViewNum == 2)
+		{
+			pView->mX = v * halfWidth;
+			pView->mWidth = halfWidth;
+			pView->mHeight = WinHeight;
+		}
+		else
+		{
+			// Top left, top right, bottom left, bottom right
+			pView->mX = (v & 1) * halfWidth;
+			pView->mY = (v & 2) ? 0 : halfHeight;
+			pView->mWidth = halfWidth;
+			pView->mHeight = halfHeight;
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void ViewSetCamera(View *pView, float CamX, float CamY, float HalfWidth, float HalfHeight)
+{
+	pView->mCamX = CamX;
+	pView->mCamY = CamY;
+	pView->mMinX = CamX - HalfWidth;
+	pView->mMaxX = CamX + HalfWidth;
+	pView->mMinY = CamY - HalfHeight;
+	pView->mMaxY = CamY + HalfHeight;
+}
+
+// ---------------------------------------------------------------------------
+
+void ViewsCull(const View *pViews, long ViewNum, const BoundsCache *pBounds, long Count, unsigned char *pMasks)
+{
+	long i = 0, v;
+
+#if VIEWS_USE_SSE
+	__m128 viewMinX[VIEW_NUM_MAX], viewMinY[VIEW_NUM_MAX], viewMaxX[VIEW_NUM_MAX], viewMaxY[VIEW_NUM_MAX];
+
+	for (v = 0; v < ViewNum; v++)
+	{
+		viewMinX[v] = _mm_set1_ps(pViews[v].mMinX);
+		viewMinY[v] = _mm_set1_ps(pViews[v].mMinY);
+		viewMaxX[v] = _mm_set1_ps(pViews[v].mMaxX);
+		viewMaxY[v] = _mm_set1_ps(pViews[v].mMaxY);
+	}
+
+	// Each entry's box is loaded once and tested against all the views
+	for (; i + 4 <= Count; i += 4)
+	{
+		__m128 minX = _mm_loadu_ps(pBounds->mpMinX + i);
+		__m128 minY = _mm_loadu_ps(pBounds->mpMinY + i);
+		__m128 maxX = _mm_loadu_ps(pBounds->mpMaxX + i);
+		__m128 maxY = _mm_loadu_ps(pBounds->mpMaxY + i);
+		int bits[VIEW_NUM_MAX];
+		long k;
+
+		for (v = 0; v < ViewNum; v++)
+		{
+			__m128 inX = _mm_and_ps(_mm_cmple_ps(minX, viewMaxX[v]), _mm_cmpge_ps(maxX, viewMinX[v]));
+			__m128 inY = _mm_and_ps(_mm_cmple_ps(minY, viewMaxY[v]), _mm_cmpge_ps(maxY, viewMinY[v]));
+
+			bits[v] = _mm_movemask_ps(_mm_and_ps(inX, inY));
+		}
+
+		for (k = 0; k < 4; k++)
+		{
+			unsigned char mask = 0;
+
+			for (v = 0; v < ViewNum; v++)
+				mask |= ((bits[v] >> k) & 1) << v;
+
+			pMasks[i + k] = mask;
+		}
+	}
+#endif
+
+	for (; i < Count; i++)
+	{
+		unsigned char mask = 0;
+
+		for (v = 0; v < ViewNum; v++)
+			if (pBounds->mpMinX[i] <= pViews[v].mMaxX && pBounds->mpMaxX[i] >= pViews[v].mMinX
+				&& pBounds->mpMinY[i] <= pViews[v].mMaxY && pBounds->mpMaxY[i] >= pViews[v].mMinY)
+				mask |= 1 << v;
+
+		pMasks[i] = mask;
+	}
+}
@@ -0,0 +1,1006 @@
+/* Start Header -------------------------------------------------------
+Copyright Pipeline3D.c
+Purpose:  Implementation of the software 3D pipeline
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Pipeline3D.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include "Pipeline3D.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define PIPELINE_3D_USE_SSE	1
+#include <emmintrin.h>
+#else
+#define PIPELINE_3D_USE_SSE	0
+#endif
+
+#define PIPELINE_3D_PADDING					4				// Pixels past the end of the buffers, read by the last group of four
+
+#define PIPELINE_3D_BENCHMARK_WIDTH			1280
+#define PIPELINE_3D_BENCHMARK_HEIGHT		720
+#define PIPELINE_3D_BENCHMARK_ASTEROID_NUM	2000
+#define PIPELINE_3D_BENCHMARK_MESH_NUM		8				// Asteroid shapes, shared by the field
+#define PIPELINE_3D_BENCHMARK_FRAME_NUM		20
+#define PIPELINE_3D_BENCHMARK_FIELD			60.0f			// Half side of the cube the asteroids fill
+
+// One worker's share of a flush: every PIPELINE_3D_THREAD_NUM-th tile from its first
+typedef struct
+{
+	Pipeline3DTarget	*mpTarget;
+	long				mTileFirst, mTileStride;
+	unsigned long		mPixelTestedNum, mPixelWrittenNum;
+}Pipeline3DJob;
+
+// A vertex being clipped, the attributes the interpolation needs
+typedef struct
+{
+	float				mX, mY, mZ, mW;
+	float				mShade;
+}Pipeline3DClipVertex;
+
+// ---------------------------------------------------------------------------
+
+static double Pipeline3DTime(void)
+{
+#if defined(_WIN32)
+	LARGE_INTEGER counter, frequency;
+
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+
+	return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+
+// Uniform in [0, 1), 32 bit LCG so the shapes are the same on every platform
+static float Pipeline3DRandom(unsigned long *pState)
+{
+	*pState = (*pState * 1664525UL + 1013904223UL) & 0xFFFFFFFFUL;
+
+	return (float)(*pState >> 8) / 16777216.0f;
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DIdentity(Pipeline3DMatrix *pResult)
+{
+	memset(pResult, 0, sizeof(Pipeline3DMatrix));
+	pResult->m[0][0] = pResult->m[1][1] = pResult->m[2][2] = pResult->m[3][3] = 1.0f;
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DConcat(Pipeline3DMatrix *pResult, const Pipeline3DMatrix *pMtx0, const Pipeline3DMatrix *pMtx1)
+{
+	Pipeline3DMatrix result;
+	int i, j;
+
+	// Through a copy, Result may be one of the operands
+	for (i = 0; i < 4; i++)
+		for (j = 0; j < 4; j++)
+			result.m[i][j] = pMtx0->m[i][0] * pMtx1->m[0][j] + pMtx0->m[i][1] * pMtx1->m[1][j]
+				+ pMtx0->m[i][2] * pMtx1->m[2][j] + pMtx0->m[i][3] * pMtx1->m[3][j];
+
+	*pResult = result;
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DTranslate(Pipeline3DMatrix *pResult, float x, float y, float z)
+{
+	Pipeline3DIdentity(pResult);
+	pResult->m[0][3] = x;
+	pResult->m[1][3] = y;
+	pResult->m[2][3] = z;
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DScale(Pipeline3DMatrix *pResult, float x, float y, float z)
+{
+	Pipeline3DIdentity(pResult);
+	pResult->m[0][0] = x;
+	pResult->m[1][1] = y;
+	pResult->m[2][2] = z;
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DRotateAxisAngle(Pipeline3DMatrix *pResult, float x, float y, float z, float Angle)
+{
+	float c = cosf(Angle), s = sinf(Angle), t = 1.0f - c;
+
+	// Rodrigues
+	Pipeline3DIdentity(pResult);
+	pResult->m[0][0] = t * x * x + c;		pResult->m[0][1] = t * x * y - s * z;	pResult->m[0][2] = t * x * z + s * y;
+	pResult->m[1][0] = t * x * y + s * z;	pResult->m[1][1] = t * y * y + c;		pResult->m[1][2] = t * y * z - s * x;
+	pResult->m[2][0] = t * x * z - s * y;	pResult->m[2][1] = t * y * z + s * x;	pResult->m[2][2] = t * z * z + c;
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DLookAt(Pipeline3DMatrix *pResult, const Pipeline3DPoint *pPosition, const Pipeline3DPoint *pTarget, const Pipeline3DPoint *pUp)
+{
+	float fx = pTarget->x - pPosition->x, fy = pTarget->y - pPosition->y, fz = pTarget->z - pPosition->z;
+	float rx, ry, rz, ux, uy, uz, length;
+
+	// Forward, right = forward x up, then the true up = right x forward
+	length = sqrtf(fx * fx + fy * fy + fz * fz);
+	fx /= length;
+	fy /= length;
+	fz /= length;
+
+	rx = fy * pUp->z - fz * pUp->y;
+	ry = fz * pUp->x - fx * pUp->z;
+	rz = fx * pUp->y - fy * pUp->x;
+	length = sqrtf(rx * rx + ry * ry + rz * rz);
+	rx /= length;
+	ry /= length;
+	rz /= length;
+
+	ux = ry * fz - rz * fy;
+	uy = rz * fx - rx * fz;
+	uz = rx * fy - ry * fx;
+
+	// The rows are the camera axes, the camera looks down -z
+	Pipeline3DIdentity(pResult);
+	pResult->m[0][0] = rx;	pResult->m[0][1] = ry;	pResult->m[0][2] = rz;
+	pResult->m[1][0] = ux;	pResult->m[1][1] = uy;	pResult->m[1][2] = uz;
+	pResult->m[2][0] = -fx;	pResult->m[2][1] = -fy;	pResult->m[2][2] = -fz;
+	pResult->m[0][3] = -(rx * pPosition->x + ry * pPosition->y + rz * pPosition->z);
+	pResult->m[1][3] = -(ux * pPosition->x + uy * pPosition->y + uz * pPosition->z);
+	pResult->m[2][3] = fx * pPosition->x + fy * pPosition->y + fz * pPosition->z;
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DPerspective(Pipeline3DMatrix *pResult, float FovY, float AspectRatio, float Near, float Far)
+{
+	float f = 1.0f / tanf(0.5f * FovY);
+
+	memset(pResult, 0, sizeof(Pipeline3DMatrix));
+	pResult->m[0][0] = f / AspectRatio;
+	pResult->m[1][1] = f;
+	pResult->m[2][2] = (Far + Near) / (Near - Far);
+	pResult->m[2][3] = 2.0f * Far * Near / (Near - Far);
+	pResult->m[3][2] = -1.0f;
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DNormalMatrix(Pipeline3DMatrix *pResult, const Pipeline3DMatrix *pInput)
+{
+	const float (*m)[4] = pInput->m;
+	float c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+	float c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+	float c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+	float determinant = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+	float inverse = determinant != 0.0f ? 1.0f / determinant : 0.0f;
+
+	// The inverse transpose is the cofactor matrix over the determinant
+	Pipeline3DIdentity(pResult);
+	pResult->m[0][0] = c00 * inverse;
+	pResult->m[0][1] = c01 * inverse;
+	pResult->m[0][2] = c02 * inverse;
+	pResult->m[1][0] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * inverse;
+	pResult->m[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * inverse;
+	pResult->m[1][2] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * inverse;
+	pResult->m[2][0] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * inverse;
+	pResult->m[2][1] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * inverse;
+	pResult->m[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * inverse;
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DTargetInit(Pipeline3DTarget *pTarget, long Width, long Height)
+{
+	float light;
+
+	memset(pTarget, 0, sizeof(Pipeline3DTarget));
+	pTarget->mWidth = Width;
+	pTarget->mHeight = Height;
+	pTarget->mTileNumX = (Width + PIPELINE_3D_TILE_SIZE - 1) >> PIPELINE_3D_TILE_SHIFT;
+	pTarget->mTileNumY = (Height + PIPELINE_3D_TILE_SIZE - 1) >> PIPELINE_3D_TILE_SHIFT;
+	pTarget->mThreaded = 1;
+
+	pTarget->mpColor = (unsigned int *)calloc(Width * Height + PIPELINE_3D_PADDING, sizeof(unsigned int));
+	pTarget->mpDepth = (float *)calloc(Width * Height + PIPELINE_3D_PADDING, sizeof(float));
+	pTarget->mpBinStart = (long *)malloc((pTarget->mTileNumX * pTarget->mTileNumY + 1) * sizeof(long));
+
+	// Over the left shoulder of the camera
+	light = sqrtf(0.4f * 0.4f + 0.6f * 0.6f + 0.7f * 0.7f);
+	pTarget->mLightX = -0.4f / light;
+	pTarget->mLightY = 0.6f / light;
+	pTarget->mLightZ = 0.7f / light;
+
+	Pipeline3DClear(pTarget, 0xFF000000);
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DTargetFree(Pipeline3DTarget *pTarget)
+{
+	free(pTarget->mpColor);
+	free(pTarget->mpDepth);
+	free(pTarget->mpVertices);
+	free(pTarget->mpTriangles);
+	free(pTarget->mpPairTiles);
+	free(pTarget->mpPairTriangles);
+	free(pTarget->mpBinStart);
+	free(pTarget->mpBinItems);
+
+	memset(pTarget, 0, sizeof(Pipeline3DTarget));
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DClear(Pipeline3DTarget *pTarget, unsigned int Color)
+{
+	long i, n = pTarget->mWidth * pTarget->mHeight;
+
+	for (i = 0; i < n; i++)
+	{
+		pTarget->mpColor[i] = Color;
+		pTarget->mpDepth[i] = 1.0f;
+	}
+
+	pTarget->mTriangleNum = 0;
+	pTarget->mPairNum = 0;
+	memset(&pTarget->mStats, 0, sizeof(Pipeline3DStats));
+}
+
+// ---------------------------------------------------------------------------
+
+// Clip position and shade of Num vertices, four at a time: the points are transposed so each
+// register holds one coordinate of four of them, and each output row is four multiply-adds
+static void Pipeline3DVerticesTransform(Pipeline3DTarget *p, const Pipeline3DMesh *pMesh, const Pipeline3DMatrix *pMvp, const Pipeline3DMatrix *pNormal)
+{
+	long k, n = pMesh->mVertexNum;
+#if PIPELINE_3D_USE_SSE
+	__m128 mvp[4][4], nrm[3][3], light[3];
+	int r, c;
+
+	for (r = 0; r < 4; r++)
+		for (c = 0; c < 4; c++)
+			mvp[r][c] = _mm_set1_ps(pMvp->m[r][c]);
+	for (r = 0; r < 3; r++)
+		for (c = 0; c < 3; c++)
+			nrm[r][c] = _mm_set1_ps(pNormal->m[r][c]);
+	light[0] = _mm_set1_ps(p->mLightX);
+	light[1] = _mm_set1_ps(p->mLightY);
+	light[2] = _mm_set1_ps(p->mLightZ);
+
+	for (k = 0; k < n; k += 4)
+	{
+		Pipeline3DPoint positions[4], normals[4];
+		float out[5][4];
+		__m128 x, y, z, w, nx, ny, nz, nw, tx, ty, tz, length, diffuse;
+		long num = n - k < 4 ? n - k : 4, j;
+
+		// The last batch is padded with copies of its first point
+		for (j = 0; j < 4; j++)
+		{
+			positions[j] = pMesh->mpPositions[k + (j < num ? j : 0)];
+			normals[j] = pMesh->mpNormals[k + (j < num ? j : 0)];
+		}
+
+		x = _mm_loadu_ps(&positions[0].x);
+		y = _mm_loadu_ps(&positions[1].x);
+		z = _mm_loadu_ps(&positions[2].x);
+		w = _mm_loadu_ps(&positions[3].x);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+
+		for (r = 0; r < 4; r++)
+			_mm_storeu_ps(out[r], _mm_add_ps(_mm_add_ps(_mm_mul_ps(mvp[r][0], x), _mm_mul_ps(mvp[r][1], y)),
+				_mm_add_ps(_mm_mul_ps(mvp[r][2], z), _mm_mul_ps(mvp[r][3], w))));
+
+		nx = _mm_loadu_ps(&normals[0].x);
+		ny = _mm_loadu_ps(&normals[1].x);
+		nz = _mm_loadu_ps(&normals[2].x);
+		nw = _mm_loadu_ps(&normals[3].x);
+		_MM_TRANSPOSE4_PS(nx, ny, nz, nw);
+
+		tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nrm[0][0], nx), _mm_mul_ps(nrm[0][1], ny)), _mm_mul_ps(nrm[0][2], nz));
+		ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nrm[1][0], nx), _mm_mul_ps(nrm[1][1], ny)), _mm_mul_ps(nrm[1][2], nz));
+		tz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nrm[2][0], nx), _mm_mul_ps(nrm[2][1], ny)), _mm_mul_ps(nrm[2][2], nz));
+
+		// Lambert on the renormalized normal
+		length = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)), _mm_mul_ps(tz, tz));
+		diffuse = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, light[0]), _mm_mul_ps(ty, light[1])), _mm_mul_ps(tz, light[2]));
+		diffuse = _mm_div_ps(diffuse, _mm_sqrt_ps(_mm_max_ps(length, _mm_set1_ps(1e-12f))));
+		_mm_storeu_ps(out[4], _mm_max_ps(diffuse, _mm_setzero_ps()));
+
+		for (j = 0; j < num; j++)
+		{
+			Pipeline3DVertex *pVertex = p->mpVertices + k + j;
+
+			pVertex->mX = out[0][j];
+			pVertex->mY = out[1][j];
+			pVertex->mZ = out[2][j];
+			pVertex->mW = out[3][j];
+			pVertex->mZInCamera = out[3][j];
+			pVertex->mShade = out[4][j];
+		}
+	}
+#else
+	const float (*m)[4] = pMvp->m;
+	const float (*nm)[4] = pNormal->m;
+
+	for (k = 0; k < n; k++)
+	{
+		const Pipeline3DPoint *pP = pMesh->mpPositions + k, *pN = pMesh->mpNormals + k;
+		Pipeline3DVertex *pVertex = p->mpVertices + k;
+		float tx = nm[0][0] * pN->x + nm[0][1] * pN->y + nm[0][2] * pN->z;
+		float ty = nm[1][0] * pN->x + nm[1][1] * pN->y + nm[1][2] * pN->z;
+		float tz = nm[2][0] * pN->x + nm[2][1] * pN->y + nm[2][2] * pN->z;
+		float length = sqrtf(tx * tx + ty * ty + tz * tz), diffuse;
+
+		pVertex->mX = m[0][0] * pP->x + m[0][1] * pP->y + m[0][2] * pP->z + m[0][3] * pP->w;
+		pVertex->mY = m[1][0] * pP->x + m[1][1] * pP->y + m[1][2] * pP->z + m[1][3] * pP->w;
+		pVertex->mZ = m[2][0] * pP->x + m[2][1] * pP->y + m[2][2] * pP->z + m[2][3] * pP->w;
+		pVertex->mW = m[3][0] * pP->x + m[3][1] * pP->y + m[3][2] * pP->z + m[3][3] * pP->w;
+		pVertex->mZInCamera = pVertex->mW;
+
+		diffuse = (tx * p->mLightX + ty * p->mLightY + tz * p->mLightZ) / (length > 1e-6f ? length : 1e-6f);
+		pVertex->mShade = diffuse > 0.0f ? diffuse : 0.0f;
+	}
+#endif
+}
+
+// ---------------------------------------------------------------------------
+
+static void Pipeline3DPairAdd(Pipeline3DTarget *p, long Tile, long Triangle)
+{
+	if (p->mPairNum == p->mPairCapacity)
+	{
+		p->mPairCapacity = p->mPairCapacity ? 2 * p->mPairCapacity : 4096;
+		p->mpPairTiles = (long *)realloc(p->mpPairTiles, p->mPairCapacity * sizeof(long));
+		p->mpPairTriangles = (long *)realloc(p->mpPairTriangles, p->mPairCapacity * sizeof(long));
+		p->mpBinItems = (long *)realloc(p->mpBinItems, p->mPairCapacity * sizeof(long));
+	}
+
+	p->mpPairTiles[p->mPairNum] = Tile;
+	p->mpPairTriangles[p->mPairNum] = Triangle;
+	p->mPairNum++;
+}
+
+// ---------------------------------------------------------------------------
+
+// Perspective divide, viewport, culling and triangle setup of a clipped triangle, then binning
+static void Pipeline3DTriangleQueue(Pipeline3DTarget *p, const Pipeline3DClipVertex *pA, const Pipeline3DClipVertex *pB, const Pipeline3DClipVertex *pC, unsigned int Color)
+{
+	const Pipeline3DClipVertex *pVertices[3] = { pA, pB, pC };
+	float x[3], y[3], z[3], area, shade, minX, minY, maxX, maxY, swap;
+	long tileX, tileY, tileMinX, tileMaxX, tileMinY, tileMaxY;
+	Pipeline3DTriangle *pTriangle;
+	int k;
+
+	for (k = 0; k < 3; k++)
+	{
+		float inverseW = 1.0f / pVertices[k]->mW;
+
+		// Pixel rows go down, depth goes from 0 at the near plane to 1 at the far one
+		x[k] = (pVertices[k]->mX * inverseW * 0.5f + 0.5f) * (float)p->mWidth;
+		y[k] = (0.5f - pVertices[k]->mY * inverseW * 0.5f) * (float)p->mHeight;
+		z[k] = pVertices[k]->mZ * inverseW * 0.5f + 0.5f;
+	}
+
+	// Counter clockwise in clip space is clockwise once the rows go down: a positive area faces away
+	area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	minX = floorf(fminf(x[0], fminf(x[1], x[2])));
+	minY = floorf(fminf(y[0], fminf(y[1], y[2])));
+	maxX = ceilf(fmaxf(x[0], fmaxf(x[1], x[2])));
+	maxY = ceilf(fmaxf(y[0], fmaxf(y[1], y[2])));
+
+	if (area >= 0.0f || maxX < 0.0f || maxY < 0.0f || minX >= (float)p->mWidth || minY >= (float)p->mHeight)
+	{
+		p->mStats.mCulledNum++;
+		return;
+	}
+
+	// Swapped to a positive winding: inside is where every edge function is positive
+	swap = x[1];	x[1] = x[2];	x[2] = swap;
+	swap = y[1];	y[1] = y[2];	y[2] = swap;
+	swap = z[1];	z[1] = z[2];	z[2] = swap;
+	area = -area;
+
+	if (p->mTriangleNum == p->mTriangleCapacity)
+	{
+		p->mTriangleCapacity = p->mTriangleCapacity ? 2 * p->mTriangleCapacity : 4096;
+		p->mpTriangles = (Pipeline3DTriangle *)realloc(p->mpTriangles, p->mTriangleCapacity * sizeof(Pipeline3DTriangle));
+	}
+
+	pTriangle = p->mpTriangles + p->mTriangleNum;
+	pTriangle->mX0 = x[0];	pTriangle->mY0 = y[0];
+	pTriangle->mX1 = x[1];	pTriangle->mY1 = y[1];
+	pTriangle->mX2 = x[2];	pTriangle->mY2 = y[2];
+	pTriangle->mZ0 = z[0];
+	pTriangle->mDzDx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+	pTriangle->mDzDy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+	pTriangle->mMinX = minX > 0.0f ? (long)minX : 0;
+	pTriangle->mMinY = minY > 0.0f ? (long)minY : 0;
+	pTriangle->mMaxX = maxX < (float)(p->mWidth - 1) ? (long)maxX : p->mWidth - 1;
+	pTriangle->mMaxY = maxY < (float)(p->mHeight - 1) ? (long)maxY : p->mHeight - 1;
+
+	// Flat shading: the light of the face is the mean of its vertices'
+	shade = PIPELINE_3D_AMBIENT + (1.0f - PIPELINE_3D_AMBIENT) * (pA->mShade + pB->mShade + pC->mShade) / 3.0f;
+	pTriangle->mColor = (Color & 0xFF000000)
+		| ((unsigned int)(((Color >> 16) & 0xFF) * shade) << 16)
+		| ((unsigned int)(((Color >> 8) & 0xFF) * shade) << 8)
+		| (unsigned int)((Color & 0xFF) * shade);
+
+	tileMinX = pTriangle->mMinX >> PIPELINE_3D_TILE_SHIFT;
+	tileMaxX = pTriangle->mMaxX >> PIPELINE_3D_TILE_SHIFT;
+	tileMinY = pTriangle->mMinY >> PIPELINE_3D_TILE_SHIFT;
+	tileMaxY = pTriangle->mMaxY >> PIPELINE_3D_TILE_SHIFT;
+
+	for (tileY = tileMinY; tileY <= tileMaxY; tileY++)
+		for (tileX = tileMinX; tileX <= tileMaxX; tileX++)
+			Pipeline3DPairAdd(p, tileY * p->mTileNumX + tileX, p->mTriangleNum);
+
+	p->mTriangleNum++;
+}
+
+// ---------------------------------------------------------------------------
+
+static void Pipeline3DClipVertexLerp(Pipeline3DClipVertex *pResult, const Pipeline3DClipVertex *pA, const Pipeline3DClipVertex *pB, float t)
+{
+	pResult->mX = pA->mX + (pB->mX - pA->mX) * t;
+	pResult->mY = pA->mY + (pB->mY - pA->mY) * t;
+	pResult->mZ = pA->mZ + (pB->mZ - pA->mZ) * t;
+	pResult->mW = pA->mW + (pB->mW - pA->mW) * t;
+	pResult->mShade = pA->mShade + (pB->mShade - pA->mShade) * t;
+}
+
+// ---------------------------------------------------------------------------
+
+// Sutherland-Hodgman against the near plane z = -w. The other planes need no clipping:
+// the depth test drops what is past the far plane, the pixel box is cut to the target
+static void Pipeline3DTriangleClip(Pipeline3DTarget *p, const Pipeline3DVertex *pA, const Pipeline3DVertex *pB, const Pipeline3DVertex *pC, unsigned int Color)
+{
+	const Pipeline3DVertex *pIn[3] = { pA, pB, pC };
+	Pipeline3DClipVertex in[3], out[4];
+	float distance[3];
+	int k, outNum = 0, insideNum = 0;
+
+	for (k = 0; k < 3; k++)
+	{
+		in[k].mX = pIn[k]->mX;
+		in[k].mY = pIn[k]->mY;
+		in[k].mZ = pIn[k]->mZ;
+		in[k].mW = pIn[k]->mW;
+		in[k].mShade = pIn[k]->mShade;
+		distance[k] = pIn[k]->mZ + pIn[k]->mW;
+		insideNum += distance[k] >= 0.0f;
+	}
+
+	// Every vertex left or right, above or below the frustum: off screen
+	if (insideNum == 0
+		|| (pA->mX > pA->mW && pB->mX > pB->mW && pC->mX > pC->mW)
+		|| (pA->mX < -pA->mW && pB->mX < -pB->mW && pC->mX < -pC->mW)
+		|| (pA->mY > pA->mW && pB->mY > pB->mW && pC->mY > pC->mW)
+		|| (pA->mY < -pA->mW && pB->mY < -pB->mW && pC->mY < -pC->mW))
+	{
+		p->mStats.mCulledNum++;
+		return;
+	}
+
+	if (insideNum == 3)
+	{
+		Pipeline3DTriangleQueue(p, in + 0, in + 1, in + 2, Color);
+		return;
+	}
+
+	for (k = 0; k < 3; k++)
+	{
+		int next = (k + 1) % 3;
+
+		if (distance[k] >= 0.0f)
+			out[outNum++] = in[k];
+
+		if ((distance[k] >= 0.0f) != (distance[next] >= 0.0f))
+			Pipeline3DClipVertexLerp(out + outNum++, in + k, in + next, distance[k] / (distance[k] - distance[next]));
+	}
+
+	p->mStats.mClippedNum++;
+
+	// One vertex in gives a triangle, two give a quad split in two
+	Pipeline3DTriangleQueue(p, out + 0, out + 1, out + 2, Color);
+	if (outNum == 4)
+		Pipeline3DTriangleQueue(p, out + 0, out + 2, out + 3, Color);
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DDrawMesh(Pipeline3DTarget *pTarget, const Pipeline3DMesh *pMesh,
+	const Pipeline3DMatrix *pModelView, const Pipeline3DMatrix *pProjection, unsigned int Color)
+{
+	Pipeline3DMatrix mvp, normal;
+	long t;
+
+	if (pMesh->mVertexNum > pTarget->mVertexCapacity)
+	{
+		pTarget->mVertexCapacity = pMesh->mVertexNum;
+		pTarget->mpVertices = (Pipeline3DVertex *)realloc(pTarget->mpVertices, pTarget->mVertexCapacity * sizeof(Pipeline3DVertex));
+	}
+
+	Pipeline3DConcat(&mvp, pProjection, pModelView);
+	Pipeline3DNormalMatrix(&normal, pModelView);
+	Pipeline3DVerticesTransform(pTarget, pMesh, &mvp, &normal);
+
+	for (t = 0; t < pMesh->mTriangleNum; t++)
+	{
+		const unsigned short *pIndices = pMesh->mpIndices + 3 * t;
+
+		Pipeline3DTriangleClip(pTarget, pTarget->mpVertices + pIndices[0], pTarget->mpVertices + pIndices[1], pTarget->mpVertices + pIndices[2], Color);
+	}
+
+	pTarget->mStats.mVertexNum += pMesh->mVertexNum;
+	pTarget->mStats.mTriangleNum += pMesh->mTriangleNum;
+}
+
+// ---------------------------------------------------------------------------
+
+#if PIPELINE_3D_USE_SSE
+static const unsigned char sBitCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+#endif
+
+// Edge functions stepped across the part of the triangle's box inside the tile.
+// Pixel centers on a shared edge are drawn by both triangles, the depth test keeps one
+static void Pipeline3DTileRaster(Pipeline3DTarget *p, long Tile, Pipeline3DJob *pJob)
+{
+	long tileX = (Tile % p->mTileNumX) << PIPELINE_3D_TILE_SHIFT;
+	long tileY = (Tile / p->mTileNumX) << PIPELINE_3D_TILE_SHIFT;
+	long item, x, y;
+
+	for (item = p->mpBinStart[Tile]; item < p->mpBinStart[Tile + 1]; item++)
+	{
+		const Pipeline3DTriangle *pT = p->mpTriangles + p->mpBinItems[item];
+		long minX = pT->mMinX > tileX ? pT->mMinX : tileX;
+		long minY = pT->mMinY > tileY ? pT->mMinY : tileY;
+		long maxX = pT->mMaxX < tileX + PIPELINE_3D_TILE_SIZE - 1 ? pT->mMaxX : tileX + PIPELINE_3D_TILE_SIZE - 1;
+		long maxY = pT->mMaxY < tileY + PIPELINE_3D_TILE_SIZE - 1 ? pT->mMaxY : tileY + PIPELINE_3D_TILE_SIZE - 1;
+
+		// E(a, b, p) = (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x), stepped by its derivatives
+		float dx0 = -(pT->mY1 - pT->mY0), dy0 = pT->mX1 - pT->mX0;
+		float dx1 = -(pT->mY2 - pT->mY1), dy1 = pT->mX2 - pT->mX1;
+		float dx2 = -(pT->mY0 - pT->mY2), dy2 = pT->mX0 - pT->mX2;
+		float px = (float)minX + 0.5f, py = (float)minY + 0.5f;
+		float row0 = dy0 * (py - pT->mY0) + dx0 * (px - pT->mX0);
+		float row1 = dy1 * (py - pT->mY1) + dx1 * (px - pT->mX1);
+		float row2 = dy2 * (py - pT->mY2) + dx2 * (px - pT->mX2);
+		float rowZ = pT->mZ0 + pT->mDzDx * (px - pT->mX0) + pT->mDzDy * (py - pT->mY0);
+
+#if PIPELINE_3D_USE_SSE
+		// Four pixels at a time. The last group of a row may run past the box, those lanes are
+		// masked off, and the buffers are padded so they can be read
+		__m128 step = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f), zero = _mm_setzero_ps();
+		__m128 step0 = _mm_set1_ps(4.0f * dx0), step1 = _mm_set1_ps(4.0f * dx1), step2 = _mm_set1_ps(4.0f * dx2), stepZ = _mm_set1_ps(4.0f * pT->mDzDx);
+		__m128 color = _mm_castsi128_ps(_mm_set1_epi32((int)pT->mColor));
+		__m128 lanes0 = _mm_mul_ps(step, _mm_set1_ps(dx0)), lanes1 = _mm_mul_ps(step, _mm_set1_ps(dx1));
+		__m128 lanes2 = _mm_mul_ps(step, _mm_set1_ps(dx2)), lanesZ = _mm_mul_ps(step, _mm_set1_ps(pT->mDzDx));
+		static const int sMasks[4] = { 0xF, 0x1, 0x3, 0x7 };
+
+		for (y = minY; y <= maxY; y++)
+		{
+			__m128 e0 = _mm_add_ps(_mm_set1_ps(row0), lanes0), e1 = _mm_add_ps(_mm_set1_ps(row1), lanes1);
+			__m128 e2 = _mm_add_ps(_mm_set1_ps(row2), lanes2), z = _mm_add_ps(_mm_set1_ps(rowZ), lanesZ);
+			unsigned int *pColor = p->mpColor + y * p->mWidth;
+			float *pDepth = p->mpDepth + y * p->mWidth;
+
+			for (x = minX; x <= maxX; x += 4)
+			{
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+				int mask = _mm_movemask_ps(inside) & (maxX - x >= 3 ? 0xF : sMasks[maxX - x + 1]);
+
+				if (mask)
+				{
+					__m128 depth = _mm_loadu_ps(pDepth + x);
+					int pass = _mm_movemask_ps(_mm_cmplt_ps(z, depth)) & mask;
+
+					pJob->mPixelTestedNum += sBitCount[mask];
+
+					if (pass)
+					{
+						__m128 write = _mm_castsi128_ps(_mm_set_epi32(pass & 8 ? -1 : 0, pass & 4 ? -1 : 0, pass & 2 ? -1 : 0, pass & 1 ? -1 : 0));
+						__m128 oldColor = _mm_loadu_ps((const float *)(pColor + x));
+
+						_mm_storeu_ps(pDepth + x, _mm_or_ps(_mm_and_ps(write, z), _mm_andnot_ps(write, depth)));
+						_mm_storeu_ps((float *)(pColor + x), _mm_or_ps(_mm_and_ps(write, color), _mm_andnot_ps(write, oldColor)));
+						pJob->mPixelWrittenNum += sBitCount[pass];
+					}
+				}
+
+				e0 = _mm_add_ps(e0, step0);
+				e1 = _mm_add_ps(e1, step1);
+				e2 = _mm_add_ps(e2, step2);
+				z = _mm_add_ps(z, stepZ);
+			}
+
+			row0 += dy0;
+			row1 += dy1;
+			row2 += dy2;
+			rowZ += pT->mDzDy;
+		}
+#else
+		for (y = minY; y <= maxY; y++)
+		{
+			float e0 = row0, e1 = row1, e2 = row2, z = rowZ;
+			unsigned int *pColor = p->mpColor + y * p->mWidth;
+			float *pDepth = p->mpDepth + y * p->mWidth;
+
+			for (x = minX; x <= maxX; x++)
+			{
+				if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f)
+				{
+					pJob->mPixelTestedNum++;
+
+					if (z < pDepth[x])
+					{
+						pDepth[x] = z;
+						pColor[x] = pT->mColor;
+						pJob->mPixelWrittenNum++;
+					}
+				}
+
+				e0 += dx0;
+				e1 += dx1;
+				e2 += dx2;
+				z += pT->mDzDx;
+			}
+
+			row0 += dy0;
+			row1 += dy1;
+			row2 += dy2;
+			rowZ += pT->mDzDy;
+		}
+#endif
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+static void Pipeline3DJobRaster(Pipeline3DJob *pJob)
+{
+	long tile, tileNum = pJob->mpTarget->mTileNumX * pJob->mpTarget->mTileNumY;
+
+	for (tile = pJob->mTileFirst; tile < tileNum; tile += pJob->mTileStride)
+		Pipeline3DTileRaster(pJob->mpTarget, tile, pJob);
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI Pipeline3DJobRun(LPVOID pParam)
+{
+	Pipeline3DJobRaster((Pipeline3DJob *)pParam);
+	return 0;
+}
+#else
+static void *Pipeline3DJobRun(void *pParam)
+{
+	Pipeline3DJobRaster((Pipeline3DJob *)pParam);
+	return 0;
+}
+#endif
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DFlush(Pipeline3DTarget *pTarget)
+{
+	Pipeline3DJob jobs[PIPELINE_3D_THREAD_NUM];
+	long tileNum = pTarget->mTileNumX * pTarget->mTileNumY, k, sum;
+	int t, jobNum = pTarget->mThreaded ? PIPELINE_3D_THREAD_NUM : 1;
+#if defined(_WIN32)
+	HANDLE threads[PIPELINE_3D_THREAD_NUM];
+#else
+	pthread_t threads[PIPELINE_3D_THREAD_NUM];
+#endif
+	int threadNum = 0;
+
+	// Counting sort of the pairs by tile, the triangles stay in draw order within a tile
+	memset(pTarget->mpBinStart, 0, (tileNum + 1) * sizeof(long));
+	for (k = 0; k < pTarget->mPairNum; k++)
+		pTarget->mpBinStart[pTarget->mpPairTiles[k] + 1]++;
+
+	for (k = 0, sum = 0; k <= tileNum; k++)
+	{
+		sum += pTarget->mpBinStart[k];
+		pTarget->mpBinStart[k] = sum;
+	}
+
+	for (k = 0; k < pTarget->mPairNum; k++)
+		pTarget->mpBinItems[pTarget->mpBinStart[pTarget->mpPairTiles[k]]++] = pTarget->mpPairTriangles[k];
+
+	// The fill moved every start to the next tile's, shift them back
+	for (k = tileNum; k > 0; k--)
+		pTarget->mpBinStart[k] = pTarget->mpBinStart[k - 1];
+	pTarget->mpBinStart[0] = 0;
+
+	// Interleaved tiles, so the busy middle of the screen is shared
+	for (t = 0; t < jobNum; t++)
+	{
+		jobs[t].mpTarget = pTarget;
+		jobs[t].mTileFirst = t;
+		jobs[t].mTileStride = jobNum;
+		jobs[t].mPixelTestedNum = 0;
+		jobs[t].mPixelWrittenNum = 0;
+	}
+
+	// Jobs 1 and up go to workers, job 0 runs here
+	for (t = 1; t < jobNum; t++)
+	{
+#if defined(_WIN32)
+		threads[threadNum] = CreateThread(NULL, 0, Pipeline3DJobRun, jobs + t, 0, NULL);
+		if (threads[threadNum])
+			++threadNum;
+		else
+			Pipeline3DJobRaster(jobs + t);
+#else
+		if (pthread_create(threads + threadNum, NULL, Pipeline3DJobRun, jobs + t) == 0)
+			++threadNum;
+		else
+			Pipeline3DJobRaster(jobs + t);
+#endif
+	}
+
+	Pipeline3DJobRaster(jobs);
+
+#if defined(_WIN32)
+	if (threadNum > 0)
+		WaitForMultipleObjects(threadNum, threads, TRUE, INFINITE);
+
+	for (t = 0; t < threadNum; t++)
+		CloseHandle(threads[t]);
+#else
+	for (t = 0; t < threadNum; t++)
+		pthread_join(threads[t], NULL);
+#endif
+
+	for (t = 0; t < jobNum; t++)
+	{
+		pTarget->mStats.mPixelTestedNum += jobs[t].mPixelTestedNum;
+		pTarget->mStats.mPixelWrittenNum += jobs[t].mPixelWrittenNum;
+	}
+
+	pTarget->mTriangleNum = 0;
+	pTarget->mPairNum = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+int Pipeline3DImageWrite(const Pipeline3DTarget *pTarget, const char *pFileName)
+{
+	FILE *pFile = fopen(pFileName, "wb");
+	long i, n = pTarget->mWidth * pTarget->mHeight;
+	int ok;
+
+	if (0 == pFile)
+		return 0;
+
+	ok = fprintf(pFile, "P6\n%ld %ld\n255\n", pTarget->mWidth, pTarget->mHeight) > 0;
+
+	for (i = 0; ok && i < n; i++)
+	{
+		unsigned char rgb[3];
+
+		rgb[0] = (unsigned char)(pTarget->mpColor[i] >> 16);
+		rgb[1] = (unsigned char)(pTarget->mpColor[i] >> 8);
+		rgb[2] = (unsigned char)pTarget->mpColor[i];
+		ok = fwrite(rgb, 3, 1, pFile) == 1;
+	}
+
+	return fclose(pFile) == 0 && ok;
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DMeshAsteroid(Pipeline3DMesh *pMesh, long Rings, long Segments, unsigned long Seed)
+{
+	float lumpX[4], lumpY[4], lumpZ[4], lumpPhase[4], lumpFrequency[4], lumpAmplitude[4];
+	unsigned long state = Seed;
+	long r, s, k, t = 0;
+
+	pMesh->mVertexNum = Rings * Segments;
+	pMesh->mTriangleNum = 2 * (Rings - 1) * Segments;
+	pMesh->mpPositions = (Pipeline3DPoint *)calloc(pMesh->mVertexNum, sizeof(Pipeline3DPoint));
+	pMesh->mpNormals = (Pipeline3DPoint *)calloc(pMesh->mVertexNum, sizeof(Pipeline3DPoint));
+	pMesh->mpIndices = (unsigned short *)malloc(3 * pMesh->mTriangleNum * sizeof(unsigned short));
+
+	// The radius is a few waves along random directions, smooth over the sphere and equal at the duplicated poles
+	for (k = 0; k < 4; k++)
+	{
+		float theta = 6.2831853f * Pipeline3DRandom(&state), cosPhi = 2.0f * Pipeline3DRandom(&state) - 1.0f;
+		float sinPhi = sqrtf(1.0f - cosPhi * cosPhi);
+
+		lumpX[k] = sinPhi * cosf(theta);
+		lumpY[k] = cosPhi;
+		lumpZ[k] = sinPhi * sinf(theta);
+		lumpPhase[k] = 6.2831853f * Pipeline3DRandom(&state);
+		lumpFrequency[k] = 1.5f + 2.5f * Pipeline3DRandom(&state);
+		lumpAmplitude[k] = 0.15f / (float)(k + 1);
+	}
+
+	for (r = 0; r < Rings; r++)
+	{
+		float latitude = 3.14159265f * (float)r / (float)(Rings - 1);
+
+		for (s = 0; s < Segments; s++)
+		{
+			float longitude = 6.2831853f * (float)s / (float)Segments;
+			float dx = sinf(latitude) * cosf(longitude), dy = cosf(latitude), dz = sinf(latitude) * sinf(longitude);
+			float radius = 1.0f;
+			Pipeline3DPoint *pP = pMesh->mpPositions + r * Segments + s;
+
+			for (k = 0; k < 4; k++)
+				radius += lumpAmplitude[k] * sinf(lumpFrequency[k] * (dx * lumpX[k] + dy * lumpY[k] + dz * lumpZ[k]) + lumpPhase[k]);
+
+			pP->x = dx * radius;
+			pP->y = dy * radius;
+			pP->z = dz * radius;
+			pP->w = 1.0f;
+		}
+	}
+
+	// Two triangles per quad between rings, counter clockwise from the outside
+	for (r = 0; r < Rings - 1; r++)
+	{
+		for (s = 0; s < Segments; s++)
+		{
+			unsigned short a = (unsigned short)(r * Segments + s), b = (unsigned short)(r * Segments + (s + 1) % Segments);
+			unsigned short c = (unsigned short)(a + Segments), d = (unsigned short)(b + Segments);
+
+			pMesh->mpIndices[t++] = a;	pMesh->mpIndices[t++] = b;	pMesh->mpIndices[t++] = c;
+			pMesh->mpIndices[t++] = b;	pMesh->mpIndices[t++] = d;	pMesh->mpIndices[t++] = c;
+		}
+	}
+
+	// Vertex normals: the sum of the area weighted normals of the faces around them
+	for (t = 0; t < pMesh->mTriangleNum; t++)
+	{
+		const unsigned short *pIndices = pMesh->mpIndices + 3 * t;
+		const Pipeline3DPoint *p0 = pMesh->mpPositions + pIndices[0], *p1 = pMesh->mpPositions + pIndices[1], *p2 = pMesh->mpPositions + pIndices[2];
+		float ux = p1->x - p0->x, uy = p1->y - p0->y, uz = p1->z - p0->z;
+		float vx = p2->x - p0->x, vy = p2->y - p0->y, vz = p2->z - p0->z;
+		float nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+
+		for (k = 0; k < 3; k++)
+		{
+			pMesh->mpNormals[pIndices[k]].x += nx;
+			pMesh->mpNormals[pIndices[k]].y += ny;
+			pMesh->mpNormals[pIndices[k]].z += nz;
+		}
+	}
+
+	for (k = 0; k < pMesh->mVertexNum; k++)
+	{
+		Pipeline3DPoint *pN = pMesh->mpNormals + k;
+		float length = sqrtf(pN->x * pN->x + pN->y * pN->y + pN->z * pN->z);
+
+		if (length > 0.0f)
+		{
+			pN->x /= length;
+			pN->y /= length;
+			pN->z /= length;
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DMeshFree(Pipeline3DMesh *pMesh)
+{
+	free(pMesh->mpPositions);
+	free(pMesh->mpNormals);
+	free(pMesh->mpIndices);
+
+	memset(pMesh, 0, sizeof(Pipeline3DMesh));
+}
+
+// ---------------------------------------------------------------------------
+
+void Pipeline3DBenchmark(double pVerticesPerSecond[2], double pPixelsPerSecond[2], const char *pFileName)
+{
+	static float sPositions[PIPELINE_3D_BENCHMARK_ASTEROID_NUM][3], sAxes[PIPELINE_3D_BENCHMARK_ASTEROID_NUM][3];
+	static float sSizes[PIPELINE_3D_BENCHMARK_ASTEROID_NUM], sSpins[PIPELINE_3D_BENCHMARK_ASTEROID_NUM];
+	Pipeline3DMesh meshes[PIPELINE_3D_BENCHMARK_MESH_NUM];
+	Pipeline3DTarget target;
+	Pipeline3DMatrix view, projection;
+	Pipeline3DPoint eye = { 0.0f, 20.0f, 110.0f, 1.0f }, center = { 0.0f, 0.0f, 0.0f, 1.0f }, up = { 0.0f, 1.0f, 0.0f, 0.0f };
+	unsigned long state = 2016;
+	long i, frame;
+	int run;
+
+	for (i = 0; i < PIPELINE_3D_BENCHMARK_MESH_NUM; i++)
+		Pipeline3DMeshAsteroid(meshes + i, 12, 18, 1000 + i);
+
+	for (i = 0; i < PIPELINE_3D_BENCHMARK_ASTEROID_NUM; i++)
+	{
+		float length;
+
+		sPositions[i][0] = PIPELINE_3D_BENCHMARK_FIELD * (2.0f * Pipeline3DRandom(&state) - 1.0f);
+		sPositions[i][1] = PIPELINE_3D_BENCHMARK_FIELD * (2.0f * Pipeline3DRandom(&state) - 1.0f);
+		sPositions[i][2] = PIPELINE_3D_BENCHMARK_FIELD * (2.0f * Pipeline3DRandom(&state) - 1.0f);
+		sAxes[i][0] = 2.0f * Pipeline3DRandom(&state) - 1.0f;
+		sAxes[i][1] = 2.0f * Pipeline3DRandom(&state) - 1.0f;
+		sAxes[i][2] = 2.0f * Pipeline3DRandom(&state) - 1.0f;
+		length = sqrtf(sAxes[i][0] * sAxes[i][0] + sAxes[i][1] * sAxes[i][1] + sAxes[i][2] * sAxes[i][2]) + 1e-6f;
+		sAxes[i][0] /= length;
+		sAxes[i][1] /= length;
+		sAxes[i][2] /= length;
+		sSizes[i] = 0.8f + 2.5f * Pipeline3DRandom(&state);
+		sSpins[i] = 2.0f * Pipeline3DRandom(&state) - 1.0f;
+	}
+
+	Pipeline3DTargetInit(&target, PIPELINE_3D_BENCHMARK_WIDTH, PIPELINE_3D_BENCHMARK_HEIGHT);
+	Pipeline3DLookAt(&view, &eye, &center, &up);
+	Pipeline3DPerspective(&projection, 1.0f, (float)PIPELINE_3D_BENCHMARK_WIDTH / (float)PIPELINE_3D_BENCHMARK_HEIGHT, 1.0f, 500.0f);
+
+	// Run 0 on the calling thread, run 1 on PIPELINE_3D_THREAD_NUM threads, the same frames
+	for (run = 0; run < 2; run++)
+	{
+		double vertexTime = 0.0, rasterTime = 0.0, start;
+		unsigned long vertexNum = 0, pixelNum = 0;
+
+		target.mThreaded = run;
+
+		for (frame = 0; frame < PIPELINE_3D_BENCHMARK_FRAME_NUM; frame++)
+		{
+			Pipeline3DClear(&target, 0xFF000000);
+
+			start = Pipeline3DTime();
+			for (i = 0; i < PIPELINE_3D_BENCHMARK_ASTEROID_NUM; i++)
+			{
+				Pipeline3DMatrix model, modelView, scale;
+
+				Pipeline3DScale(&scale, sSizes[i], sSizes[i], sSizes[i]);
+				Pipeline3DRotateAxisAngle(&model, sAxes[i][0], sAxes[i][1], sAxes[i][2], sSpins[i] * (float)frame * 0.05f);
+				Pipeline3DConcat(&model, &model, &scale);
+				model.m[0][3] = sPositions[i][0];
+				model.m[1][3] = sPositions[i][1];
+				model.m[2][3] = sPositions[i][2];
+				Pipeline3DConcat(&modelView, &view, &model);
+
+				Pipeline3DDrawMesh(&target, meshes + i % PIPELINE_3D_BENCHMARK_MESH_NUM, &modelView, &projection, 0xFFB0A090);
+			}
+			vertexTime += Pipeline3DTime() - start;
+
+			start = Pipeline3DTime();
+			Pipeline3DFlush(&target);
+			rasterTime += Pipeline3DTime() - start;
+
+			vertexNum += target.mStats.mVertexNum;
+			pixelNum += target.mStats.mPixelTestedNum;
+		}
+
+		pVerticesPerSecond[run] = vertexTime > 0.0 ? (double)vertexNum / vertexTime : 0.0;
+		pPixelsPerSecond[run] = rasterTime > 0.0 ? (double)pixelNum / rasterTime : 0.0;
+	}
+
+	if (pFileName)
+		Pipeline3DImageWrite(&target, pFileName);
+
+	Pipeline3DTargetFree(&target);
+	for (i = 0; i < PIPELINE_3D_BENCHMARK_MESH_NUM; i++)
+		Pipeline3DMeshFree(meshes + i);
+}
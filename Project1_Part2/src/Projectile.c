@@ -0,0 +1,443 @@
+/* Start Header -------------------------------------------------------
+Copyright Projectile.c
+Purpose:  Implementation of the projectile ring and its broadphase grid
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Projectile.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "Projectile.h"
+#include "MeshBuilder.h"
+#include "RenderTrace.h"
+#include "Startup.h"
+#include "Random.h"
+#include <math.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define PROJECTILE_USE_SSE	1
+#include <emmintrin.h>
+#else
+#define PROJECTILE_USE_SSE	0
+#endif
+
+#define PROJECTILE_SLOT_SIZE			(4 * sizeof(float) + sizeof(int) + sizeof(unsigned long) + sizeof(unsigned char))
+#define PROJECTILE_CELL_NUM				(PROJECTILE_GRID_DIM * PROJECTILE_GRID_DIM)
+#define PROJECTILE_BATCH_VERTEX_NUM		(6 * PROJECTILE_DRAW_BATCH)
+
+#define PROJECTILE_BENCHMARK_FRAME_NUM	300
+#define PROJECTILE_BENCHMARK_QUERY_NUM	256					// Asteroid sized boxes queried per frame
+#define PROJECTILE_BENCHMARK_HALF_X		400.0f
+#define PROJECTILE_BENCHMARK_HALF_Y		300.0f
+
+// Vertices of the mesh being built, shared by every system
+static MeshVertex						*sgpBatchVertices;
+
+// ---------------------------------------------------------------------------
+
+// Moves and culls one slot, and finds its grid cell
+static void ProjectileStepScalar(ProjectileSystem *p, unsigned long i, float Dt, float MinX, float MinY, float MaxX, float MaxY)
+{
+	float x = p->mpPosX[i] + p->mpVelX[i] * Dt;
+	float y = p->mpPosY[i] + p->mpVelY[i] * Dt;
+	long cx, cy;
+
+	p->mpPosX[i] = x;
+	p->mpPosY[i] = y;
+
+	if (x < MinX || x > MaxX || y < MinY || y > MaxY)
+	{
+		p->mpAlive[i] = 0;
+		return;
+	}
+
+	cx = (long)((x - MinX) * p->mCellScaleX);
+	cy = (long)((y - MinY) * p->mCellScaleY);
+	cx = cx < PROJECTILE_GRID_DIM - 1 ? cx : PROJECTILE_GRID_DIM - 1;
+	cy = cy < PROJECTILE_GRID_DIM - 1 ? cy : PROJECTILE_GRID_DIM - 1;
+
+	p->mpCell[i] = (int)((cy << PROJECTILE_GRID_SHIFT) + cx);
+}
+
+// ---------------------------------------------------------------------------
+
+// Moves and culls the slots of counters [Begin, End), which must not wrap
+static void ProjectileStepRange(ProjectileSystem *p, unsigned long Begin, unsigned long End, float Dt, float MinX, float MinY, float MaxX, float MaxY)
+{
+	unsigned long i = Begin;
+
+#if PROJECTILE_USE_SSE
+	const __m128 dt = _mm_set1_ps(Dt);
+	const __m128 minX = _mm_set1_ps(MinX), minY = _mm_set1_ps(MinY);
+	const __m128 maxX = _mm_set1_ps(MaxX), maxY = _mm_set1_ps(MaxY);
+	const __m128 scaleX = _mm_set1_ps(p->mCellScaleX), scaleY = _mm_set1_ps(p->mCellScaleY);
+	const __m128 lastCell = _mm_set1_ps((float)(PROJECTILE_GRID_DIM - 1));
+
+	for (; i + 4 <= End; i += 4)
+	{
+		__m128 x = _mm_add_ps(_mm_loadu_ps(p->mpPosX + i), _mm_mul_ps(_mm_loadu_ps(p->mpVelX + i), dt));
+		__m128 y = _mm_add_ps(_mm_loadu_ps(p->mpPosY + i), _mm_mul_ps(_mm_loadu_ps(p->mpVelY + i), dt));
+		__m128 out = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(x, minX), _mm_cmpgt_ps(x, maxX)), _mm_or_ps(_mm_cmplt_ps(y, minY), _mm_cmpgt_ps(y, maxY)));
+		__m128 fx = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(x, minX), scaleX), lastCell);
+		__m128 fy = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(y, minY), scaleY), lastCell);
+		__m128i cell = _mm_add_epi32(_mm_slli_epi32(_mm_cvttps_epi32(fy), PROJECTILE_GRID_SHIFT), _mm_cvttps_epi32(fx));
+		int outMask = _mm_movemask_ps(out);
+
+		_mm_storeu_ps(p->mpPosX + i, x);
+		_mm_storeu_ps(p->mpPosY + i, y);
+		_mm_storeu_si128((__m128i *)(p->mpCell + i), cell);
+
+		// The cells of culled lanes are garbage, they are never read
+		if (outMask)
+		{
+			if (outMask & 1) p->mpAlive[i] = 0;
+			if (outMask & 2) p->mpAlive[i + 1] = 0;
+			if (outMask & 4) p->mpAlive[i + 2] = 0;
+			if (outMask & 8) p->mpAlive[i + 3] = 0;
+		}
+	}
+#endif
+
+	for (; i < End; i++)
+		ProjectileStepScalar(p, i, Dt, MinX, MinY, MaxX, MaxY);
+}
+
+// ---------------------------------------------------------------------------
+
+// Counting sort of the alive slots by cell
+static void ProjectileGridBuild(ProjectileSystem *p)
+{
+	unsigned long c, i, k, sum = 0;
+
+	memset(p->mpCellStart, 0, (PROJECTILE_CELL_NUM + 1) * sizeof(unsigned long));
+
+	for (c = p->mHead; c != p->mTail; c++)
+	{
+		i = c & (p->mCapacity - 1);
+		if (p->mpAlive[i])
+			p->mpCellStart[p->mpCell[i]]++;
+	}
+
+	for (k = 0; k < PROJECTILE_CELL_NUM; k++)
+	{
+		unsigned long num = p->mpCellStart[k];
+
+		p->mpCellStart[k] = sum;
+		p->mpCellCursor[k] = sum;
+		sum += num;
+	}
+	p->mpCellStart[PROJECTILE_CELL_NUM] = sum;
+	p->mLiveNum = sum;
+
+	// Walking from the head keeps every cell oldest first
+	for (c = p->mHead; c != p->mTail; c++)
+	{
+		i = c & (p->mCapacity - 1);
+		if (p->mpAlive[i])
+			p->mpCellItems[p->mpCellCursor[p->mpCell[i]]++] = i;
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void ProjectileSystemInit(ProjectileSystem *pSystem, unsigned long Capacity)
+{
+	unsigned long n = 4;
+	char *pBlock;
+
+	while (n < Capacity)
+		n <<= 1;
+
+	memset(pSystem, 0, sizeof(ProjectileSystem));
+	pSystem->mCapacity = n;
+
+	// The per slot arrays share one block, like the bounds cache
+	pBlock = (char *)calloc(n, PROJECTILE_SLOT_SIZE);
+	AE_ASSERT_ALLOC(pBlock);
+
+	pSystem->mpPosX = (float *)pBlock;					pBlock += n * sizeof(float);
+	pSystem->mpPosY = (float *)pBlock;					pBlock += n * sizeof(float);
+	pSystem->mpVelX = (float *)pBlock;					pBlock += n * sizeof(float);
+	pSystem->mpVelY = (float *)pBlock;					pBlock += n * sizeof(float);
+	pSystem->mpCell = (int *)pBlock;					pBlock += n * sizeof(int);
+	pSystem->mpCellItems = (unsigned long *)pBlock;		pBlock += n * sizeof(unsigned long);
+	pSystem->mpAlive = (unsigned char *)pBlock;
+
+	pSystem->mpCellStart = (unsigned long *)calloc(PROJECTILE_CELL_NUM + 1, sizeof(unsigned long));
+	pSystem->mpCellCursor = (unsigned long *)malloc(PROJECTILE_CELL_NUM * sizeof(unsigned long));
+	pSystem->mppMeshes = (AEGfxVertexList **)calloc(n / PROJECTILE_DRAW_BATCH + 1, sizeof(AEGfxVertexList *));
+	AE_ASSERT_ALLOC(pSystem->mpCellStart && pSystem->mpCellCursor && pSystem->mppMeshes);
+}
+
+// ---------------------------------------------------------------------------
+
+void ProjectileSystemFree(ProjectileSystem *pSystem)
+{
+	unsigned long i;
+
+	for (i = 0; i < pSystem->mMeshNum; i++)
+		AEGfxMeshFree(pSystem->mppMeshes[i]);
+
+	// Every per slot array lives in the block starting at mpPosX
+	free(pSystem->mpPosX);
+	free(pSystem->mpCellStart);
+	free(pSystem->mpCellCursor);
+	free(pSystem->mppMeshes);
+
+	memset(pSystem, 0, sizeof(ProjectileSystem));
+}
+
+// ---------------------------------------------------------------------------
+
+void ProjectileSystemClear(ProjectileSystem *pSystem)
+{
+	memset(pSystem->mpAlive, 0, pSystem->mCapacity);
+	memset(pSystem->mpCellStart, 0, (PROJECTILE_CELL_NUM + 1) * sizeof(unsigned long));
+
+	pSystem->mHead = pSystem->mTail = 0;
+	pSystem->mLiveNum = 0;
+	pSystem->mOverwrittenNum = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+void ProjectileFire(ProjectileSystem *pSystem, float PosX, float PosY, float VelX, float VelY)
+{
+	unsigned long i = pSystem->mTail & (pSystem->mCapacity - 1);
+
+	// Full: the slot still holds the oldest bullet
+	if (pSystem->mTail - pSystem->mHead == pSystem->mCapacity)
+	{
+		if (pSystem->mpAlive[i])
+		{
+			pSystem->mOverwrittenNum++;
+			pSystem->mLiveNum--;
+		}
+		pSystem->mHead++;
+	}
+
+	pSystem->mpPosX[i] = PosX;
+	pSystem->mpPosY[i] = PosY;
+	pSystem->mpVelX[i] = VelX;
+	pSystem->mpVelY[i] = VelY;
+	pSystem->mpAlive[i] = 1;
+	pSystem->mTail++;
+	pSystem->mLiveNum++;
+}
+
+// ---------------------------------------------------------------------------
+
+void ProjectileUpdate(ProjectileSystem *pSystem, float Dt, float MinX, float MinY, float MaxX, float MaxY)
+{
+	unsigned long mask = pSystem->mCapacity - 1;
+	unsigned long begin = pSystem->mHead & mask, num = pSystem->mTail - pSystem->mHead;
+
+	pSystem->mGridMinX = MinX;
+	pSystem->mGridMinY = MinY;
+	pSystem->mGridMaxX = MaxX;
+	pSystem->mGridMaxY = MaxY;
+	pSystem->mCellScaleX = MaxX > MinX ? PROJECTILE_GRID_DIM / (MaxX - MinX) : 0.0f;
+	pSystem->mCellScaleY = MaxY > MinY ? PROJECTILE_GRID_DIM / (MaxY - MinY) : 0.0f;
+
+	// The live range is at most two runs of slots: up to the end of the arrays, then from the start
+	if (begin + num <= pSystem->mCapacity)
+	{
+		ProjectileStepRange(pSystem, begin, begin + num, Dt, MinX, MinY, MaxX, MaxY);
+	}
+	else
+	{
+		ProjectileStepRange(pSystem, begin, pSystem->mCapacity, Dt, MinX, MinY, MaxX, MaxY);
+		ProjectileStepRange(pSystem, 0, begin + num - pSystem->mCapacity, Dt, MinX, MinY, MaxX, MaxY);
+	}
+
+	// Retire the dead bullets at the head, the ones behind an alive bullet wait for it
+	while (pSystem->mHead != pSystem->mTail && 0 == pSystem->mpAlive[pSystem->mHead & mask])
+		pSystem->mHead++;
+
+	ProjectileGridBuild(pSystem);
+}
+
+// ---------------------------------------------------------------------------
+
+long ProjectileHitFind(ProjectileSystem *pSystem, float MinX, float MinY, float MaxX, float MaxY)
+{
+	long cx0, cy0, cx1, cy1, cx, cy;
+
+	if (0 == pSystem->mLiveNum || MaxX < pSystem->mGridMinX || MinX > pSystem->mGridMaxX || MaxY < pSystem->mGridMinY || MinY > pSystem->mGridMaxY)
+		return PROJECTILE_NONE;
+
+	// Cells covered by the box, clamped to the grid
+	cx0 = (long)((max(MinX, pSystem->mGridMinX) - pSystem->mGridMinX) * pSystem->mCellScaleX);
+	cy0 = (long)((max(MinY, pSystem->mGridMinY) - pSystem->mGridMinY) * pSystem->mCellScaleY);
+	cx1 = (long)((min(MaxX, pSystem->mGridMaxX) - pSystem->mGridMinX) * pSystem->mCellScaleX);
+	cy1 = (long)((min(MaxY, pSystem->mGridMaxY) - pSystem->mGridMinY) * pSystem->mCellScaleY);
+	cx1 = cx1 < PROJECTILE_GRID_DIM - 1 ? cx1 : PROJECTILE_GRID_DIM - 1;
+	cy1 = cy1 < PROJECTILE_GRID_DIM - 1 ? cy1 : PROJECTILE_GRID_DIM - 1;
+
+	for (cy = cy0; cy <= cy1; cy++)
+	{
+		for (cx = cx0; cx <= cx1; cx++)
+		{
+			unsigned long cell = (cy << PROJECTILE_GRID_SHIFT) + cx;
+			unsigned long k;
+
+			for (k = pSystem->mpCellStart[cell]; k < pSystem->mpCellStart[cell + 1]; k++)
+			{
+				unsigned long i = pSystem->mpCellItems[k];
+				float x = pSystem->mpPosX[i], y = pSystem->mpPosY[i];
+
+				if (pSystem->mpAlive[i] && x >= MinX && x <= MaxX && y >= MinY && y <= MaxY)
+					return (long)i;
+			}
+		}
+	}
+
+	return PROJECTILE_NONE;
+}
+
+// ---------------------------------------------------------------------------
+
+void ProjectileKill(ProjectileSystem *pSystem, long Slot)
+{
+	if (pSystem->mpAlive[Slot])
+	{
+		pSystem->mpAlive[Slot] = 0;
+		pSystem->mLiveNum--;
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+void ProjectileMeshBuild(ProjectileSystem *pSystem, float Size, unsigned int Color, const AtlasRegion *pRegion)
+{
+	unsigned long mask = pSystem->mCapacity - 1;
+	unsigned long c, vertexNum = 0;
+	float h = 0.5f * Size;
+	float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+
+	if (pRegion)
+	{
+		u0 = pRegion->mU0;	v0 = pRegion->mV0;
+		u1 = pRegion->mU1;	v1 = pRegion->mV1;
+	}
+
+	for (c = 0; c < pSystem->mMeshNum; c++)
+		AEGfxMeshFree(pSystem->mppMeshes[c]);
+	pSystem->mMeshNum = 0;
+
+	if (0 == sgpBatchVertices)
+	{
+		sgpBatchVertices = (MeshVertex *)calloc(PROJECTILE_BATCH_VERTEX_NUM, sizeof(MeshVertex));
+		AE_ASSERT_ALLOC(sgpBatchVertices);
+	}
+
+	for (c = pSystem->mHead; c != pSystem->mTail; c++)
+	{
+		unsigned long i = c & mask;
+		MeshVertex *pV = sgpBatchVertices + vertexNum;
+		float x = pSystem->mpPosX[i], y = pSystem->mpPosY[i];
+
+		if (0 == pSystem->mpAlive[i])
+			continue;
+
+		// Two counter clockwise triangles, the same as the bullet shape's indices
+		pV[0].mX = x - h;	pV[0].mY = y + h;	pV[0].mU = u0;	pV[0].mV = v0;
+		pV[1].mX = x - h;	pV[1].mY = y - h;	pV[1].mU = u0;	pV[1].mV = v1;
+		pV[2].mX = x + h;	pV[2].mY = y - h;	pV[2].mU = u1;	pV[2].mV = v1;
+		pV[3] = pV[0];
+		pV[4].mX = x + h;	pV[4].mY = y + h;	pV[4].mU = u1;	pV[4].mV = v0;
+		pV[5] = pV[2];
+		pV[0].mColor = pV[1].mColor = pV[2].mColor = pV[3].mColor = pV[4].mColor = pV[5].mColor = Color;
+
+		vertexNum += 6;
+		if (vertexNum == PROJECTILE_BATCH_VERTEX_NUM)
+		{
+			pSystem->mppMeshes[pSystem->mMeshNum++] = RenderTraceMeshCreateTransient(sgpBatchVertices, vertexNum);
+			vertexNum = 0;
+		}
+	}
+
+	if (vertexNum)
+		pSystem->mppMeshes[pSystem->mMeshNum++] = RenderTraceMeshCreateTransient(sgpBatchVertices, vertexNum);
+}
+
+// ---------------------------------------------------------------------------
+
+void ProjectileDraw(ProjectileSystem *pSystem)
+{
+	float identity[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+	unsigned long i;
+
+	if (0 == pSystem->mMeshNum)
+		return;
+
+	RenderTraceSetTransform(identity);
+
+	for (i = 0; i < pSystem->mMeshNum; i++)
+		RenderTraceMeshDraw(pSystem->mppMeshes[i], AE_GFX_MDM_TRIANGLES);
+}
+
+// ---------------------------------------------------------------------------
+
+void ProjectileBenchmark(unsigned long Num)
+{
+	ProjectileSystem system;
+	Random random;
+	f64 start, end, updateTime = 0.0, queryTime = 0.0, buildTime = 0.0;
+	unsigned long frame, q, hitNum = 0, firedNum = 0;
+
+	// Room for the holes left by out of order deaths
+	ProjectileSystemInit(&system, 2 * Num);
+	RandomInit(&random, 2016, 0);
+
+	for (frame = 0; frame < PROJECTILE_BENCHMARK_FRAME_NUM; frame++)
+	{
+		// Top up what was culled or hit, so Num stay alive
+		while (system.mLiveNum < Num)
+		{
+			float angle = RandomRange(&random, 0.0f, 2.0f * PI);
+
+			ProjectileFire(&system,
+				RandomRange(&random, -PROJECTILE_BENCHMARK_HALF_X, PROJECTILE_BENCHMARK_HALF_X),
+				RandomRange(&random, -PROJECTILE_BENCHMARK_HALF_Y, PROJECTILE_BENCHMARK_HALF_Y),
+				150.0f * cosf(angle), 150.0f * sinf(angle));
+			firedNum++;
+		}
+
+		AEGetTime(&start);
+		ProjectileUpdate(&system, 1.0f / 60.0f, -PROJECTILE_BENCHMARK_HALF_X, -PROJECTILE_BENCHMARK_HALF_Y, PROJECTILE_BENCHMARK_HALF_X, PROJECTILE_BENCHMARK_HALF_Y);
+		AEGetTime(&end);
+		updateTime += end - start;
+
+		start = end;
+		for (q = 0; q < PROJECTILE_BENCHMARK_QUERY_NUM; q++)
+		{
+			float x = RandomRange(&random, -PROJECTILE_BENCHMARK_HALF_X, PROJECTILE_BENCHMARK_HALF_X);
+			float y = RandomRange(&random, -PROJECTILE_BENCHMARK_HALF_Y, PROJECTILE_BENCHMARK_HALF_Y);
+			long slot = ProjectileHitFind(&system, x - 30.0f, y - 30.0f, x + 30.0f, y + 30.0f);
+
+			if (slot != PROJECTILE_NONE)
+			{
+				ProjectileKill(&system, slot);
+				hitNum++;
+			}
+		}
+		AEGetTime(&end);
+		queryTime += end - start;
+
+		start = end;
+		ProjectileMeshBuild(&system, 5.0f, 0xFFFF0000, 0);
+		AEGetTime(&end);
+		buildTime += end - start;
+	}
+
+	StartupPrintf("Projectile: %lu live x %d frames, update %.3f ms, %d queries %.3f ms, mesh build %.3f ms per frame (%lu meshes)\n",
+		system.mLiveNum, PROJECTILE_BENCHMARK_FRAME_NUM, updateTime * 1000.0 / PROJECTILE_BENCHMARK_FRAME_NUM,
+		PROJECTILE_BENCHMARK_QUERY_NUM, queryTime * 1000.0 / PROJECTILE_BENCHMARK_FRAME_NUM,
+		buildTime * 1000.0 / PROJECTILE_BENCHMARK_FRAME_NUM, system.mMeshNum);
+	StartupPrintf("Projectile: %lu fired, %lu hits, %lu overwritten, ring span %lu of %lu\n",
+		firedNum, hitNum, system.mOverwrittenNum, system.mTail - system.mHead, system.mCapacity);
+
+	ProjectileSystemFree(&system);
+}
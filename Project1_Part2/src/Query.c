@@ -0,0 +1,88 @@
+/* Start Header -------------------------------------------------------
+Copyright Query.c
+Purpose:  Implementation of the per-signature instance lists
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Query.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "AEEngine.h"
+#include "Query.h"
+
+// ---------------------------------------------------------------------------
+
+void QueryInit(Query *pQuery, unsigned long Capacity)
+{
+	unsigned long s;
+
+	memset(pQuery, 0, sizeof(Query));
+
+	// Any bucket may end up holding every instance
+	for (s = 0; s < QUERY_SIGNATURE_NUM; s++)
+	{
+		pQuery->mpBuckets[s] = (unsigned long *)malloc(Capacity * sizeof(unsigned long));
+		AE_ASSERT_ALLOC(pQuery->mpBuckets[s]);
+	}
+
+	pQuery->mpBucketSlot = (unsigned long *)malloc(Capacity * sizeof(unsigned long));
+	pQuery->mpSignature = (unsigned char *)calloc(Capacity, sizeof(unsigned char));
+	AE_ASSERT_ALLOC(pQuery->mpBucketSlot);
+	AE_ASSERT_ALLOC(pQuery->mpSignature);
+
+	pQuery->mCapacity = Capacity;
+}
+
+// ---------------------------------------------------------------------------
+
+void QueryFree(Query *pQuery)
+{
+	unsigned long s;
+
+	for (s = 0; s < QUERY_SIGNATURE_NUM; s++)
+		free(pQuery->mpBuckets[s]);
+
+	free(pQuery->mpBucketSlot);
+	free(pQuery->mpSignature);
+
+	memset(pQuery, 0, sizeof(Query));
+}
+
+// ---------------------------------------------------------------------------
+
+void QueryClear(Query *pQuery)
+{
+	memset(pQuery->mBucketNum, 0, sizeof(pQuery->mBucketNum));
+	memset(pQuery->mpSignature, 0, pQuery->mCapacity * sizeof(unsigned char));
+}
+
+// ---------------------------------------------------------------------------
+
+void QueryAdd(Query *pQuery, unsigned long Index, unsigned long Signature)
+{
+	AE_ASSERT_PARM(Index < pQuery->mCapacity && Signature != 0 && Signature < QUERY_SIGNATURE_NUM);
+
+	QueryRemove(pQuery, Index);
+
+	pQuery->mpBucketSlot[Index] = pQuery->mBucketNum[Signature];
+	pQuery->mpBuckets[Signature][pQuery->mBucketNum[Signature]++] = Index;
+	pQuery->mpSignature[Index] = (unsigned char)Signature;
+}
+
+// ---------------------------------------------------------------------------
+
+void QueryRemove(Query *pQuery, unsigned long Index)
+{
+	unsigned long signature = pQuery->mpSignature[Index], slot, last;
+
+	if (signature == 0)
+		return;
+
+	slot = pQuery->mpBucketSlot[Index];
+	last = pQuery->mpBuckets[signature][--pQuery->mBucketNum[signature]];
+
+	pQuery->mpBuckets[signature][slot] = last;
+	pQuery->mpBucketSlot[last] = slot;
+	pQuery->mpSignature[Index] = 0;
+}
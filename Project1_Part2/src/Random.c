@@ -0,0 +1,235 @@
+/* Start Header -------------------------------------------------------
+Copyright Random.c
+Purpose:  Implementation of the Philox4x32-10 generator
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Random.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "Random.h"
+#include "Startup.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define RANDOM_USE_SSE	1
+#include <emmintrin.h>
+#else
+#define RANDOM_USE_SSE	0
+#endif
+
+#define PHILOX_M0				0xD2511F53u
+#define PHILOX_M1				0xCD9E8D57u
+#define PHILOX_W0				0x9E3779B9u
+#define PHILOX_W1				0xBB67AE85u
+#define PHILOX_ROUND_NUM		10
+
+#define RANDOM_FLOAT_SCALE		(1.0f / 16777216.0f)	// 24 bits of mantissa
+#define RANDOM_BENCHMARK_NUM	(16 * 1024 * 1024)
+
+// ---------------------------------------------------------------------------
+
+// Philox4x32-10 on one block. u32 is 32 bits on this platform, the products are done in 64 bits
+static void PhiloxBlock(const u32 *pCounter, const u32 *pKey, u32 *pOut)
+{
+	u32 c0 = pCounter[0], c1 = pCounter[1], c2 = pCounter[2], c3 = pCounter[3];
+	u32 k0 = pKey[0], k1 = pKey[1];
+	int r;
+
+	for (r = 0; r < PHILOX_ROUND_NUM; r++)
+	{
+		unsigned long long p0 = (unsigned long long)PHILOX_M0 * c0;
+		unsigned long long p1 = (unsigned long long)PHILOX_M1 * c2;
+
+		c0 = (u32)(p1 >> 32) ^ c1 ^ k0;
+		c2 = (u32)(p0 >> 32) ^ c3 ^ k1;
+		c1 = (u32)p1;
+		c3 = (u32)p0;
+
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+
+	pOut[0] = c0;
+	pOut[1] = c1;
+	pOut[2] = c2;
+	pOut[3] = c3;
+}
+
+// ---------------------------------------------------------------------------
+
+static void RandomCounterAdd(u32 *pCounter, u32 Num)
+{
+	u32 old = pCounter[0];
+
+	pCounter[0] += Num;
+
+	// Carry into the upper words
+	if (pCounter[0] < old && ++pCounter[1] == 0 && ++pCounter[2] == 0)
+		++pCounter[3];
+}
+
+// ---------------------------------------------------------------------------
+
+#if RANDOM_USE_SSE
+
+// 32x32 -> 64 bit products of 4 lanes, split into high and low words
+static void PhiloxMulHiLo(__m128i a, __m128i m, __m128i *pHi, __m128i *pLo)
+{
+	__m128i p02 = _mm_mul_epu32(a, m);
+	__m128i p13 = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);
+
+	*pLo = _mm_unpacklo_epi32(_mm_shuffle_epi32(p02, _MM_SHUFFLE(3, 1, 2, 0)), _mm_shuffle_epi32(p13, _MM_SHUFFLE(3, 1, 2, 0)));
+	*pHi = _mm_unpacklo_epi32(_mm_shuffle_epi32(p02, _MM_SHUFFLE(2, 0, 3, 1)), _mm_shuffle_epi32(p13, _MM_SHUFFLE(2, 0, 3, 1)));
+}
+
+// ---------------------------------------------------------------------------
+
+// 4 consecutive blocks, lane j of each vector belongs to block Counter + j. Counter[0] must not wrap
+static void PhiloxBlock4(const u32 *pCounter, const u32 *pKey, float *pOut)
+{
+	const __m128i m0 = _mm_set1_epi32((int)PHILOX_M0), m1 = _mm_set1_epi32((int)PHILOX_M1);
+	const __m128 scale = _mm_set1_ps(RANDOM_FLOAT_SCALE);
+	__m128i c0 = _mm_add_epi32(_mm_set1_epi32((int)pCounter[0]), _mm_set_epi32(3, 2, 1, 0));
+	__m128i c1 = _mm_set1_epi32((int)pCounter[1]);
+	__m128i c2 = _mm_set1_epi32((int)pCounter[2]);
+	__m128i c3 = _mm_set1_epi32((int)pCounter[3]);
+	__m128i k0 = _mm_set1_epi32((int)pKey[0]), k1 = _mm_set1_epi32((int)pKey[1]);
+	const __m128i w0 = _mm_set1_epi32((int)PHILOX_W0), w1 = _mm_set1_epi32((int)PHILOX_W1);
+	__m128 f0, f1, f2, f3;
+	int r;
+
+	for (r = 0; r < PHILOX_ROUND_NUM; r++)
+	{
+		__m128i hi0, lo0, hi1, lo1;
+
+		PhiloxMulHiLo(c0, m0, &hi0, &lo0);
+		PhiloxMulHiLo(c2, m1, &hi1, &lo1);
+
+		c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), k0);
+		c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), k1);
+		c1 = lo1;
+		c3 = lo0;
+
+		k0 = _mm_add_epi32(k0, w0);
+		k1 = _mm_add_epi32(k1, w1);
+	}
+
+	// Same conversion as RandomFloat, then back to block order
+	f0 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(c0, 8)), scale);
+	f1 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(c1, 8)), scale);
+	f2 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(c2, 8)), scale);
+	f3 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(c3, 8)), scale);
+	_MM_TRANSPOSE4_PS(f0, f1, f2, f3);
+
+	_mm_storeu_ps(pOut, f0);
+	_mm_storeu_ps(pOut + 4, f1);
+	_mm_storeu_ps(pOut + 8, f2);
+	_mm_storeu_ps(pOut + 12, f3);
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+
+void RandomInit(Random *pRandom, u32 Seed, u32 Stream)
+{
+	memset(pRandom, 0, sizeof(Random));
+
+	pRandom->mKey[0] = Seed;
+	pRandom->mKey[1] = Stream;
+	pRandom->mBufferIndex = 4;
+}
+
+// ---------------------------------------------------------------------------
+
+u32 RandomU32(Random *pRandom)
+{
+	if (pRandom->mBufferIndex == 4)
+	{
+		PhiloxBlock(pRandom->mCounter, pRandom->mKey, pRandom->mBuffer);
+		RandomCounterAdd(pRandom->mCounter, 1);
+		pRandom->mBufferIndex = 0;
+	}
+
+	return pRandom->mBuffer[pRandom->mBufferIndex++];
+}
+
+// ---------------------------------------------------------------------------
+
+float RandomFloat(Random *pRandom)
+{
+	return (RandomU32(pRandom) >> 8) * RANDOM_FLOAT_SCALE;
+}
+
+// ---------------------------------------------------------------------------
+
+float RandomRange(Random *pRandom, float Min, float Max)
+{
+	return Min + (Max - Min) * RandomFloat(pRandom);
+}
+
+// ---------------------------------------------------------------------------
+
+void RandomFillFloat(Random *pRandom, float *pOut, unsigned long Num)
+{
+	unsigned long i = 0;
+
+	// What is left of the current block comes first, so the sequence matches RandomFloat
+	while (i < Num && pRandom->mBufferIndex < 4)
+		pOut[i++] = RandomFloat(pRandom);
+
+#if RANDOM_USE_SSE
+	while (i + 16 <= Num && pRandom->mCounter[0] <= 0xFFFFFFFBu)
+	{
+		PhiloxBlock4(pRandom->mCounter, pRandom->mKey, pOut + i);
+		RandomCounterAdd(pRandom->mCounter, 4);
+		i += 16;
+	}
+#endif
+
+	while (i < Num)
+		pOut[i++] = RandomFloat(pRandom);
+}
+
+// ---------------------------------------------------------------------------
+
+void RandomBenchmark(void)
+{
+	float *pValues = (float *)malloc(RANDOM_BENCHMARK_NUM * sizeof(float));
+	double bytes = RANDOM_BENCHMARK_NUM * (double)sizeof(float);
+	f64 start, aeTime, scalarTime, fillTime;
+	float sum = 0.0f;
+	Random random;
+	unsigned long i;
+
+	AE_ASSERT_ALLOC(pValues);
+
+	AEGetTime(&start);
+	for (i = 0; i < RANDOM_BENCHMARK_NUM; i++)
+		pValues[i] = AERandFloat();
+	AEGetTime(&aeTime);
+	aeTime -= start;
+	sum += pValues[RANDOM_BENCHMARK_NUM - 1];
+
+	RandomInit(&random, 2016, 0);
+	AEGetTime(&start);
+	for (i = 0; i < RANDOM_BENCHMARK_NUM; i++)
+		pValues[i] = RandomFloat(&random);
+	AEGetTime(&scalarTime);
+	scalarTime -= start;
+	sum += pValues[RANDOM_BENCHMARK_NUM - 1];
+
+	RandomInit(&random, 2016, 0);
+	AEGetTime(&start);
+	RandomFillFloat(&random, pValues, RANDOM_BENCHMARK_NUM);
+	AEGetTime(&fillTime);
+	fillTime -= start;
+	sum += pValues[RANDOM_BENCHMARK_NUM - 1];
+
+	free(pValues);
+
+	// The sum keeps the loops from being optimized away
+	StartupPrintf("Random: %d floats, AERandFloat %.2f GB/s, RandomFloat %.2f GB/s, RandomFillFloat %.2f GB/s (%f)\n", RANDOM_BENCHMARK_NUM,
+		bytes / aeTime / 1e9, bytes / scalarTime / 1e9, bytes / fillTime / 1e9, sum);
+}
@@ -0,0 +1,426 @@
+/* Start Header -------------------------------------------------------
+Copyright RenderTrace.c
+Purpose:  Implementation of the render trace capture
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_RenderTrace.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "RenderTrace.h"
+#include "Startup.h"
+
+// traced meshes, in creation order
+static AEGfxVertexList*		sgpMeshes[RENDER_TRACE_MESH_MAX];
+static RenderTraceMesh		sgMeshes[RENDER_TRACE_MESH_MAX];
+static unsigned long		sgMeshNum;
+static RenderTraceVertex	sgVertices[RENDER_TRACE_VERTEX_MAX];
+static unsigned long		sgVertexNum;
+
+// meshes of the current frame, their payloads are kept in sgpTransientData while capturing
+static AEGfxVertexList*		sgpTransientMeshes[RENDER_TRACE_TRANSIENT_MAX];
+static unsigned long		sgTransientOffsets[RENDER_TRACE_TRANSIENT_MAX];
+static unsigned long		sgTransientSizes[RENDER_TRACE_TRANSIENT_MAX];
+static unsigned long		sgTransientNum;
+static unsigned char*		sgpTransientData;
+static unsigned long		sgTransientDataSize;
+static unsigned long		sgTransientDataCapacity;
+
+// traced textures, in creation order
+static AEGfxTexture*		sgpTextures[RENDER_TRACE_TEXTURE_MAX];
+static RenderTraceTexture	sgTextures[RENDER_TRACE_TEXTURE_MAX];
+static unsigned long		sgTextureNum;
+static u32*					sgpTexels;
+static unsigned long		sgTexelNum;
+
+// current capture, sgpCalls is 0 when idle
+static unsigned char*		sgpCalls;
+static unsigned long		sgCallSize;
+static unsigned long		sgCallNum;
+static unsigned long		sgFrameStart;			// Offset of the current frame's marker
+static unsigned long		sgFrameNum;
+static unsigned long		sgFrameMax;
+static int					sgOverflow;
+
+// ---------------------------------------------------------------------------
+
+static void RenderTraceWrite(void)
+{
+	RenderTraceHeader header;
+	FILE *pFile;
+
+	memset(&header, 0, sizeof(RenderTraceHeader));
+	header.mMagic = RENDER_TRACE_MAGIC;
+	header.mVersion = RENDER_TRACE_VERSION;
+	header.mWidth = (u32)(AEGfxGetWinMaxX() - AEGfxGetWinMinX() + 0.5f);
+	header.mHeight = (u32)(AEGfxGetWinMaxY() - AEGfxGetWinMinY() + 0.5f);
+	header.mFrameNum = sgFrameNum;
+	header.mCallNum = sgCallNum;
+	header.mMeshNum = sgMeshNum;
+	header.mVertexNum = sgVertexNum;
+	header.mTextureNum = sgTextureNum;
+	header.mTexelNum = sgTexelNum;
+	header.mCallSize = sgCallSize;
+
+	pFile = fopen(RENDER_TRACE_FILE, "wb");
+	if (0 == pFile
+		|| fwrite(&header, sizeof(RenderTraceHeader), 1, pFile) != 1
+		|| fwrite(sgMeshes, sizeof(RenderTraceMesh), sgMeshNum, pFile) != sgMeshNum
+		|| fwrite(sgVertices, sizeof(RenderTraceVertex), sgVertexNum, pFile) != sgVertexNum
+		|| fwrite(sgTextures, sizeof(RenderTraceTexture), sgTextureNum, pFile) != sgTextureNum
+		|| fwrite(sgpTexels, sizeof(u32), sgTexelNum, pFile) != sgTexelNum
+		|| fwrite(sgpCalls, 1, sgCallSize, pFile) != sgCallSize)
+	{
+		AE_WARNING_MESG(0, "Could not write %s", RENDER_TRACE_FILE);
+	}
+	else
+		StartupPrintf("RenderTrace: %lu frames, %lu calls, %lu bytes written to %s\n", sgFrameNum, sgCallNum, sgCallSize, RENDER_TRACE_FILE);
+
+	if (pFile)
+		fclose(pFile);
+}
+
+// ---------------------------------------------------------------------------
+
+// Appends a record, or flags the capture as full
+static void RenderTraceRecord(unsigned char Op, const void *pPayload, unsigned long Size)
+{
+	if (0 == sgpCalls || sgOverflow)
+		return;
+
+	if (sgCallSize + 1 + Size > RENDER_TRACE_BUFFER_SIZE)
+	{
+		sgOverflow = 1;
+		return;
+	}
+
+	sgpCalls[sgCallSize] = Op;
+	memcpy(sgpCalls + sgCallSize + 1, pPayload, Size);
+	sgCallSize += 1 + Size;
+
+	if (Op != RENDER_TRACE_OP_FRAME)
+		sgCallNum++;
+}
+
+// ---------------------------------------------------------------------------
+
+void RenderTraceMeshClear(void)
+{
+	sgMeshNum = 0;
+	sgVertexNum = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+AEGfxVertexList* RenderTraceMeshCreate(const MeshVertex *pVertices, unsigned long VertexNum, const unsigned short *pIndices, unsigned long IndexNum)
+{
+	AEGfxVertexList *pMesh = MeshCreate(pVertices, VertexNum, pIndices, IndexNum);
+	unsigned long num = pIndices ? IndexNum : VertexNum, i;
+	RenderTraceMesh *pTraceMesh;
+
+	if (sgMeshNum >= RENDER_TRACE_MESH_MAX || sgVertexNum + num > RENDER_TRACE_VERTEX_MAX)
+	{
+		AE_WARNING_MESG(0, "Render trace mesh table is full, mesh %lu will not be traced", sgMeshNum);
+		return pMesh;
+	}
+
+	pTraceMesh = sgMeshes + sgMeshNum;
+	pTraceMesh->mVertexFirst = sgVertexNum;
+	pTraceMesh->mVertexNum = num;
+	sgpMeshes[sgMeshNum++] = pMesh;
+
+	// Stored unindexed, as the engine draws them
+	for (i = 0; i < num; i++)
+	{
+		const MeshVertex *pVertex = pVertices + (pIndices ? pIndices[i] : i);
+		RenderTraceVertex *pTraceVertex = sgVertices + sgVertexNum++;
+
+		pTraceVertex->mX = pVertex->mX;
+		pTraceVertex->mY = pVertex->mY;
+		pTraceVertex->mColor = pVertex->mColor;
+		pTraceVertex->mU = pVertex->mU;
+		pTraceVertex->mV = pVertex->mV;
+	}
+
+	return pMesh;
+}
+
+// ---------------------------------------------------------------------------
+
+AEGfxVertexList* RenderTraceMeshCreateTransient(const MeshVertex *pVertices, unsigned long VertexNum)
+{
+	AEGfxVertexList *pMesh = MeshCreate(pVertices, VertexNum, 0, 0);
+	unsigned long size = sizeof(u32) + VertexNum * sizeof(RenderTraceVertex), i;
+	unsigned char *pPayload;
+	u32 num = VertexNum;
+
+	// Nothing is kept outside a capture
+	if (0 == sgpCalls || 0 == pMesh)
+		return pMesh;
+
+	if (sgTransientNum >= RENDER_TRACE_TRANSIENT_MAX)
+	{
+		AE_WARNING_MESG(0, "Render trace transient mesh table is full, mesh %lu of the frame will not be traced", sgTransientNum);
+		return pMesh;
+	}
+
+	if (sgTransientDataSize + size > sgTransientDataCapacity)
+	{
+		sgTransientDataCapacity = max(2 * sgTransientDataCapacity, sgTransientDataSize + size);
+		sgpTransientData = (unsigned char *)realloc(sgpTransientData, sgTransientDataCapacity);
+		AE_ASSERT_ALLOC(sgpTransientData);
+	}
+
+	sgpTransientMeshes[sgTransientNum] = pMesh;
+	sgTransientOffsets[sgTransientNum] = sgTransientDataSize;
+	sgTransientSizes[sgTransientNum++] = size;
+
+	// The payload of RENDER_TRACE_OP_DRAW_VERTICES, ready to be copied at each draw
+	pPayload = sgpTransientData + sgTransientDataSize;
+	memcpy(pPayload, &num, sizeof(u32));
+	pPayload += sizeof(u32);
+
+	for (i = 0; i < VertexNum; i++, pPayload += sizeof(RenderTraceVertex))
+	{
+		RenderTraceVertex vertex;
+
+		vertex.mX = pVertices[i].mX;
+		vertex.mY = pVertices[i].mY;
+		vertex.mColor = pVertices[i].mColor;
+		vertex.mU = pVertices[i].mU;
+		vertex.mV = pVertices[i].mV;
+		memcpy(pPayload, &vertex, sizeof(RenderTraceVertex));
+	}
+
+	sgTransientDataSize += size;
+
+	return pMesh;
+}
+
+// ---------------------------------------------------------------------------
+
+void RenderTraceTextureClear(void)
+{
+	free(sgpTexels);
+	sgpTexels = 0;
+	sgTexelNum = 0;
+	sgTextureNum = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+AEGfxTexture* RenderTraceTextureCreate(const unsigned int *pPixels, unsigned long Width, unsigned long Height)
+{
+	unsigned char *pColors = (unsigned char *)malloc(Width * Height * 4);
+	AEGfxTexture *pTexture;
+	RenderTraceTexture *pTraceTexture;
+	unsigned long i;
+
+	AE_ASSERT_ALLOC(pColors);
+
+	// The engine takes bytes in R, G, B, A order
+	for (i = 0; i < Width * Height; i++)
+	{
+		pColors[4 * i] = (unsigned char)(pPixels[i] >> 16);
+		pColors[4 * i + 1] = (unsigned char)(pPixels[i] >> 8);
+		pColors[4 * i + 2] = (unsigned char)pPixels[i];
+		pColors[4 * i + 3] = (unsigned char)(pPixels[i] >> 24);
+	}
+
+	pTexture = AEGfxTextureLoadFromMemory(pColors, Width, Height);
+	free(pColors);
+
+	if (0 == pTexture)
+		return 0;
+
+	if (sgTextureNum >= RENDER_TRACE_TEXTURE_MAX)
+	{
+		AE_WARNING_MESG(0, "Render trace texture table is full, texture %lu will not be traced", sgTextureNum);
+		return pTexture;
+	}
+
+	sgpTexels = (u32 *)realloc(sgpTexels, (sgTexelNum + Width * Height) * sizeof(u32));
+	AE_ASSERT_ALLOC(sgpTexels);
+
+	pTraceTexture = sgTextures + sgTextureNum;
+	pTraceTexture->mWidth = Width;
+	pTraceTexture->mHeight = Height;
+	pTraceTexture->mTexelFirst = sgTexelNum;
+	sgpTextures[sgTextureNum++] = pTexture;
+
+	memcpy(sgpTexels + sgTexelNum, pPixels, Width * Height * sizeof(u32));
+	sgTexelNum += Width * Height;
+
+	return pTexture;
+}
+
+// ---------------------------------------------------------------------------
+
+void RenderTraceCaptureStart(unsigned long FrameNum)
+{
+	if (sgpCalls)
+		return;
+
+	sgpCalls = (unsigned char *)malloc(RENDER_TRACE_BUFFER_SIZE);
+	AE_ASSERT_ALLOC(sgpCalls);
+
+	sgCallSize = 0;
+	sgCallNum = 0;
+	sgFrameStart = 0;
+	sgFrameNum = 0;
+	sgFrameMax = FrameNum;
+	sgOverflow = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+void RenderTraceFrame(void)
+{
+	f32 camera[2];
+
+	// The previous frame's transient meshes are gone, or about to be rebuilt
+	sgTransientNum = 0;
+	sgTransientDataSize = 0;
+
+	if (0 == sgpCalls)
+		return;
+
+	// The previous frame is complete
+	if (sgCallSize > 0 && !sgOverflow)
+		sgFrameNum++;
+
+	if (sgFrameNum == sgFrameMax || sgOverflow)
+	{
+		// A frame cut by the buffer limit is dropped whole
+		if (sgOverflow)
+			sgCallSize = sgFrameStart;
+
+		RenderTraceWrite();
+		free(sgpCalls);
+		free(sgpTransientData);
+		sgpCalls = 0;
+		sgpTransientData = 0;
+		sgTransientDataCapacity = 0;
+		return;
+	}
+
+	// The camera is usually moved during Update, outside any traced call
+	AEGfxGetCamPosition(camera, camera + 1);
+	sgFrameStart = sgCallSize;
+	RenderTraceRecord(RENDER_TRACE_OP_FRAME, camera, sizeof(camera));
+}
+
+// ---------------------------------------------------------------------------
+
+void RenderTraceSetRenderMode(unsigned int RenderMode)
+{
+	unsigned char mode = (unsigned char)RenderMode;
+
+	AEGfxSetRenderMode(RenderMode);
+	RenderTraceRecord(RENDER_TRACE_OP_RENDER_MODE, &mode, sizeof(mode));
+}
+
+// ---------------------------------------------------------------------------
+
+void RenderTraceTextureSet(AEGfxTexture *pTexture, f32 OffsetX, f32 OffsetY)
+{
+	unsigned char payload[1 + 2 * sizeof(f32)];
+	unsigned long i;
+
+	AEGfxTextureSet(pTexture, OffsetX, OffsetY);
+
+	payload[0] = RENDER_TRACE_TEXTURE_NONE;
+	for (i = 0; i < sgTextureNum && pTexture; i++)
+		if (sgpTextures[i] == pTexture)
+		{
+			payload[0] = (unsigned char)i;
+			break;
+		}
+
+	memcpy(payload + 1, &OffsetX, sizeof(f32));
+	memcpy(payload + 1 + sizeof(f32), &OffsetY, sizeof(f32));
+	RenderTraceRecord(RENDER_TRACE_OP_TEXTURE, payload, sizeof(payload));
+}
+
+// ---------------------------------------------------------------------------
+
+void RenderTraceSetTintColor(float Red, float Green, float Blue, float Alpha)
+{
+	float color[4] = { Red, Green, Blue, Alpha };
+
+	AEGfxSetTintColor(Red, Green, Blue, Alpha);
+	RenderTraceRecord(RENDER_TRACE_OP_TINT, color, sizeof(color));
+}
+
+// ---------------------------------------------------------------------------
+
+void RenderTraceSetBlendMode(unsigned int BlendMode)
+{
+	unsigned char mode = (unsigned char)BlendMode;
+
+	AEGfxSetBlendMode(BlendMode);
+	RenderTraceRecord(RENDER_TRACE_OP_BLEND_MODE, &mode, sizeof(mode));
+}
+
+// ---------------------------------------------------------------------------
+
+void RenderTraceSetTransform(float pTransform[3][3])
+{
+	AEGfxSetTransform(pTransform);
+
+	// The last row of a 2D transform is always 0 0 1
+	if (sgpCalls)
+		RenderTraceRecord(RENDER_TRACE_OP_TRANSFORM, pTransform, 6 * sizeof(float));
+}
+
+// ---------------------------------------------------------------------------
+
+void RenderTraceMeshDraw(AEGfxVertexList *pVertexList, unsigned int MeshDrawMode)
+{
+	unsigned char payload[2] = { RENDER_TRACE_MESH_UNKNOWN, (unsigned char)MeshDrawMode };
+	unsigned long i;
+
+	AEGfxMeshDraw(pVertexList, MeshDrawMode);
+
+	if (0 == sgpCalls)
+		return;
+
+	for (i = 0; i < sgMeshNum; i++)
+		if (sgpMeshes[i] == pVertexList)
+		{
+			payload[0] = (unsigned char)i;
+			break;
+		}
+
+	// Not in the table: a transient mesh carries its own triangles
+	if (payload[0] == RENDER_TRACE_MESH_UNKNOWN)
+		for (i = 0; i < sgTransientNum; i++)
+			if (sgpTransientMeshes[i] == pVertexList)
+			{
+				RenderTraceRecord(RENDER_TRACE_OP_DRAW_VERTICES, sgpTransientData + sgTransientOffsets[i], sgTransientSizes[i]);
+				return;
+			}
+
+	RenderTraceRecord(RENDER_TRACE_OP_DRAW, payload, sizeof(payload));
+}
+
+// ---------------------------------------------------------------------------
+
+void RenderTraceSetCamPosition(f32 X, f32 Y)
+{
+	f32 position[2] = { X, Y };
+
+	AEGfxSetCamPosition(X, Y);
+	RenderTraceRecord(RENDER_TRACE_OP_CAMERA, position, sizeof(position));
+}
+
+// ---------------------------------------------------------------------------
+
+void RenderTraceSetViewport(int ViewportX, int ViewportY, int ViewportWidth, int ViewportHeight)
+{
+	s32 viewport[4] = { ViewportX, ViewportY, ViewportWidth, ViewportHeight };
+
+	AEGfxSetViewportPositionAndDimensions(ViewportX, ViewportY, ViewportWidth, ViewportHeight);
+	RenderTraceRecord(RENDER_TRACE_OP_VIEWPORT, viewport, sizeof(viewport));
+}
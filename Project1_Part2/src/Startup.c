@@ -0,0 +1,117 @@
+/* Start Header -------------------------------------------------------
+Copyright Startup.c
+Purpose:  Implementation of the startup timeline
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Startup.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "Startup.h"
+#include <stdarg.h>
+
+#define STARTUP_PRINT_MAX				1024
+
+int gStartupLazy;
+int gStartupHeadless;
+
+// QueryPerformanceCounter rather than AEGetTime, marks are taken before the engine is up
+static LARGE_INTEGER		sgMarkTimes[STARTUP_MARK_MAX];
+static const char*			sgpMarkNames[STARTUP_MARK_MAX];
+static unsigned long		sgMarkNum;
+static int					sgReported;
+static int					sgOverBudget;
+static int					sgConsoleOpen;
+
+// ---------------------------------------------------------------------------
+
+void StartupPrintf(const char *pFormat, ...)
+{
+	char line[STARTUP_PRINT_MAX];
+	va_list args;
+
+	va_start(args, pFormat);
+	vsnprintf(line, sizeof(line), pFormat, args);
+	va_end(args);
+
+	if (!gStartupLazy)
+	{
+		AESysPrintf("%s", line);
+		return;
+	}
+
+	// The engine console was skipped to start faster, the first print pays for a console instead
+	if (!sgConsoleOpen)
+	{
+		sgConsoleOpen = 1;
+		if (AttachConsole(ATTACH_PARENT_PROCESS) || AllocConsole())
+			freopen("CONOUT$", "w", stdout);
+	}
+
+	fputs(line, stdout);
+	fflush(stdout);
+	OutputDebugStringA(line);
+}
+
+// ---------------------------------------------------------------------------
+
+void StartupParse(const char *pCommandLine)
+{
+	if (0 == pCommandLine)
+		return;
+
+	gStartupHeadless = (0 != strstr(pCommandLine, "-headless"));
+	gStartupLazy = gStartupHeadless || (0 != strstr(pCommandLine, "-lazy"));
+}
+
+// ---------------------------------------------------------------------------
+
+void StartupMark(const char *pName)
+{
+	if (sgReported || sgMarkNum >= STARTUP_MARK_MAX)
+		return;
+
+	QueryPerformanceCounter(sgMarkTimes + sgMarkNum);
+	sgpMarkNames[sgMarkNum++] = pName;
+}
+
+// ---------------------------------------------------------------------------
+
+void StartupReport(void)
+{
+	LARGE_INTEGER frequency;
+	unsigned long i;
+	double total;
+
+	if (sgReported || sgMarkNum == 0)
+		return;
+	sgReported = 1;
+
+	QueryPerformanceFrequency(&frequency);
+
+	for (i = 0; i < sgMarkNum; i++)
+	{
+		double at = (sgMarkTimes[i].QuadPart - sgMarkTimes[0].QuadPart) * 1000.0 / frequency.QuadPart;
+		double step = i ? (sgMarkTimes[i].QuadPart - sgMarkTimes[i - 1].QuadPart) * 1000.0 / frequency.QuadPart : 0.0;
+
+		StartupPrintf("Startup: %8.3f ms  (+%7.3f)  %s\n", at, step, sgpMarkNames[i]);
+	}
+
+	total = (sgMarkTimes[sgMarkNum - 1].QuadPart - sgMarkTimes[0].QuadPart) * 1000.0 / frequency.QuadPart;
+	sgOverBudget = total > STARTUP_FIRST_FRAME_BUDGET;
+
+	StartupPrintf("Startup: %.3f ms to the first frame (%s, budget %.0f ms)%s\n",
+		total, gStartupHeadless ? "headless" : (gStartupLazy ? "lazy" : "full"), STARTUP_FIRST_FRAME_BUDGET,
+		sgOverBudget ? " OVER BUDGET" : "");
+
+	// Headless runs also return it in their exit code, see WinMain
+	AE_WARNING_MESG(!sgOverBudget, "First frame after %.3f ms, over the %.0f ms startup budget", total, STARTUP_FIRST_FRAME_BUDGET);
+}
+
+// ---------------------------------------------------------------------------
+
+int StartupWithinBudget(void)
+{
+	return !sgOverBudget;
+}
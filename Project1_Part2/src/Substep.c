@@ -0,0 +1,193 @@
+/* Start Header -------------------------------------------------------
+Copyright Substep.c
+Purpose:  Implementation of the sub-step batches
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Substep.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "Substep.h"
+#include "Startup.h"
+#include "Random.h"
+#include <math.h>
+
+#define SUBSTEP_BENCHMARK_NUM			100000
+#define SUBSTEP_BENCHMARK_FRAME_NUM		60
+#define SUBSTEP_BENCHMARK_FAST_RATIO	100					// One mover in this many is fast
+#define SUBSTEP_BENCHMARK_BOX			50.0f				// Half side of the obstacle every step is tested against
+
+// ---------------------------------------------------------------------------
+
+void SubstepBatchesInit(SubstepBatches *pBatches, unsigned long Capacity)
+{
+	memset(pBatches, 0, sizeof(SubstepBatches));
+	pBatches->mCapacity = Capacity;
+
+	pBatches->mpAdded = (unsigned long *)malloc(Capacity * sizeof(unsigned long));
+	pBatches->mpItems = (unsigned long *)malloc(Capacity * sizeof(unsigned long));
+	pBatches->mpLevel = (unsigned char *)malloc(Capacity);
+	AE_ASSERT_ALLOC(pBatches->mpAdded && pBatches->mpItems && pBatches->mpLevel);
+}
+
+// ---------------------------------------------------------------------------
+
+void SubstepBatchesFree(SubstepBatches *pBatches)
+{
+	free(pBatches->mpAdded);
+	free(pBatches->mpItems);
+	free(pBatches->mpLevel);
+
+	memset(pBatches, 0, sizeof(SubstepBatches));
+}
+
+// ---------------------------------------------------------------------------
+
+void SubstepBatchesClear(SubstepBatches *pBatches)
+{
+	pBatches->mNum = 0;
+	memset(pBatches->mStart, 0, sizeof(pBatches->mStart));
+}
+
+// ---------------------------------------------------------------------------
+
+void SubstepBatchesAdd(SubstepBatches *pBatches, unsigned long Item, unsigned char Level)
+{
+	AE_ASSERT_PARM(pBatches->mNum < pBatches->mCapacity && Level < SUBSTEP_LEVEL_NUM);
+
+	pBatches->mpAdded[pBatches->mNum] = Item;
+	pBatches->mpLevel[pBatches->mNum] = Level;
+	pBatches->mNum++;
+}
+
+// ---------------------------------------------------------------------------
+
+void SubstepBatchesSort(SubstepBatches *pBatches)
+{
+	unsigned long cursor[SUBSTEP_LEVEL_NUM + 1] = { 0 };
+	unsigned long k;
+	int level;
+
+	// Counting sort: nearly every mover is at level 0
+	for (k = 0; k < pBatches->mNum; k++)
+		cursor[pBatches->mpLevel[k] + 1]++;
+
+	for (level = 0; level < SUBSTEP_LEVEL_NUM; level++)
+		cursor[level + 1] += cursor[level];
+
+	memcpy(pBatches->mStart, cursor, sizeof(pBatches->mStart));
+
+	for (k = 0; k < pBatches->mNum; k++)
+		pBatches->mpItems[cursor[pBatches->mpLevel[k]]++] = pBatches->mpAdded[k];
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned char SubstepLevel(float Travel, float Reach)
+{
+	unsigned char level = 0;
+
+	while (level < SUBSTEP_LEVEL_MAX && Travel > Reach * (float)(1 << level))
+		++level;
+
+	return level;
+}
+
+// ---------------------------------------------------------------------------
+
+void SubstepBenchmark(void)
+{
+	SubstepBatches batches;
+	Random random;
+	float *pPosX, *pPosY, *pVelX, *pVelY, *pSize;
+	float dt = 1.0f / 60.0f;
+	f64 start, end, timeFixed = 0.0, timeBatched = 0.0;
+	unsigned long i, frame, fixedStepNum = 0, batchedStepNum = 0, fixedHitNum = 0, batchedHitNum = 0;
+	int level, s;
+
+	pPosX = (float *)malloc(5 * SUBSTEP_BENCHMARK_NUM * sizeof(float));
+	AE_ASSERT_ALLOC(pPosX);
+	pPosY = pPosX + SUBSTEP_BENCHMARK_NUM;
+	pVelX = pPosY + SUBSTEP_BENCHMARK_NUM;
+	pVelY = pVelX + SUBSTEP_BENCHMARK_NUM;
+	pSize = pVelY + SUBSTEP_BENCHMARK_NUM;
+
+	SubstepBatchesInit(&batches, SUBSTEP_BENCHMARK_NUM);
+	RandomInit(&random, 2016, 0);
+
+	// Asteroid like drifters, and a few bullet like movers crossing several times their size per frame
+	for (i = 0; i < SUBSTEP_BENCHMARK_NUM; i++)
+	{
+		int fast = (i % SUBSTEP_BENCHMARK_FAST_RATIO) == 0;
+		float speed = fast ? RandomRange(&random, 600.0f, 1500.0f) : RandomRange(&random, 10.0f, 40.0f);
+		float angle = RandomRange(&random, -PI, PI);
+
+		pPosX[i] = RandomRange(&random, -400.0f, 400.0f);
+		pPosY[i] = RandomRange(&random, -300.0f, 300.0f);
+		pVelX[i] = speed * cosf(angle);
+		pVelY[i] = speed * sinf(angle);
+		pSize[i] = fast ? 5.0f : 25.0f;
+	}
+
+	for (frame = 0; frame < SUBSTEP_BENCHMARK_FRAME_NUM; frame++)
+	{
+		unsigned long fixedSteps = 1 << SUBSTEP_LEVEL_MAX;
+		float h = dt / fixedSteps;
+
+		// Fixed rate: every mover takes as many steps, and obstacle tests, as the fastest one needs
+		AEGetTime(&start);
+		for (s = 0; s < (int)fixedSteps; s++)
+		{
+			for (i = 0; i < SUBSTEP_BENCHMARK_NUM; i++)
+			{
+				pPosX[i] += pVelX[i] * h;
+				pPosY[i] += pVelY[i] * h;
+				fixedHitNum += fabsf(pPosX[i]) < SUBSTEP_BENCHMARK_BOX && fabsf(pPosY[i]) < SUBSTEP_BENCHMARK_BOX;
+			}
+		}
+		AEGetTime(&end);
+		timeFixed += end - start;
+		fixedStepNum += fixedSteps * SUBSTEP_BENCHMARK_NUM;
+
+		// Batched: the level of each mover, then each batch with its own step count
+		AEGetTime(&start);
+		SubstepBatchesClear(&batches);
+		for (i = 0; i < SUBSTEP_BENCHMARK_NUM; i++)
+		{
+			float travel = sqrtf(pVelX[i] * pVelX[i] + pVelY[i] * pVelY[i]) * dt;
+			SubstepBatchesAdd(&batches, i, SubstepLevel(travel, pSize[i]));
+		}
+		SubstepBatchesSort(&batches);
+
+		for (level = 0; level < SUBSTEP_LEVEL_NUM; level++)
+		{
+			unsigned long first = batches.mStart[level], last = batches.mStart[level + 1], k;
+			float hLevel = dt / (float)(1 << level);
+
+			for (s = 0; s < (1 << level); s++)
+			{
+				for (k = first; k < last; k++)
+				{
+					unsigned long item = batches.mpItems[k];
+
+					pPosX[item] += pVelX[item] * hLevel;
+					pPosY[item] += pVelY[item] * hLevel;
+					batchedHitNum += fabsf(pPosX[item]) < SUBSTEP_BENCHMARK_BOX && fabsf(pPosY[item]) < SUBSTEP_BENCHMARK_BOX;
+				}
+			}
+
+			batchedStepNum += (last - first) << level;
+		}
+		AEGetTime(&end);
+		timeBatched += end - start;
+	}
+
+	StartupPrintf("Substeps: %d movers x %d frames, fixed rate %.3f ms per frame (%lu steps, %lu hits), batched %.3f ms per frame (%lu steps, %lu hits)\n",
+		SUBSTEP_BENCHMARK_NUM, SUBSTEP_BENCHMARK_FRAME_NUM,
+		timeFixed * 1000.0 / SUBSTEP_BENCHMARK_FRAME_NUM, fixedStepNum / SUBSTEP_BENCHMARK_FRAME_NUM, fixedHitNum,
+		timeBatched * 1000.0 / SUBSTEP_BENCHMARK_FRAME_NUM, batchedStepNum / SUBSTEP_BENCHMARK_FRAME_NUM, batchedHitNum);
+
+	SubstepBatchesFree(&batches);
+	free(pPosX);
+}
@@ -0,0 +1,136 @@
+/* Start Header -------------------------------------------------------
+Copyright WorkerPool.c
+Purpose:  Implementation of the persistent worker threads
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_WorkerPool.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "WorkerPool.h"
+
+static HANDLE					sgThreads[WORKER_POOL_THREAD_NUM];
+static HANDLE					sgWake[WORKER_POOL_THREAD_NUM];		// Auto reset, set by the run handing out a job
+static HANDLE					sgDone[WORKER_POOL_THREAD_NUM];		// Auto reset, set by the worker once its job is done
+static long						sgThreadNum;						// Workers running, 0 when the pool could not start
+static long						sgUserNum;
+static volatile int				sgRunning;
+
+// Job of each worker for the current run, written before its wake event is set
+static WorkerJobFunc			sgpFunc;
+static void*					sgpJobs[WORKER_POOL_THREAD_NUM];
+
+// ---------------------------------------------------------------------------
+
+static DWORD WINAPI WorkerPoolThread(LPVOID pParam)
+{
+	long worker = (long)(size_t)pParam;
+
+	for (;;)
+	{
+		// The events order the job's memory between the threads
+		WaitForSingleObject(sgWake[worker], INFINITE);
+
+		if (!sgRunning)
+			return 0;
+
+		sgpFunc(sgpJobs[worker]);
+		SetEvent(sgDone[worker]);
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+// Wakes the workers to let them exit, then releases the threads and the events
+static void WorkerPoolShutdown(void)
+{
+	long w;
+
+	sgRunning = 0;
+
+	for (w = 0; w < WORKER_POOL_THREAD_NUM; w++)
+	{
+		if (sgThreads[w])
+		{
+			SetEvent(sgWake[w]);
+			WaitForSingleObject(sgThreads[w], INFINITE);
+			CloseHandle(sgThreads[w]);
+		}
+
+		if (sgWake[w])
+			CloseHandle(sgWake[w]);
+		if (sgDone[w])
+			CloseHandle(sgDone[w]);
+
+		sgThreads[w] = sgWake[w] = sgDone[w] = 0;
+	}
+
+	sgThreadNum = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+int WorkerPoolStart(void)
+{
+	long w;
+
+	if (sgUserNum++ > 0)
+		return sgThreadNum > 0;
+
+	sgRunning = 1;
+
+	for (w = 0; w < WORKER_POOL_THREAD_NUM; w++)
+	{
+		sgWake[w] = CreateEvent(NULL, FALSE, FALSE, NULL);
+		sgDone[w] = CreateEvent(NULL, FALSE, FALSE, NULL);
+		sgThreads[w] = sgWake[w] && sgDone[w] ? CreateThread(NULL, 0, WorkerPoolThread, (LPVOID)(size_t)w, 0, NULL) : 0;
+
+		if (0 == sgThreads[w])
+		{
+			AE_WARNING_MESG(0, "Could not start the worker threads, the solvers run on the calling thread");
+			WorkerPoolShutdown();
+			return 0;
+		}
+	}
+
+	sgThreadNum = WORKER_POOL_THREAD_NUM;
+
+	return 1;
+}
+
+// ---------------------------------------------------------------------------
+
+void WorkerPoolStop(void)
+{
+	if (sgUserNum == 0 || --sgUserNum > 0)
+		return;
+
+	WorkerPoolShutdown();
+}
+
+// ---------------------------------------------------------------------------
+
+void WorkerPoolRun(WorkerJobFunc pFunc, void *pJobs, unsigned long JobSize, long JobNum)
+{
+	char *pJob = (char *)pJobs;
+	long workerNum = min(JobNum - 1, sgThreadNum), w, j;
+
+	sgpFunc = pFunc;
+
+	for (w = 0; w < workerNum; w++)
+	{
+		sgpJobs[w] = pJob + (w + 1) * JobSize;
+		SetEvent(sgWake[w]);
+	}
+
+	if (JobNum > 0)
+		pFunc(pJob);
+
+	// Jobs past the workers, when there are more jobs than workers or no workers at all
+	for (j = workerNum + 1; j < JobNum; j++)
+		pFunc(pJob + j * JobSize);
+
+	if (workerNum > 0)
+		WaitForMultipleObjects(workerNum, sgDone, TRUE, INFINITE);
+}
@@ -0,0 +1,175 @@
+/* Start Header -------------------------------------------------------
+Copyright World.c
+Purpose:  Implementation of the chunked world storage
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_World.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "World.h"
+
+#define WORLD_CHUNK_CAPACITY_MIN	64
+#define WORLD_RECORD_CAPACITY_MIN	8
+
+// ---------------------------------------------------------------------------
+
+static unsigned long WorldChunkHash(long ChunkX, long ChunkY)
+{
+	return ((unsigned long)ChunkX * 73856093u) ^ ((unsigned long)ChunkY * 19349663u);
+}
+
+// ---------------------------------------------------------------------------
+
+static WorldChunk* WorldChunkSlot(WorldChunk *pChunks, unsigned long Capacity, long ChunkX, long ChunkY)
+{
+	unsigned long mask = Capacity - 1, slot = WorldChunkHash(ChunkX, ChunkY) & mask;
+
+	while (pChunks[slot].mUsed && (pChunks[slot].mX != ChunkX || pChunks[slot].mY != ChunkY))
+		slot = (slot + 1) & mask;
+
+	return pChunks + slot;
+}
+
+// ---------------------------------------------------------------------------
+
+static void WorldGrow(World *pWorld)
+{
+	unsigned long capacity = pWorld->mChunkCapacity ? 2 * pWorld->mChunkCapacity : WORLD_CHUNK_CAPACITY_MIN;
+	WorldChunk *pChunks = (WorldChunk *)calloc(capacity, sizeof(WorldChunk));
+	unsigned long i;
+
+	AE_ASSERT_ALLOC(pChunks);
+
+	// The records move with their chunk, only the table is rebuilt
+	for (i = 0; i < pWorld->mChunkCapacity; i++)
+		if (pWorld->mpChunks[i].mUsed)
+			*WorldChunkSlot(pChunks, capacity, pWorld->mpChunks[i].mX, pWorld->mpChunks[i].mY) = pWorld->mpChunks[i];
+
+	free(pWorld->mpChunks);
+	pWorld->mpChunks = pChunks;
+	pWorld->mChunkCapacity = capacity;
+}
+
+// ---------------------------------------------------------------------------
+
+void WorldInit(World *pWorld, float ChunkSize, long ActiveRadius)
+{
+	memset(pWorld, 0, sizeof(World));
+
+	pWorld->mChunkSize = ChunkSize;
+	pWorld->mActiveRadius = ActiveRadius;
+
+	WorldGrow(pWorld);
+}
+
+// ---------------------------------------------------------------------------
+
+void WorldFree(World *pWorld)
+{
+	unsigned long i;
+
+	for (i = 0; i < pWorld->mChunkCapacity; i++)
+		free(pWorld->mpChunks[i].mpRecords);
+
+	free(pWorld->mpChunks);
+
+	memset(pWorld, 0, sizeof(World));
+}
+
+// ---------------------------------------------------------------------------
+
+void WorldChunkCoord(const World *pWorld, float x, float y, long *pChunkX, long *pChunkY)
+{
+	*pChunkX = (long)floorf(x / pWorld->mChunkSize);
+	*pChunkY = (long)floorf(y / pWorld->mChunkSize);
+}
+
+// ---------------------------------------------------------------------------
+
+int WorldChunkIsActive(const World *pWorld, long ChunkX, long ChunkY, long CamX, long CamY)
+{
+	return labs(ChunkX - CamX) <= pWorld->mActiveRadius && labs(ChunkY - CamY) <= pWorld->mActiveRadius;
+}
+
+// ---------------------------------------------------------------------------
+
+WorldChunk* WorldChunkGet(World *pWorld, long ChunkX, long ChunkY, int *pCreated)
+{
+	WorldChunk *pChunk = WorldChunkSlot(pWorld->mpChunks, pWorld->mChunkCapacity, ChunkX, ChunkY);
+
+	*pCreated = 0;
+
+	if (pChunk->mUsed)
+		return pChunk;
+
+	// Keep the table at most 3/4 full
+	if (4 * (pWorld->mChunkNum + 1) > 3 * pWorld->mChunkCapacity)
+	{
+		WorldGrow(pWorld);
+		pChunk = WorldChunkSlot(pWorld->mpChunks, pWorld->mChunkCapacity, ChunkX, ChunkY);
+	}
+
+	pChunk->mX = ChunkX;
+	pChunk->mY = ChunkY;
+	pChunk->mUsed = 1;
+	++pWorld->mChunkNum;
+
+	*pCreated = 1;
+
+	return pChunk;
+}
+
+// ---------------------------------------------------------------------------
+
+WorldRecord* WorldChunkFreeze(World *pWorld, WorldChunk *pChunk, Vector2D *pPosition, Vector2D *pVelocity, float Angle, float Scale)
+{
+	WorldRecord *pRecord;
+	float localX = pPosition->x / pWorld->mChunkSize - pChunk->mX;
+	float localY = pPosition->y / pWorld->mChunkSize - pChunk->mY;
+	float turn = Angle / TWO_PI;
+
+	if (pChunk->mRecordNum == pChunk->mRecordCapacity)
+	{
+		pChunk->mRecordCapacity = pChunk->mRecordCapacity ? 2 * pChunk->mRecordCapacity : WORLD_RECORD_CAPACITY_MIN;
+		pChunk->mpRecords = (WorldRecord *)realloc(pChunk->mpRecords, pChunk->mRecordCapacity * sizeof(WorldRecord));
+		AE_ASSERT_ALLOC(pChunk->mpRecords);
+	}
+
+	pRecord = pChunk->mpRecords + pChunk->mRecordNum++;
+	memset(pRecord, 0, sizeof(WorldRecord));
+
+	pRecord->mX = (unsigned short)AEClamp(localX * 65536.0f, 0.0f, 65535.0f);
+	pRecord->mY = (unsigned short)AEClamp(localY * 65536.0f, 0.0f, 65535.0f);
+	pRecord->mVelX = (short)AEClamp(pVelocity->x / WORLD_VELOCITY_STEP, -32768.0f, 32767.0f);
+	pRecord->mVelY = (short)AEClamp(pVelocity->y / WORLD_VELOCITY_STEP, -32768.0f, 32767.0f);
+	pRecord->mScale = (unsigned short)AEClamp(Scale / WORLD_SCALE_STEP + 0.5f, 0.0f, 65535.0f);
+	pRecord->mAngle = (unsigned char)((long)floorf((turn - floorf(turn)) * 256.0f + 0.5f) & 0xFF);
+
+	return pRecord;
+}
+
+// ---------------------------------------------------------------------------
+
+void WorldRecordThaw(const World *pWorld, const WorldChunk *pChunk, const WorldRecord *pRecord, Vector2D *pPosition, Vector2D *pVelocity, float *pAngle, float *pScale)
+{
+	Vector2DSet(pPosition, (pChunk->mX + pRecord->mX / 65536.0f) * pWorld->mChunkSize, (pChunk->mY + pRecord->mY / 65536.0f) * pWorld->mChunkSize);
+	Vector2DSet(pVelocity, pRecord->mVelX * WORLD_VELOCITY_STEP, pRecord->mVelY * WORLD_VELOCITY_STEP);
+	*pAngle = pRecord->mAngle * (TWO_PI / 256.0f);
+	*pScale = pRecord->mScale * WORLD_SCALE_STEP;
+}
+
+// ---------------------------------------------------------------------------
+
+void WorldChunkRemove(WorldChunk *pChunk, unsigned long Count)
+{
+	if (Count >= pChunk->mRecordNum)
+	{
+		pChunk->mRecordNum = 0;
+		return;
+	}
+
+	memmove(pChunk->mpRecords, pChunk->mpRecords + Count, (pChunk->mRecordNum - Count) * sizeof(WorldRecord));
+	pChunk->mRecordNum -= Count;
+}
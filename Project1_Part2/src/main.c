@@ -26,11 +26,14 @@ int WINAPI WinMain(HINSTANCE instanceH, HINSTANCE prevInstanceH, LPSTR command_l
 	// Initialize the system 
 	AESysInitInfo sysInitInfo;
 
+	StartupMark("WinMain");
+	StartupParse(command_line);
+
 	sysInitInfo.mAppInstance		= instanceH;
-	sysInitInfo.mShow				= show;
+	sysInitInfo.mShow				= gStartupHeadless ? SW_HIDE : show;
 	sysInitInfo.mWinWidth			= 800; 
 	sysInitInfo.mWinHeight			= 600;
-	sysInitInfo.mCreateConsole		= 1;
+	sysInitInfo.mCreateConsole		= !gStartupLazy;				// Creating the console is the slowest part of AESysInit
 	sysInitInfo.mMaxFrameRate		= 60;
 	sysInitInfo.mpWinCallBack		= NULL;//MyWinCallBack;
 	sysInitInfo.mClassStyle			= CS_HREDRAW | CS_VREDRAW;											
@@ -44,13 +47,19 @@ int WINAPI WinMain(HINSTANCE instanceH, HINSTANCE prevInstanceH, LPSTR command_l
 	if (0 != AESysInit(&sysInitInfo))
 		return 1;
 
+	StartupMark("AESysInit");
 
 	GameStateMgrInit(GS_ASTEROIDS);
+	StartupMark("GameStateMgrInit");
 	GSM_MainLoop();
 	
 	// free the system
 	AESysExit();
 
+	// Lets a script timing headless runs see a startup over budget
+	if (gStartupHeadless && !StartupWithinBudget())
+		return 2;
+
 	return 1;
 }
 
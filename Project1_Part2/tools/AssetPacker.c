@@ -0,0 +1,118 @@
+/* Start Header -------------------------------------------------------
+Copyright AssetPacker.c
+Purpose:  Offline tool baking the built in shapes and waves into Data\Asteroids.pak.
+          Build and run from the project folder:
+              cl /I include tools\AssetPacker.c
+              AssetPacker.exe [output file]
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_AssetPacker.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "AsteroidsData.h"
+#include <math.h>
+
+// ---------------------------------------------------------------------------
+
+static u32 PackerAlign(u32 Offset)
+{
+	return (Offset + ASSET_PACK_ALIGN - 1) & ~(u32)(ASSET_PACK_ALIGN - 1);
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+	const char *pFileName = argc > 1 ? argv[1] : ASSET_PACK_FILE;
+	AssetPackHeader header;
+	AssetPackShape shapes[BUILTIN_SHAPE_NUM];
+	u32 offset, i, v;
+	char *pData;
+	FILE *pFile;
+
+	// Shapes get their precomputed bounds, so the game never walks the vertices
+	for (i = 0; i < BUILTIN_SHAPE_NUM; i++)
+	{
+		AssetPackShape *pShape = shapes + i;
+		const MeshVertex *pVertices;
+
+		*pShape = sgBuiltinShapes[i];
+		pVertices = sgBuiltinVertices + pShape->mVertexFirst;
+
+		pShape->mLocalMinX = pShape->mLocalMaxX = pVertices[0].mX;
+		pShape->mLocalMinY = pShape->mLocalMaxY = pVertices[0].mY;
+		pShape->mLocalRadius = 0.0f;
+
+		for (v = 0; v < pShape->mVertexNum; v++)
+		{
+			f32 x = pVertices[v].mX, y = pVertices[v].mY;
+			f32 radius = sqrtf(x * x + y * y);
+
+			pShape->mLocalMinX = min(pShape->mLocalMinX, x);
+			pShape->mLocalMaxX = max(pShape->mLocalMaxX, x);
+			pShape->mLocalMinY = min(pShape->mLocalMinY, y);
+			pShape->mLocalMaxY = max(pShape->mLocalMaxY, y);
+			pShape->mLocalRadius = max(pShape->mLocalRadius, radius);
+		}
+	}
+
+	// Lay out the sections
+	memset(&header, 0, sizeof(AssetPackHeader));
+	header.mMagic = ASSET_PACK_MAGIC;
+	header.mVersion = ASSET_PACK_VERSION;
+
+	offset = PackerAlign(sizeof(AssetPackHeader));
+	header.mShapeNum = BUILTIN_SHAPE_NUM;
+	header.mShapeOffset = offset;
+	offset = PackerAlign(offset + header.mShapeNum * sizeof(AssetPackShape));
+
+	header.mVertexNum = sizeof(sgBuiltinVertices) / sizeof(MeshVertex);
+	header.mVertexOffset = offset;
+	offset = PackerAlign(offset + header.mVertexNum * sizeof(MeshVertex));
+
+	header.mIndexNum = sizeof(sgBuiltinIndices) / sizeof(unsigned short);
+	header.mIndexOffset = offset;
+	offset = PackerAlign(offset + header.mIndexNum * sizeof(unsigned short));
+
+	header.mWaveNum = BUILTIN_WAVE_NUM;
+	header.mWaveOffset = offset;
+	offset = PackerAlign(offset + header.mWaveNum * sizeof(AssetPackWave));
+
+	header.mSpawnNum = sizeof(sgBuiltinSpawns) / sizeof(AssetPackSpawn);
+	header.mSpawnOffset = offset;
+	offset = PackerAlign(offset + header.mSpawnNum * sizeof(AssetPackSpawn));
+
+	header.mSize = offset;
+
+	// Build the whole image, zero padded, then write it once
+	pData = (char *)calloc(1, header.mSize);
+	if (0 == pData)
+		return 1;
+
+	memcpy(pData, &header, sizeof(AssetPackHeader));
+	memcpy(pData + header.mShapeOffset, shapes, header.mShapeNum * sizeof(AssetPackShape));
+	memcpy(pData + header.mVertexOffset, sgBuiltinVertices, header.mVertexNum * sizeof(MeshVertex));
+	memcpy(pData + header.mIndexOffset, sgBuiltinIndices, header.mIndexNum * sizeof(unsigned short));
+	memcpy(pData + header.mWaveOffset, sgBuiltinWaves, header.mWaveNum * sizeof(AssetPackWave));
+	memcpy(pData + header.mSpawnOffset, sgBuiltinSpawns, header.mSpawnNum * sizeof(AssetPackSpawn));
+
+	pFile = fopen(pFileName, "wb");
+	if (0 == pFile || fwrite(pData, 1, header.mSize, pFile) != header.mSize)
+	{
+		printf("AssetPacker: could not write %s\n", pFileName);
+		if (pFile)
+			fclose(pFile);
+		free(pData);
+		return 1;
+	}
+
+	fclose(pFile);
+	free(pData);
+
+	printf("AssetPacker: %s, %u bytes, %u shapes, %u vertices, %u waves\n",
+		pFileName, header.mSize, header.mShapeNum, header.mVertexNum, header.mWaveNum);
+
+	return 0;
+}
@@ -0,0 +1,35 @@
+/* Start Header -------------------------------------------------------
+Copyright Pipeline3DBench.c
+Purpose:  Offline tool running the software 3D pipeline benchmark without the engine,
+          for headless machines. Build and run from the project folder:
+              cl /O2 /I include tools\Pipeline3DBench.c src\Pipeline3D.c
+              gcc -O2 -Iinclude tools/Pipeline3DBench.c src/Pipeline3D.c -lm -pthread -o Pipeline3DBench
+              Pipeline3DBench [image file]
+          The last frame is written to the image file, as a ppm, when one is given.
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_Pipeline3DBench.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include <stdio.h>
+#include "Pipeline3D.h"
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+	const char *pFileName = argc > 1 ? argv[1] : 0;
+	double verticesPerSecond[2], pixelsPerSecond[2];
+
+	Pipeline3DBenchmark(verticesPerSecond, pixelsPerSecond, pFileName);
+
+	printf("Pipeline3D: %.2f M vertices/s, %.2f M pixels/s (1 thread) / %.2f M vertices/s, %.2f M pixels/s (%d threads)\n",
+		verticesPerSecond[0] * 1e-6, pixelsPerSecond[0] * 1e-6, verticesPerSecond[1] * 1e-6, pixelsPerSecond[1] * 1e-6,
+		PIPELINE_3D_THREAD_NUM);
+	if (pFileName)
+		printf("Pipeline3D: last frame in %s\n", pFileName);
+
+	return 0;
+}
@@ -0,0 +1,764 @@
+/* Start Header -------------------------------------------------------
+Copyright RenderReplay.c
+Purpose:  Offline tool replaying a Render.trace capture against several backends
+          and reporting their throughput. Build and run from the project folder:
+              cl /O2 /I include tools\RenderReplay.c
+              RenderReplay.exe [trace file] [null|soft|batch] [repeat]
+          Without a backend, all of them run.
+Language:  C
+Platform: Windows OS, VS2015 Express for Win. Desktop
+Project: sean.higgins CS529_RenderReplay.c_1
+Author: Sean Higgins, sean.higgins
+Creation date: 10-18-2016
+- End Header --------------------------------------------------------*/
+
+#include "RenderTrace.h"
+#include <time.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define REPLAY_USE_SSE	1
+#include <emmintrin.h>
+#else
+#define REPLAY_USE_SSE	0
+#endif
+
+#define REPLAY_REPEAT_DEFAULT		10
+#define REPLAY_BATCH_VERTEX_MAX		65536				// Vertices of a batch before it is flushed
+#define REPLAY_PADDING				4					// Pixels past the end of the frame buffer, read by the last group of four
+
+typedef enum
+{
+	REPLAY_BACKEND_NULL = 0,						// Decodes and tracks the state only
+	REPLAY_BACKEND_SOFT,							// Rasterizes into a memory frame buffer
+	REPLAY_BACKEND_BATCH,							// Merges draws sharing the same state into one vertex buffer
+
+	REPLAY_BACKEND_NUM
+}REPLAY_BACKEND;
+
+static const char *sgpBackendNames[REPLAY_BACKEND_NUM] = { "null", "soft", "batch" };
+
+// Payload bytes following each op byte, see RENDER_TRACE_OP
+static const unsigned char sgOpPayloadSizes[RENDER_TRACE_OP_NUM] =
+{
+	2 * sizeof(f32),				// RENDER_TRACE_OP_FRAME
+	1,								// RENDER_TRACE_OP_RENDER_MODE
+	1 + 2 * sizeof(f32),			// RENDER_TRACE_OP_TEXTURE
+	4 * sizeof(f32),				// RENDER_TRACE_OP_TINT
+	1,								// RENDER_TRACE_OP_BLEND_MODE
+	6 * sizeof(f32),				// RENDER_TRACE_OP_TRANSFORM
+	2,								// RENDER_TRACE_OP_DRAW
+	2 * sizeof(f32),				// RENDER_TRACE_OP_CAMERA
+	4 * sizeof(s32),				// RENDER_TRACE_OP_VIEWPORT
+	sizeof(u32)						// RENDER_TRACE_OP_DRAW_VERTICES, the vertices are checked by the op
+};
+
+// Render state, as the engine would hold it
+typedef struct ReplayState
+{
+	u8					mRenderMode;
+	u8					mBlendMode;
+	u8					mTexture;
+	f32					mTextureOffset[2];
+	f32					mTint[4];
+	f32					mTransform[6];
+	f32					mCamera[2];
+	s32					mViewport[4];
+}ReplayState;
+
+typedef struct ReplayStats
+{
+	unsigned long		mCallNum;
+	unsigned long		mDrawNum;
+	unsigned long		mStateChangeNum;			// Calls that changed the render state (transforms excluded)
+	unsigned long		mRedundantNum;				// Calls that set the state it already had
+	unsigned long		mBatchNum;
+	unsigned long		mTriangleNum;
+	unsigned long		mPixelNum;
+}ReplayStats;
+
+typedef struct Replay
+{
+	const RenderTraceHeader	*mpHeader;
+	const RenderTraceMesh	*mpMeshes;
+	const RenderTraceVertex	*mpVertices;
+	const RenderTraceTexture	*mpTextures;
+	const u32				*mpTexels;
+	const unsigned char		*mpCalls;
+
+	ReplayState			mState;
+	ReplayStats			mStats;
+
+	u32					*mpFrameBuffer;				// Soft backend
+	f32					*mpBatch;					// Batch backend, x y pairs
+	unsigned long		mBatchVertexNum;
+
+	RenderTraceVertex	*mpInline;					// Aligned copy of the vertices of the last RENDER_TRACE_OP_DRAW_VERTICES
+	unsigned long		mInlineCapacity;
+}Replay;
+
+// ---------------------------------------------------------------------------
+
+// Sets a piece of state, counting changes and redundant calls
+static void ReplayStateSet(Replay *pReplay, void *pState, const void *pValue, unsigned long Size, int *pChanged)
+{
+	if (memcmp(pState, pValue, Size) == 0)
+	{
+		pReplay->mStats.mRedundantNum++;
+		*pChanged = 0;
+		return;
+	}
+
+	memcpy(pState, pValue, Size);
+	pReplay->mStats.mStateChangeNum++;
+	*pChanged = 1;
+}
+
+// ---------------------------------------------------------------------------
+
+static void ReplayBatchFlush(Replay *pReplay)
+{
+	if (pReplay->mBatchVertexNum == 0)
+		return;
+
+	pReplay->mStats.mBatchNum++;
+	pReplay->mBatchVertexNum = 0;
+}
+
+// ---------------------------------------------------------------------------
+
+// Edge function fill of the pixel centers inside the triangle, clipped to the viewport
+static void ReplayRasterize(Replay *pReplay, const f32 *p0, const f32 *p1, const f32 *p2, u32 Color)
+{
+	const s32 *pViewport = pReplay->mState.mViewport;
+	s32 minX, minY, maxX, maxY, x, y;
+	f32 area = (p1[0] - p0[0]) * (p2[1] - p0[1]) - (p1[1] - p0[1]) * (p2[0] - p0[0]);
+	u32 width = pReplay->mpHeader->mWidth;
+
+	// Either winding is drawn
+	if (area < 0.0f)
+	{
+		const f32 *pSwap = p1;
+		p1 = p2;
+		p2 = pSwap;
+		area = -area;
+	}
+
+	if (area == 0.0f)
+		return;
+
+	minX = (s32)floorf(min(p0[0], min(p1[0], p2[0])));
+	minY = (s32)floorf(min(p0[1], min(p1[1], p2[1])));
+	maxX = (s32)ceilf(max(p0[0], max(p1[0], p2[0])));
+	maxY = (s32)ceilf(max(p0[1], max(p1[1], p2[1])));
+
+	minX = max(minX, pViewport[0]);
+	minY = max(minY, pViewport[1]);
+	maxX = min(maxX, min(pViewport[0] + pViewport[2], (s32)pReplay->mpHeader->mWidth) - 1);
+	maxY = min(maxY, min(pViewport[1] + pViewport[3], (s32)pReplay->mpHeader->mHeight) - 1);
+
+	for (y = minY; y <= maxY; y++)
+	{
+		f32 py = y + 0.5f;
+
+		for (x = minX; x <= maxX; x++)
+		{
+			f32 px = x + 0.5f;
+			f32 w0 = (p2[0] - p1[0]) * (py - p1[1]) - (p2[1] - p1[1]) * (px - p1[0]);
+			f32 w1 = (p0[0] - p2[0]) * (py - p2[1]) - (p0[1] - p2[1]) * (px - p2[0]);
+			f32 w2 = (p1[0] - p0[0]) * (py - p0[1]) - (p1[1] - p0[1]) * (px - p0[0]);
+
+			if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f)
+			{
+				pReplay->mpFrameBuffer[y * width + x] = Color;
+				pReplay->mStats.mPixelNum++;
+			}
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+#if REPLAY_USE_SSE
+static const unsigned char sgBitCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+// a + (b - a) * w / 128 on 16 bit channels, w in [0, 128)
+#define REPLAY_LERP16(a, b, w)		_mm_add_epi16((a), _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16((b), (a)), (w)), 7))
+
+// Bilinear filtering of four samples at once. Texel centers sit on half pixels and the samples
+// are clamped to the texture. The four texels around each sample are fetched one by one, then
+// blended channel by channel in 16 bits: samples 0 and 1 in the low halves, 2 and 3 in the high ones
+static __m128i ReplayTextureSample4(const Replay *pReplay, const RenderTraceTexture *pTexture, __m128 u, __m128 v)
+{
+	const u32 *pTexels = pReplay->mpTexels + pTexture->mTexelFirst;
+	__m128 x = _mm_sub_ps(_mm_mul_ps(u, _mm_set1_ps((f32)pTexture->mWidth)), _mm_set1_ps(0.5f));
+	__m128 y = _mm_sub_ps(_mm_mul_ps(v, _mm_set1_ps((f32)pTexture->mHeight)), _mm_set1_ps(0.5f));
+	__m128i x0, y0, wx, wy, zero = _mm_setzero_si128();
+	__m128i c00, c10, c01, c11, wxLo, wxHi, wyLo, wyHi, lo, hi;
+	s32 ix[4], iy[4];
+	u32 t00[4], t10[4], t01[4], t11[4];
+	int k;
+
+	x = _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps((f32)(pTexture->mWidth - 1)));
+	y = _mm_min_ps(_mm_max_ps(y, _mm_setzero_ps()), _mm_set1_ps((f32)(pTexture->mHeight - 1)));
+	x0 = _mm_cvttps_epi32(x);
+	y0 = _mm_cvttps_epi32(y);
+	wx = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(x, _mm_cvtepi32_ps(x0)), _mm_set1_ps(128.0f)));
+	wy = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(y, _mm_cvtepi32_ps(y0)), _mm_set1_ps(128.0f)));
+
+	_mm_storeu_si128((__m128i *)ix, x0);
+	_mm_storeu_si128((__m128i *)iy, y0);
+	for (k = 0; k < 4; k++)
+	{
+		const u32 *pRow0 = pTexels + iy[k] * pTexture->mWidth + ix[k];
+		const u32 *pRow1 = pRow0 + ((u32)iy[k] + 1 < pTexture->mHeight ? pTexture->mWidth : 0);
+		int next = (u32)ix[k] + 1 < pTexture->mWidth ? 1 : 0;
+
+		t00[k] = pRow0[0];
+		t10[k] = pRow0[next];
+		t01[k] = pRow1[0];
+		t11[k] = pRow1[next];
+	}
+	c00 = _mm_loadu_si128((const __m128i *)t00);
+	c10 = _mm_loadu_si128((const __m128i *)t10);
+	c01 = _mm_loadu_si128((const __m128i *)t01);
+	c11 = _mm_loadu_si128((const __m128i *)t11);
+
+	// Each sample's weight repeated over its four channels
+	wx = _mm_packs_epi32(wx, wx);
+	wx = _mm_unpacklo_epi16(wx, wx);
+	wxLo = _mm_unpacklo_epi32(wx, wx);
+	wxHi = _mm_unpackhi_epi32(wx, wx);
+	wy = _mm_packs_epi32(wy, wy);
+	wy = _mm_unpacklo_epi16(wy, wy);
+	wyLo = _mm_unpacklo_epi32(wy, wy);
+	wyHi = _mm_unpackhi_epi32(wy, wy);
+
+	lo = REPLAY_LERP16(
+		REPLAY_LERP16(_mm_unpacklo_epi8(c00, zero), _mm_unpacklo_epi8(c10, zero), wxLo),
+		REPLAY_LERP16(_mm_unpacklo_epi8(c01, zero), _mm_unpacklo_epi8(c11, zero), wxLo), wyLo);
+	hi = REPLAY_LERP16(
+		REPLAY_LERP16(_mm_unpackhi_epi8(c00, zero), _mm_unpackhi_epi8(c10, zero), wxHi),
+		REPLAY_LERP16(_mm_unpackhi_epi8(c01, zero), _mm_unpackhi_epi8(c11, zero), wxHi), wyHi);
+
+	return _mm_packus_epi16(lo, hi);
+}
+#else
+// Bilinear filtering of one sample, the same arithmetic as the four wide version
+static u32 ReplayTextureSample(const Replay *pReplay, const RenderTraceTexture *pTexture, f32 u, f32 v)
+{
+	const u32 *pTexels = pReplay->mpTexels + pTexture->mTexelFirst;
+	f32 x = min(max(u * pTexture->mWidth - 0.5f, 0.0f), (f32)(pTexture->mWidth - 1));
+	f32 y = min(max(v * pTexture->mHeight - 0.5f, 0.0f), (f32)(pTexture->mHeight - 1));
+	u32 ix = (u32)x, iy = (u32)y, result = 0;
+	s32 wx = (s32)((x - ix) * 128.0f), wy = (s32)((y - iy) * 128.0f);
+	const u32 *pRow0 = pTexels + iy * pTexture->mWidth + ix;
+	const u32 *pRow1 = pRow0 + (iy + 1 < pTexture->mHeight ? pTexture->mWidth : 0);
+	int next = ix + 1 < pTexture->mWidth ? 1 : 0, shift;
+
+	for (shift = 0; shift < 32; shift += 8)
+	{
+		s32 c00 = (pRow0[0] >> shift) & 0xFF, c10 = (pRow0[next] >> shift) & 0xFF;
+		s32 c01 = (pRow1[0] >> shift) & 0xFF, c11 = (pRow1[next] >> shift) & 0xFF;
+		s32 top = c00 + (((c10 - c00) * wx) >> 7), bottom = c01 + (((c11 - c01) * wx) >> 7);
+
+		result |= (u32)(top + (((bottom - top) * wy) >> 7)) << shift;
+	}
+
+	return result;
+}
+#endif
+
+// ---------------------------------------------------------------------------
+
+// Same coverage as ReplayRasterize. Points are x, y, u, v: the texture coordinates are
+// interpolated without perspective, the texels are modulated by Color
+static void ReplayRasterizeTextured(Replay *pReplay, const f32 *p0, const f32 *p1, const f32 *p2, u32 Color, const RenderTraceTexture *pTexture)
+{
+	const s32 *pViewport = pReplay->mState.mViewport;
+	s32 minX, minY, maxX, maxY, x, y;
+	f32 area = (p1[0] - p0[0]) * (p2[1] - p0[1]) - (p1[1] - p0[1]) * (p2[0] - p0[0]);
+	f32 dx0, dx1, dx2, dUdx, dVdx;
+	u32 width = pReplay->mpHeader->mWidth;
+
+	if (area < 0.0f)
+	{
+		const f32 *pSwap = p1;
+		p1 = p2;
+		p2 = pSwap;
+		area = -area;
+	}
+
+	if (area == 0.0f)
+		return;
+
+	minX = (s32)floorf(min(p0[0], min(p1[0], p2[0])));
+	minY = (s32)floorf(min(p0[1], min(p1[1], p2[1])));
+	maxX = (s32)ceilf(max(p0[0], max(p1[0], p2[0])));
+	maxY = (s32)ceilf(max(p0[1], max(p1[1], p2[1])));
+
+	minX = max(minX, pViewport[0]);
+	minY = max(minY, pViewport[1]);
+	maxX = min(maxX, min(pViewport[0] + pViewport[2], (s32)pReplay->mpHeader->mWidth) - 1);
+	maxY = min(maxY, min(pViewport[1] + pViewport[3], (s32)pReplay->mpHeader->mHeight) - 1);
+
+	// Steps along x of the edge functions of ReplayRasterize, and of u and v: the edge functions over the area are the barycentrics
+	dx0 = -(p2[1] - p1[1]);
+	dx1 = -(p0[1] - p2[1]);
+	dx2 = -(p1[1] - p0[1]);
+	dUdx = (dx0 * p0[2] + dx1 * p1[2] + dx2 * p2[2]) / area;
+	dVdx = (dx0 * p0[3] + dx1 * p1[3] + dx2 * p2[3]) / area;
+
+	for (y = minY; y <= maxY; y++)
+	{
+		f32 px = minX + 0.5f, py = y + 0.5f;
+		f32 w0 = (p2[0] - p1[0]) * (py - p1[1]) - (p2[1] - p1[1]) * (px - p1[0]);
+		f32 w1 = (p0[0] - p2[0]) * (py - p2[1]) - (p0[1] - p2[1]) * (px - p2[0]);
+		f32 w2 = (p1[0] - p0[0]) * (py - p0[1]) - (p1[1] - p0[1]) * (px - p0[0]);
+		f32 u = (w0 * p0[2] + w1 * p1[2] + w2 * p2[2]) / area;
+		f32 v = (w0 * p0[3] + w1 * p1[3] + w2 * p2[3]) / area;
+		u32 *pRow = pReplay->mpFrameBuffer + y * width;
+
+#if REPLAY_USE_SSE
+		// Four pixels at a time, the lanes past the box are masked off
+		static const int sMasks[4] = { 0xF, 0x1, 0x3, 0x7 };
+		__m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f), zero = _mm_setzero_ps();
+		__m128 e0 = _mm_add_ps(_mm_set1_ps(w0), _mm_mul_ps(lanes, _mm_set1_ps(dx0)));
+		__m128 e1 = _mm_add_ps(_mm_set1_ps(w1), _mm_mul_ps(lanes, _mm_set1_ps(dx1)));
+		__m128 e2 = _mm_add_ps(_mm_set1_ps(w2), _mm_mul_ps(lanes, _mm_set1_ps(dx2)));
+		__m128 us = _mm_add_ps(_mm_set1_ps(u), _mm_mul_ps(lanes, _mm_set1_ps(dUdx)));
+		__m128 vs = _mm_add_ps(_mm_set1_ps(v), _mm_mul_ps(lanes, _mm_set1_ps(dVdx)));
+		__m128 step0 = _mm_set1_ps(4.0f * dx0), step1 = _mm_set1_ps(4.0f * dx1), step2 = _mm_set1_ps(4.0f * dx2);
+		__m128 stepU = _mm_set1_ps(4.0f * dUdx), stepV = _mm_set1_ps(4.0f * dVdx);
+		__m128i color = _mm_unpacklo_epi8(_mm_set1_epi32((int)Color), _mm_setzero_si128());
+
+		// Color channels scaled to [0, 256], so a white tint leaves the texels as they are
+		color = _mm_add_epi16(color, _mm_srli_epi16(color, 7));
+
+		for (x = minX; x <= maxX; x += 4)
+		{
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+			int mask = _mm_movemask_ps(inside) & (maxX - x >= 3 ? 0xF : sMasks[maxX - x + 1]);
+
+			if (mask)
+			{
+				__m128i texels = ReplayTextureSample4(pReplay, pTexture, us, vs), zeroI = _mm_setzero_si128();
+				__m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(texels, zeroI), color), 8);
+				__m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(texels, zeroI), color), 8);
+				__m128i write = _mm_set_epi32(mask & 8 ? -1 : 0, mask & 4 ? -1 : 0, mask & 2 ? -1 : 0, mask & 1 ? -1 : 0);
+				__m128i old = _mm_loadu_si128((const __m128i *)(pRow + x));
+
+				_mm_storeu_si128((__m128i *)(pRow + x), _mm_or_si128(_mm_and_si128(write, _mm_packus_epi16(lo, hi)), _mm_andnot_si128(write, old)));
+				pReplay->mStats.mPixelNum += sgBitCount[mask];
+			}
+
+			e0 = _mm_add_ps(e0, step0);
+			e1 = _mm_add_ps(e1, step1);
+			e2 = _mm_add_ps(e2, step2);
+			us = _mm_add_ps(us, stepU);
+			vs = _mm_add_ps(vs, stepV);
+		}
+#else
+		for (x = minX; x <= maxX; x++)
+		{
+			if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f)
+			{
+				u32 texel = ReplayTextureSample(pReplay, pTexture, u, v), result = 0;
+				int shift;
+
+				for (shift = 0; shift < 32; shift += 8)
+				{
+					u32 c = (Color >> shift) & 0xFF;
+
+					result |= ((((texel >> shift) & 0xFF) * (c + (c >> 7))) >> 8) << shift;
+				}
+
+				pRow[x] = result;
+				pReplay->mStats.mPixelNum++;
+			}
+
+			w0 += dx0;
+			w1 += dx1;
+			w2 += dx2;
+			u += dUdx;
+			v += dVdx;
+		}
+#endif
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+// Draws a triangle list, pVertices is 0 for a mesh the trace does not hold
+static void ReplayDraw(Replay *pReplay, REPLAY_BACKEND Backend, const RenderTraceVertex *pVertices, unsigned long VertexNum)
+{
+	const ReplayState *pState = &pReplay->mState;
+	const f32 *m = pState->mTransform;
+	f32 halfWidth, halfHeight;
+	u32 tint;
+	unsigned long v;
+	int textured;
+
+	pReplay->mStats.mDrawNum++;
+
+	if (0 == pVertices || Backend == REPLAY_BACKEND_NULL)
+		return;
+
+	pReplay->mStats.mTriangleNum += VertexNum / 3;
+
+	if (Backend == REPLAY_BACKEND_BATCH)
+	{
+		if (pReplay->mBatchVertexNum + VertexNum > REPLAY_BATCH_VERTEX_MAX)
+			ReplayBatchFlush(pReplay);
+
+		// The transform is applied on the CPU, so draws only break a batch through the other states.
+		// A draw larger than a batch fills several
+		for (v = 0; v < VertexNum; v++)
+		{
+			const RenderTraceVertex *pVertex = pVertices + v;
+			f32 *pOut;
+
+			if (pReplay->mBatchVertexNum == REPLAY_BATCH_VERTEX_MAX)
+				ReplayBatchFlush(pReplay);
+
+			pOut = pReplay->mpBatch + 2 * pReplay->mBatchVertexNum++;
+
+			pOut[0] = m[0] * pVertex->mX + m[1] * pVertex->mY + m[2];
+			pOut[1] = m[3] * pVertex->mX + m[4] * pVertex->mY + m[5];
+		}
+		return;
+	}
+
+	// Soft: world to viewport pixels, one world unit per pixel, y down
+	halfWidth = 0.5f * pState->mViewport[2];
+	halfHeight = 0.5f * pState->mViewport[3];
+	tint = 0xFF000000 | ((u32)(pState->mTint[0] * 255.0f) << 16) | ((u32)(pState->mTint[1] * 255.0f) << 8) | (u32)(pState->mTint[2] * 255.0f);
+	textured = pState->mRenderMode == AE_GFX_RM_TEXTURE && pState->mTexture < pReplay->mpHeader->mTextureNum;
+
+	for (v = 0; v + 2 < VertexNum; v += 3)
+	{
+		f32 points[3][4];
+		unsigned long k;
+
+		for (k = 0; k < 3; k++)
+		{
+			const RenderTraceVertex *pVertex = pVertices + v + k;
+			f32 x = m[0] * pVertex->mX + m[1] * pVertex->mY + m[2];
+			f32 y = m[3] * pVertex->mX + m[4] * pVertex->mY + m[5];
+
+			points[k][0] = pState->mViewport[0] + halfWidth + (x - pState->mCamera[0]);
+			points[k][1] = pState->mViewport[1] + halfHeight - (y - pState->mCamera[1]);
+			points[k][2] = pVertex->mU + pState->mTextureOffset[0];
+			points[k][3] = pVertex->mV + pState->mTextureOffset[1];
+		}
+
+		if (textured)
+			ReplayRasterizeTextured(pReplay, points[0], points[1], points[2], pVertices[v].mColor & tint, pReplay->mpTextures + pState->mTexture);
+		else
+			ReplayRasterize(pReplay, points[0], points[1], points[2], pVertices[v].mColor & tint);
+	}
+}
+
+// ---------------------------------------------------------------------------
+
+/*
+Takes Num elements of Size bytes off the *pRemaining bytes of the file, 0 if they do not fit
+*/
+static int ReplaySectionTake(unsigned long *pRemaining, u32 Num, unsigned long Size)
+{
+	if (Num > *pRemaining / Size)
+		return 0;
+
+	*pRemaining -= Num * Size;
+	return 1;
+}
+
+// ---------------------------------------------------------------------------
+
+/*
+Returns 1 if [First, First + Num) lies within [0, Total), without overflowing
+*/
+static int ReplayRangeValid(u32 First, u32 Num, u32 Total)
+{
+	return First <= Total && Num <= Total - First;
+}
+
+// ---------------------------------------------------------------------------
+
+// Plays the whole trace once
+static void ReplayRun(Replay *pReplay, REPLAY_BACKEND Backend)
+{
+	const unsigned char *pCall = pReplay->mpCalls, *pEnd = pReplay->mpCalls + pReplay->mpHeader->mCallSize;
+	ReplayState *pState = &pReplay->mState;
+	int changed;
+
+	while (pCall < pEnd)
+	{
+		unsigned char op = *pCall++;
+
+		if (op >= RENDER_TRACE_OP_NUM)
+		{
+			printf("RenderReplay: unknown op %u, trace is corrupt\n", op);
+			return;
+		}
+
+		// Every case below reads its whole payload
+		if ((unsigned long)(pEnd - pCall) < sgOpPayloadSizes[op])
+		{
+			printf("RenderReplay: op %u cut by the end of the calls, trace is corrupt\n", op);
+			return;
+		}
+
+		if (op != RENDER_TRACE_OP_FRAME)
+			pReplay->mStats.mCallNum++;
+
+		switch (op)
+		{
+		case RENDER_TRACE_OP_FRAME:
+			// Every frame starts from the full window and the engine defaults
+			ReplayBatchFlush(pReplay);
+			memset(pState, 0, sizeof(ReplayState));
+			pState->mBlendMode = AE_GFX_BM_BLEND;
+			pState->mTexture = RENDER_TRACE_TEXTURE_NONE;
+			pState->mTint[0] = pState->mTint[1] = pState->mTint[2] = pState->mTint[3] = 1.0f;
+			pState->mViewport[2] = pReplay->mpHeader->mWidth;
+			pState->mViewport[3] = pReplay->mpHeader->mHeight;
+			memcpy(pState->mCamera, pCall, 2 * sizeof(f32));
+			pCall += 2 * sizeof(f32);
+			if (pReplay->mpFrameBuffer)
+				memset(pReplay->mpFrameBuffer, 0, pReplay->mpHeader->mWidth * pReplay->mpHeader->mHeight * sizeof(u32));
+			break;
+
+		case RENDER_TRACE_OP_RENDER_MODE:
+			ReplayStateSet(pReplay, &pState->mRenderMode, pCall, 1, &changed);
+			pCall += 1;
+			break;
+
+		case RENDER_TRACE_OP_TEXTURE:
+			ReplayStateSet(pReplay, &pState->mTexture, pCall, 1, &changed);
+			memcpy(pState->mTextureOffset, pCall + 1, 2 * sizeof(f32));
+			pCall += 1 + 2 * sizeof(f32);
+			break;
+
+		case RENDER_TRACE_OP_TINT:
+			ReplayStateSet(pReplay, pState->mTint, pCall, 4 * sizeof(f32), &changed);
+			pCall += 4 * sizeof(f32);
+			break;
+
+		case RENDER_TRACE_OP_BLEND_MODE:
+			ReplayStateSet(pReplay, &pState->mBlendMode, pCall, 1, &changed);
+			pCall += 1;
+			break;
+
+		case RENDER_TRACE_OP_TRANSFORM:
+			memcpy(pState->mTransform, pCall, 6 * sizeof(f32));
+			pCall += 6 * sizeof(f32);
+			changed = 0;
+			break;
+
+		case RENDER_TRACE_OP_DRAW:
+			if (pCall[0] < pReplay->mpHeader->mMeshNum)
+				ReplayDraw(pReplay, Backend, pReplay->mpVertices + pReplay->mpMeshes[pCall[0]].mVertexFirst, pReplay->mpMeshes[pCall[0]].mVertexNum);
+			else
+				ReplayDraw(pReplay, Backend, 0, 0);
+			pCall += 2;
+			changed = 0;
+			break;
+
+		case RENDER_TRACE_OP_DRAW_VERTICES:
+		{
+			u32 vertexNum;
+
+			memcpy(&vertexNum, pCall, sizeof(u32));
+			pCall += sizeof(u32);
+
+			if (vertexNum > (unsigned long)(pEnd - pCall) / sizeof(RenderTraceVertex))
+			{
+				printf("RenderReplay: op %u cut by the end of the calls, trace is corrupt\n", op);
+				return;
+			}
+
+			// The records are unaligned, the vertices are copied out before drawing
+			if (Backend != REPLAY_BACKEND_NULL)
+			{
+				if (vertexNum > pReplay->mInlineCapacity)
+				{
+					free(pReplay->mpInline);
+					pReplay->mInlineCapacity = vertexNum;
+					pReplay->mpInline = (RenderTraceVertex *)malloc(vertexNum * sizeof(RenderTraceVertex));
+					if (0 == pReplay->mpInline)
+					{
+						printf("RenderReplay: out of memory for %lu inline vertices\n", (unsigned long)vertexNum);
+						pReplay->mInlineCapacity = 0;
+						return;
+					}
+				}
+				memcpy(pReplay->mpInline, pCall, vertexNum * sizeof(RenderTraceVertex));
+			}
+
+			ReplayDraw(pReplay, Backend, pReplay->mpInline, vertexNum);
+			pCall += vertexNum * sizeof(RenderTraceVertex);
+			changed = 0;
+			break;
+		}
+
+		case RENDER_TRACE_OP_CAMERA:
+			ReplayStateSet(pReplay, pState->mCamera, pCall, 2 * sizeof(f32), &changed);
+			pCall += 2 * sizeof(f32);
+			break;
+
+		case RENDER_TRACE_OP_VIEWPORT:
+			ReplayStateSet(pReplay, pState->mViewport, pCall, 4 * sizeof(s32), &changed);
+			pCall += 4 * sizeof(s32);
+			break;
+		}
+
+		// Any real state change ends the current batch
+		if (changed && Backend == REPLAY_BACKEND_BATCH)
+			ReplayBatchFlush(pReplay);
+	}
+
+	ReplayBatchFlush(pReplay);
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+	const char *pFileName = argc > 1 ? argv[1] : RENDER_TRACE_FILE;
+	int backendFirst = 0, backendLast = REPLAY_BACKEND_NUM - 1, repeat = argc > 3 ? atoi(argv[3]) : REPLAY_REPEAT_DEFAULT, b, r;
+	const RenderTraceHeader *pHeader;
+	unsigned char *pData;
+	unsigned long remaining;
+	long size;
+	FILE *pFile;
+	Replay replay;
+
+	if (argc > 2)
+	{
+		for (backendFirst = 0; backendFirst < REPLAY_BACKEND_NUM; backendFirst++)
+			if (strcmp(argv[2], sgpBackendNames[backendFirst]) == 0)
+				break;
+
+		if (backendFirst == REPLAY_BACKEND_NUM)
+		{
+			printf("RenderReplay: unknown backend %s (null, soft or batch)\n", argv[2]);
+			return 1;
+		}
+		backendLast = backendFirst;
+	}
+
+	if (repeat < 1)
+		repeat = 1;
+
+	// The whole trace is loaded, the replay only reads memory
+	pFile = fopen(pFileName, "rb");
+	if (0 == pFile)
+	{
+		printf("RenderReplay: could not open %s\n", pFileName);
+		return 1;
+	}
+
+	fseek(pFile, 0, SEEK_END);
+	size = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+
+	pData = (unsigned char *)malloc(size > 0 ? size : 1);
+	if (0 == pData || size < (long)sizeof(RenderTraceHeader) || fread(pData, 1, size, pFile) != (size_t)size)
+	{
+		printf("RenderReplay: could not read %s\n", pFileName);
+		fclose(pFile);
+		free(pData);
+		return 1;
+	}
+	fclose(pFile);
+
+	// Section by section, so that no count can wrap the size around
+	pHeader = (const RenderTraceHeader *)pData;
+	remaining = (unsigned long)size - sizeof(RenderTraceHeader);
+	if (pHeader->mMagic != RENDER_TRACE_MAGIC || pHeader->mVersion != RENDER_TRACE_VERSION
+		|| !ReplaySectionTake(&remaining, pHeader->mMeshNum, sizeof(RenderTraceMesh))
+		|| !ReplaySectionTake(&remaining, pHeader->mVertexNum, sizeof(RenderTraceVertex))
+		|| !ReplaySectionTake(&remaining, pHeader->mTextureNum, sizeof(RenderTraceTexture))
+		|| !ReplaySectionTake(&remaining, pHeader->mTexelNum, sizeof(u32))
+		|| pHeader->mCallSize != remaining)
+	{
+		printf("RenderReplay: %s is not a valid trace\n", pFileName);
+		free(pData);
+		return 1;
+	}
+
+	memset(&replay, 0, sizeof(Replay));
+	replay.mpHeader = pHeader;
+	replay.mpMeshes = (const RenderTraceMesh *)(pData + sizeof(RenderTraceHeader));
+	replay.mpVertices = (const RenderTraceVertex *)(replay.mpMeshes + pHeader->mMeshNum);
+	replay.mpTextures = (const RenderTraceTexture *)(replay.mpVertices + pHeader->mVertexNum);
+	replay.mpTexels = (const u32 *)(replay.mpTextures + pHeader->mTextureNum);
+	replay.mpCalls = (const unsigned char *)(replay.mpTexels + pHeader->mTexelNum);
+
+	for (b = 0; b < (int)pHeader->mMeshNum; b++)
+		if (!ReplayRangeValid(replay.mpMeshes[b].mVertexFirst, replay.mpMeshes[b].mVertexNum, pHeader->mVertexNum))
+		{
+			printf("RenderReplay: mesh %d of %s is out of the vertices\n", b, pFileName);
+			free(pData);
+			return 1;
+		}
+
+	// Width x height is only formed once it is known to fit, the sampler needs at least one texel
+	for (b = 0; b < (int)pHeader->mTextureNum; b++)
+		if (0 == replay.mpTextures[b].mWidth || 0 == replay.mpTextures[b].mHeight
+			|| replay.mpTextures[b].mTexelFirst > pHeader->mTexelNum
+			|| replay.mpTextures[b].mWidth > (pHeader->mTexelNum - replay.mpTextures[b].mTexelFirst) / replay.mpTextures[b].mHeight)
+		{
+			printf("RenderReplay: texture %d of %s is out of the texels\n", b, pFileName);
+			free(pData);
+			return 1;
+		}
+
+	printf("RenderReplay: %s, %u frames, %u calls, %u meshes, %u textures, %ux%u\n",
+		pFileName, pHeader->mFrameNum, pHeader->mCallNum, pHeader->mMeshNum, pHeader->mTextureNum, pHeader->mWidth, pHeader->mHeight);
+
+	for (b = backendFirst; b <= backendLast; b++)
+	{
+		clock_t start;
+		double seconds;
+		ReplayStats *pStats = &replay.mStats;
+
+		if (b == REPLAY_BACKEND_SOFT)
+			replay.mpFrameBuffer = (u32 *)calloc(pHeader->mWidth * pHeader->mHeight + REPLAY_PADDING, sizeof(u32));
+		if (b == REPLAY_BACKEND_BATCH)
+			replay.mpBatch = (f32 *)malloc(REPLAY_BATCH_VERTEX_MAX * 2 * sizeof(f32));
+
+		memset(pStats, 0, sizeof(ReplayStats));
+
+		start = clock();
+		for (r = 0; r < repeat; r++)
+			ReplayRun(&replay, (REPLAY_BACKEND)b);
+		seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+		if (seconds <= 0.0)
+			seconds = 1.0 / CLOCKS_PER_SEC;
+
+		// Per pass figures
+		printf("  %-5s %8.3f ms/frame  %10.0f calls/s  %lu state changes  %lu redundant",
+			sgpBackendNames[b], seconds * 1000.0 / (repeat * (double)max(pHeader->mFrameNum, 1)), pStats->mCallNum / seconds,
+			pStats->mStateChangeNum / repeat, pStats->mRedundantNum / repeat);
+
+		if (b == REPLAY_BACKEND_SOFT)
+			printf("  %lu triangles  %lu pixels", pStats->mTriangleNum / repeat, pStats->mPixelNum / repeat);
+		if (b == REPLAY_BACKEND_BATCH)
+			printf("  %lu draws in %lu batches (%.1f per batch)", pStats->mDrawNum / repeat, pStats->mBatchNum / repeat,
+				pStats->mBatchNum ? (double)pStats->mDrawNum / pStats->mBatchNum : 0.0);
+		printf("\n");
+
+		free(replay.mpFrameBuffer);
+		free(replay.mpBatch);
+		free(replay.mpInline);
+		replay.mpFrameBuffer = 0;
+		replay.mpBatch = 0;
+		replay.mpInline = 0;
+		replay.mInlineCapacity = 0;
+	}
+
+	free(pData);
+
+	return 0;
+}